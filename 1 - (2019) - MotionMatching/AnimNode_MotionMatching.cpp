@@ -11,9 +11,26 @@
 #include "Animation/Skeleton.h"
 
 #include "AnimationRuntime.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
 
 #include "AnimationDatabase.h"
 #include "Goal.h"
+#include "MotionMatchingPoseCache.h"
+#include "RootMotionTrack.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingQuery.h"
+
+namespace AnimNodeMotionMatchingGlobals
+{
+	static int32 MinParallelPoses = 3;
+	static FAutoConsoleVariableRef CVarMinParallelPoses(
+		TEXT("a.MotionMatching.ParallelPoseDecompression"),
+		MinParallelPoses,
+		TEXT("Decompress the blending samples of a motion matching node in parallel when at least this many of them are blending.\n")
+		TEXT("0: Always decompress on the evaluating thread\n")
+		TEXT("3: Default"));
+}
 
 float FAnimNode_MotionMatching::GetCurrentAssetTime()
 {
@@ -44,6 +61,9 @@ void FAnimNode_MotionMatching::Initialize_AnyThread(const FAnimationInitializeCo
 
 	InternalTimeAccumulator = 0.0f;
 
+	// Hold on to the current baked data, a rebake publishes a new snapshot instead of modifying this one
+	DatabaseSnapshot = AnimationDatabase ? AnimationDatabase->GetRuntimeSnapshot() : nullptr;
+
 	const int NumPoses = AnimationSamples.Num();
 	
 	if (NumPoses > 0)
@@ -73,8 +93,12 @@ void FAnimNode_MotionMatching::UpdateAssetPlayer(const FAnimationUpdateContext&
 {
 	EvaluateGraphExposedInputs.Execute(Context);
 
-	if (AnimationDatabase)
+	UpdateDatabaseSnapshot();
+
+	if (DatabaseSnapshot.IsValid())
 	{
+		ReportMissingShards();
+
 		UpdateAnimationSampleData(Context);
 
 		if (AnimationSamples.Num() > 0 && GetCurrentAnim() != NULL 
@@ -92,20 +116,53 @@ void FAnimNode_MotionMatching::UpdateAssetPlayer(const FAnimationUpdateContext&
 
 void FAnimNode_MotionMatching::Evaluate_AnyThread(FPoseContext& Output)
 {
-	if (AnimationDatabase)
+	if (DatabaseSnapshot.IsValid())
 	{
+		// Dedicated servers only need the root motion, nothing is decompressed and the output stays in the reference pose
+		const bool bSearchOnly = bSearchOnlyOnDedicatedServer && IsRunningDedicatedServer();
+
 		FVector Velocity = FVector::ZeroVector;
 		TArray<FMotionBoneData> CurrentBonesData;
 		bool bHasCurrentAnim = false;
 
 		if (AnimationSamples.Num() > 0)
 		{
-			// Calculate our current velocity from the animation
-			const FVector TempVelocity = GetCurrentAnim()->ExtractRootMotion(AnimationSamples.Last().Time, 0.1f /* DeltaTime */, true).GetTranslation();
-			Velocity = TempVelocity.GetSafeNormal() * (TempVelocity.Size() / 0.1f /* DeltaTime */);
+			// Calculate our current velocity from the baked root motion, fall back to the animation for databases that have not been rebaked yet
+			const FMotionMatchingSampleData& CurrentSample = AnimationSamples.Last();
+
+			if (const FRootMotionTrack* RootMotionTrack = DatabaseSnapshot->GetRootMotionTrack(CurrentSample.AnimationIndex))
+			{
+				Velocity = RootMotionTrack->GetVelocity(AnimationSamples.Last().Time, 0.1f /* DeltaTime */);
+			}
+			else
+			{
+				const FVector TempVelocity = GetCurrentAnim()->ExtractRootMotion(AnimationSamples.Last().Time, 0.1f /* DeltaTime */, true).GetTranslation();
+				Velocity = TempVelocity.GetSafeNormal() * (TempVelocity.Size() / 0.1f /* DeltaTime */);
+			}
+
+			// The animation data is unmirrored, bring it into the space of the pose we are actually playing
+			if (CurrentSample.bMirrored)
+			{
+				Velocity = DatabaseSnapshot->GetMirrorTable().MirrorVector(Velocity);
+			}
 
 			// Get data about our current bones
-			CurrentBonesData = UMotionMatchingUtilities::GetBoneDataFromAnimation(GetCurrentAnim(), AnimationSamples.Last().Time, AnimationDatabase->GetMotionMatchingBones());
+			if (bSearchOnly)
+			{
+				// The baked features of the playing frame stand in for the pose, they are already mirrored for mirrored frames
+				const int32 CurrentFrameIndex = DatabaseSnapshot->FindFrameIndex(CurrentSample.AnimationIndex, CurrentSample.Time, CurrentSample.bMirrored);
+				UMotionMatchingUtilities::GetBoneDataFromFeatures(*DatabaseSnapshot, CurrentFrameIndex, CurrentBonesData);
+			}
+			else
+			{
+				CurrentBonesData = UMotionMatchingUtilities::GetBoneDataFromAnimation(GetCurrentAnim(), CurrentSample.Time, DatabaseSnapshot->GetBones());
+
+				if (CurrentSample.bMirrored)
+				{
+					DatabaseSnapshot->GetMirrorTable().MirrorBoneData(CurrentBonesData);
+				}
+			}
+
 			bHasCurrentAnim = true;
 		}
 
@@ -119,7 +176,14 @@ void FAnimNode_MotionMatching::Evaluate_AnyThread(FPoseContext& Output)
 		Params.TrajectoryPositionAxis = TrajectoryPositionAxis;
 		Params.BonePositionAxis = BonePositionAxis;
 
-		EvaluateBlendPose(Output);
+		if (bSearchOnly)
+		{
+			Output.ResetToRefPose();
+		}
+		else
+		{
+			EvaluateBlendPose(Output);
+		}
 
 		UpdateMotionMatching(Params, Output);
 	}
@@ -255,19 +319,44 @@ void FAnimNode_MotionMatching::EvaluateBlendPose(FPoseContext& Output)
 		TArray<float, TInlineAllocator<8>> FilteredWeights;
 		FilteredWeights.SetNum(NumPoses, false);
 
-		float SumWeight = 0.0f;
-		for (int32 i = 0; i < SamplesToEvaluate.Num(); ++i)
+		// Every buffer is allocated up front on this thread's animation memory stack, the decompression only fills them
+		for (int32 i = 0; i < NumPoses; ++i)
 		{
-			FMotionMatchingSampleData& Sample = SamplesToEvaluate[i];
-
 			FilteredPoses[i].CopyBonesFrom(Output.Pose);
 			FilteredCurves[i].InitFrom(Output.Curve);
-			FilteredWeights[i] = Sample.BlendWeight;
+			FilteredWeights[i] = SamplesToEvaluate[i].BlendWeight;
+		}
 
-			Sample.Animation->GetAnimationPose(FilteredPoses[i], FilteredCurves[i], FAnimExtractContext(Sample.Time, true));
+		const bool bUsePoseCache = FMotionMatchingPoseCache::IsEnabled();
+		const FMotionMatchingSampleData* Samples = SamplesToEvaluate.GetData();
+		const FMotionMirrorTable* MirrorTable = DatabaseSnapshot.IsValid() ? &DatabaseSnapshot->GetMirrorTable() : nullptr;
 
-			SumWeight += Sample.BlendWeight;
-		}
+		// The samples are independent of each other, only the blend has to wait for all of them
+		const int32 MinParallelPoses = AnimNodeMotionMatchingGlobals::MinParallelPoses;
+		const bool bSingleThreaded = MinParallelPoses <= 0 || NumPoses < MinParallelPoses;
+
+		ParallelFor(NumPoses, [&](int32 i)
+		{
+			// Temporaries of the decompression go on the memory stack of the thread that runs this sample
+			FMemMark Mark(FMemStack::Get());
+
+			const FMotionMatchingSampleData& Sample = Samples[i];
+
+			if (bUsePoseCache)
+			{
+				// Share the decompressed pose with other nodes evaluating the same animation this frame
+				FMotionMatchingPoseCache::Get().GetAnimationPose(Sample.Animation, Sample.Time, FilteredPoses[i], FilteredCurves[i]);
+			}
+			else
+			{
+				Sample.Animation->GetAnimationPose(FilteredPoses[i], FilteredCurves[i], FAnimExtractContext(Sample.Time, true));
+			}
+
+			if (Sample.bMirrored && MirrorTable)
+			{
+				MirrorTable->MirrorPose(FilteredPoses[i]);
+			}
+		}, bSingleThreaded);
 
 		FAnimationRuntime::BlendPosesTogether(FilteredPoses, FilteredCurves, FilteredWeights, Output.Pose, Output.Curve);
 	}
@@ -279,48 +368,51 @@ void FAnimNode_MotionMatching::EvaluateBlendPose(FPoseContext& Output)
 
 void FAnimNode_MotionMatching::UpdateMotionMatching(const FMotionMatchingParams& MotionMatchingParams, const FPoseContext& Output)
 {
-	if (AnimationDatabase)
+	if (DatabaseSnapshot.IsValid())
 	{
-		int WinnerIndex = INDEX_NONE;
-		float WinnerCost = BIG_NUMBER;
-
-		UMotionMatchingUtilities::GetLowestCostAnimation(AnimationDatabase, Goal, MotionMatchingParams, WinnerIndex, WinnerCost);
-
-		if (WinnerIndex != INDEX_NONE)
+		const FMotionMatchingSampleData* CurrentSample = AnimationSamples.Num() > 0 ? &AnimationSamples.Last() : nullptr;
+		const bool bHasCurrentSample = CurrentSample != nullptr;
+
+		int32 WinnerFrameIndex = INDEX_NONE;
+		if (UMotionMatchingUtilities::SelectNextFrame(*DatabaseSnapshot, Goal, MotionMatchingParams, GetSelectionSettings(),
+			bHasCurrentSample ? CurrentSample->AnimationIndex : INDEX_NONE,
+			bHasCurrentSample ? CurrentSample->Time : 0.0f,
+			bHasCurrentSample && CurrentSample->bMirrored,
+			bUseTransitionGraph, WinnerFrameIndex))
 		{
-			FAnimationFrameData Winner = AnimationDatabase->GetMotionFrameData()[WinnerIndex];
+			const FMotionFrameInfo& Winner = DatabaseSnapshot->GetFrameInfo(WinnerFrameIndex);
 
-			if (AnimationSamples.Num() > 0)
-			{
-				bool bTheWinnerIsAtTheSameLocation = (Winner.SourceAnimationIndex == AnimationSamples.Last().AnimationIndex)
-														&& (FMath::Abs(Winner.StartTime - AnimationSamples.Last().Time) < 0.2f);
-				
-				if (!bTheWinnerIsAtTheSameLocation)
-				{
-					// Play Anim with Blend
-					SetCurrentAnimation(Winner.SourceAnimationIndex, Winner.StartTime);
+			// Play Anim with Blend, this adds a sample so CurrentSample must not be used after it
+			SetCurrentAnimation(Winner.SourceAnimationIndex, Winner.StartTime, Winner.bMirrored);
 
-					// Update our time accumulator to start at the new time
-					InternalTimeAccumulator = Winner.StartTime;
-				}
-			}
-			else
+			if (bHasCurrentSample)
 			{
-				SetCurrentAnimation(Winner.SourceAnimationIndex, Winner.StartTime);
+				// Update our time accumulator to start at the new time
+				InternalTimeAccumulator = Winner.StartTime;
 			}
 		}
 	}
 }
 
-void FAnimNode_MotionMatching::SetCurrentAnimation(const int InAnimationIndex, const float InTime)
+FMotionMatchingSelectionSettings FAnimNode_MotionMatching::GetSelectionSettings() const
+{
+	FMotionMatchingSelectionSettings SelectionSettings;
+	SelectionSettings.NumSearchCandidates = FMath::Max(1, NumSearchCandidates);
+	SelectionSettings.SwitchHysteresis = FMath::Max(0.0f, SwitchHysteresis);
+	SelectionSettings.SameLocationTime = FMath::Max(0.0f, SameLocationTime);
+	return SelectionSettings;
+}
+
+void FAnimNode_MotionMatching::SetCurrentAnimation(const int InAnimationIndex, const float InTime, const bool bInMirrored /*= false*/)
 {
 	FMotionMatchingSampleData NewAnimation;
 	NewAnimation.AnimationIndex = InAnimationIndex;
-	NewAnimation.Animation = AnimationDatabase->GetSourceAnimations()[InAnimationIndex];
+	NewAnimation.Animation = DatabaseSnapshot->GetAnimation(InAnimationIndex);
 	NewAnimation.BlendTime = BlendTime;
 	NewAnimation.RemainingBlendTime = BlendTime;
 	NewAnimation.BlendWeight = 0.0f;
 	NewAnimation.Time = InTime;
+	NewAnimation.bMirrored = bInMirrored;
 
 	FAlphaBlend& Blend = NewAnimation.Blend;
 	Blend.SetBlendTime(0.0f);
@@ -330,6 +422,55 @@ void FAnimNode_MotionMatching::SetCurrentAnimation(const int InAnimationIndex, c
 	AnimationSamples.Add(NewAnimation);
 }
 
+void FAnimNode_MotionMatching::UpdateDatabaseSnapshot()
+{
+	FMotionDatabaseSnapshotPtr NewSnapshot = AnimationDatabase ? AnimationDatabase->GetRuntimeSnapshot() : nullptr;
+
+	if (NewSnapshot == DatabaseSnapshot)
+	{
+		return;
+	}
+
+	// The database was rebaked (or swapped), the animation indices of the playing samples might have moved
+	if (NewSnapshot.IsValid())
+	{
+		for (FMotionMatchingSampleData& Sample : AnimationSamples)
+		{
+			Sample.AnimationIndex = NewSnapshot->FindAnimationIndex(Sample.Animation);
+		}
+	}
+
+	DatabaseSnapshot = NewSnapshot;
+}
+
+void FAnimNode_MotionMatching::ReportMissingShards()
+{
+	// Only check again when the resident shards (or the required ones) might have changed
+	uint32 RequiredShardsHash = GetTypeHash(RequiredShards.Num());
+	for (const FName& RequiredShard : RequiredShards)
+	{
+		RequiredShardsHash = HashCombine(RequiredShardsHash, GetTypeHash(RequiredShard));
+	}
+
+	if (DatabaseSnapshot->GetVersion() == LastShardReportVersion && RequiredShardsHash == LastShardReportHash)
+	{
+		return;
+	}
+
+	LastShardReportVersion = DatabaseSnapshot->GetVersion();
+	LastShardReportHash = RequiredShardsHash;
+
+	MissingShards.Reset();
+	for (const FName& RequiredShard : RequiredShards)
+	{
+		if (!DatabaseSnapshot->IsShardResident(RequiredShard))
+		{
+			MissingShards.Add(RequiredShard);
+			UE_LOG(LogAnimation, Warning, TEXT("Motion matching requires shard '%s' of %s, but it is not resident. Its frames are not searched until it is requested."), *RequiredShard.ToString(), *GetNameSafe(AnimationDatabase));
+		}
+	}
+}
+
 UAnimSequence* FAnimNode_MotionMatching::GetCurrentAnim()
 {
 	if (AnimationSamples.Num() > 0)
@@ -3,12 +3,85 @@
 #include "AnimationDatabase.h"
 #include "Animation/AnimSequence.h"
 #include "Animation/AnimSequenceBase.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/BulkData.h"
+#include "MotionDatabasePayload.h"
+#include "MotionDatabaseShard.h"
+#include "MotionTransitionGraph.h"
+#include "MotionFeatureQuantization.h"
+#include "Async/Async.h"
+#include "AnimationDatabaseBaking.h"
+#include "AnimationDatabaseDerivedData.h"
+#include "AnimationDatabaseCustomVersion.h"
+#include "MotionMatchingUtilities.h"
 
 namespace AnimationDatabaseGlobals
 {
 	// @todo: replace this with developer settings
 	const float TimeStep = 0.1f;
 	const float MaxFutureTime = 1.0f;
+
+	// Samples per second of the baked root motion tracks
+	const float RootMotionSampleRate = 60.0f;
+
+	void StorePayload(FByteBulkData& OutBulkData, const FMotionDatabasePayloadData& InPayload)
+	{
+		OutBulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(OutBulkData.Realloc(InPayload.Num()), InPayload.GetData(), InPayload.Num());
+		OutBulkData.Unlock();
+
+		// Store the payload outside of the export, it is only read when the shard becomes resident
+		OutBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+	}
+
+#if WITH_EDITOR
+	/** Everything about the bake that is not part of the animation, the bones or the mirror table */
+	FString GetBakeSettingsKey()
+	{
+		FString SettingsKey = FString::Printf(TEXT("%g_%g_%g"), TimeStep, MaxFutureTime, RootMotionSampleRate);
+		for (const float TrajectoryInterval : FMotionMatchingUtils::TrajectoryIntervals)
+		{
+			SettingsKey += FString::Printf(TEXT("_%g"), TrajectoryInterval);
+		}
+
+		return SettingsKey;
+	}
+#endif//WITH_EDITOR
+
+#if WITH_EDITORONLY_DATA
+	/**
+	 * Appends the blocks that are derived from the search matrix of every payload.
+	 * They take far longer to build than the payload itself, so they are built on cook or in the background, never when the database changes.
+	 */
+	void WriteDerivedBlocks(const FMotionTransitionGraphSettings& InTransitionGraph, const FMotionFeatureQuantizationSettings& InQuantization, const TArray<FMotionDatabasePayloadData*>& InOutPayloads)
+	{
+		if (InTransitionGraph.bBuildTransitionGraph)
+		{
+			for (FMotionDatabasePayloadData* Payload : InOutPayloads)
+			{
+				FMotionDatabasePayload::WriteTransitionGraph(InTransitionGraph, *Payload);
+			}
+		}
+
+		// One set of codebooks for all payloads, so the codes survive when the shards are concatenated
+		if (InQuantization.bQuantizeFeatures)
+		{
+			FMotionDatabasePayload::WriteQuantizedFeatures(InQuantization, InOutPayloads);
+		}
+	}
+#endif//WITH_EDITORONLY_DATA
+
+	FMotionDatabasePayloadPtr LoadPayload(FByteBulkData& InBulkData)
+	{
+		// Read the payload straight into the allocation the snapshot is going to search
+		FMotionDatabasePayloadData* Payload = new FMotionDatabasePayloadData();
+		Payload->SetNumUninitialized(InBulkData.GetBulkDataSize());
+
+		void* PayloadDestination = Payload->GetData();
+		InBulkData.GetCopy(&PayloadDestination, true);
+
+		return FMotionDatabasePayloadPtr(Payload);
+	}
 }
 
 
@@ -16,10 +89,150 @@ UAnimationDatabase::UAnimationDatabase(const FObjectInitializer& ObjectInitializ
 	: Super(ObjectInitializer)
 {
 	Skeleton = nullptr;
+#if WITH_EDITORONLY_DATA
 	MotionFrameData.Empty();
+#endif//WITH_EDITORONLY_DATA
 	MotionMatchingBones.Empty();
+	RootMotionTracks.Empty();
+	MirrorBoneMapping.Empty();
+	bBakeMirroredFrames = false;
+	MirrorAxis = EAxis::X;
+	RuntimeSnapshotVersion = 0;
+#if WITH_EDITORONLY_DATA
+	bBuildingDerivedBlocks = false;
+	bDerivedBlocksOutOfDate = false;
+#endif//WITH_EDITORONLY_DATA
 }
 
+void UAnimationDatabase::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FAnimationDatabaseCustomVersion::GUID);
+
+	Super::Serialize(Ar);
+
+	if (Ar.IsTransacting())
+	{
+		return;
+	}
+
+	// Databases saved before the payload existed end with their properties
+	if (Ar.CustomVer(FAnimationDatabaseCustomVersion::GUID) < FAnimationDatabaseCustomVersion::CookedSearchPayload)
+	{
+		return;
+	}
+
+	FByteBulkData* SerializedSearchPayload = &SearchPayload;
+	TIndirectArray<FByteBulkData>* SerializedShardPayloads = &ShardPayloads;
+
+#if WITH_EDITORONLY_DATA
+	// Cooked databases carry the search matrix as payloads, so loading it is one read per shard instead of constructing every frame
+	if (Ar.IsSaving() && Ar.IsCooking())
+	{
+		// The first payload holds the frames that are not part of any shard
+		TArray<FMotionDatabasePayloadData> Payloads;
+		TArray<FMotionDatabasePayloadData*> PayloadPointers;
+		Payloads.SetNum(Shards.Num() + 1);
+
+		for (int32 PayloadIndex = 0; PayloadIndex < Payloads.Num(); ++PayloadIndex)
+		{
+			WriteShardPayload(PayloadIndex - 1, Payloads[PayloadIndex]);
+			PayloadPointers.Add(&Payloads[PayloadIndex]);
+		}
+
+		AnimationDatabaseGlobals::WriteDerivedBlocks(TransitionGraph, Quantization, PayloadPointers);
+
+		// The cooked payloads go into their own bulk data, the editor keeps building its snapshots from the frame data.
+		// The linker writes the bulk data after Serialize returns, so they have to live as long as the database
+		AnimationDatabaseGlobals::StorePayload(CookedSearchPayload, Payloads[0]);
+		SerializedSearchPayload = &CookedSearchPayload;
+
+		CookedShardPayloads.Empty(Shards.Num());
+		for (int32 ShardIndex = 0; ShardIndex < Shards.Num(); ++ShardIndex)
+		{
+			AnimationDatabaseGlobals::StorePayload(*new(CookedShardPayloads) FByteBulkData(), Payloads[ShardIndex + 1]);
+		}
+
+		SerializedShardPayloads = &CookedShardPayloads;
+	}
+	else if (Ar.IsSaving())
+	{
+		// Uncooked packages rebuild the search matrix from the frame data, there is no point in storing it twice
+		SearchPayload.RemoveBulkData();
+		ShardPayloads.Empty();
+	}
+#endif//WITH_EDITORONLY_DATA
+
+	SerializedSearchPayload->Serialize(Ar, this);
+
+	if (Ar.CustomVer(FAnimationDatabaseCustomVersion::GUID) < FAnimationDatabaseCustomVersion::CookedShardPayloads)
+	{
+		return;
+	}
+
+	int32 NumShardPayloads = SerializedShardPayloads->Num();
+	Ar << NumShardPayloads;
+
+	if (Ar.IsLoading())
+	{
+		SerializedShardPayloads->Empty(NumShardPayloads);
+		for (int32 ShardIndex = 0; ShardIndex < NumShardPayloads; ++ShardIndex)
+		{
+			new(*SerializedShardPayloads) FByteBulkData();
+		}
+	}
+
+	for (int32 ShardIndex = 0; ShardIndex < NumShardPayloads; ++ShardIndex)
+	{
+		(*SerializedShardPayloads)[ShardIndex].Serialize(Ar, this, ShardIndex);
+	}
+}
+
+void UAnimationDatabase::PostLoad()
+{
+	Super::PostLoad();
+
+	// The frames that are not part of any shard are always resident
+	ResidentShards.Reset();
+	if (HasCookedPayload())
+	{
+		ResidentShards.Add(FMotionDatabaseResidentShard(NAME_None, AnimationDatabaseGlobals::LoadPayload(SearchPayload)));
+	}
+
+	PublishRuntimeSnapshot();
+
+	for (const FMotionDatabaseShardSettings& Shard : Shards)
+	{
+		if (Shard.bResidentOnLoad)
+		{
+			RequestShard(Shard.ContextName);
+		}
+	}
+}
+
+void UAnimationDatabase::BeginDestroy()
+{
+	// The requests write into payloads that are owned by this database
+	for (TPair<FName, FMotionDatabaseShardRequest>& PendingRequest : PendingShardRequests)
+	{
+		PendingRequest.Value.Request->Cancel();
+		PendingRequest.Value.Request->WaitCompletion();
+		delete PendingRequest.Value.Request;
+	}
+
+	PendingShardRequests.Empty();
+
+	Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void UAnimationDatabase::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	PublishRuntimeSnapshot();
+}
+#endif//WITH_EDITOR
+
 USkeleton* UAnimationDatabase::GetSkeleton() const
 {
 	return Skeleton;
@@ -37,13 +250,331 @@ TArray<UAnimSequence*> UAnimationDatabase::GetSourceAnimations() const
 
 TArray<FAnimationFrameData> UAnimationDatabase::GetMotionFrameData() const
 {
+#if WITH_EDITORONLY_DATA
 	return MotionFrameData;
+#else
+	// Cooked databases only carry the search payload, see GetRuntimeSnapshot
+	return TArray<FAnimationFrameData>();
+#endif//WITH_EDITORONLY_DATA
+}
+
+const FRootMotionTrack* UAnimationDatabase::GetRootMotionTrack(const int InAnimationIndex) const
+{
+	if (RootMotionTracks.IsValidIndex(InAnimationIndex) && RootMotionTracks[InAnimationIndex].IsValid())
+	{
+		return &RootMotionTracks[InAnimationIndex];
+	}
+
+	return nullptr;
+}
+
+FMotionDatabaseSnapshotPtr UAnimationDatabase::GetRuntimeSnapshot() const
+{
+	FScopeLock Lock(&RuntimeSnapshotCriticalSection);
+	return RuntimeSnapshot;
+}
+
+void UAnimationDatabase::PublishRuntimeSnapshot()
+{
+	check(IsInGameThread());
+
+#if WITH_EDITORONLY_DATA
+	// Uncooked databases rebuild the payload of every resident shard from the frame data
+	if (!HasCookedPayload())
+	{
+		TArray<FMotionDatabaseResidentShard> PreviousShards = MoveTemp(ResidentShards);
+
+		FMotionDatabasePayloadData* BasePayload = new FMotionDatabasePayloadData();
+		WriteShardPayload(INDEX_NONE, *BasePayload);
+		ResidentShards.Add(FMotionDatabaseResidentShard(NAME_None, FMotionDatabasePayloadPtr(BasePayload)));
+
+		for (const FMotionDatabaseResidentShard& PreviousShard : PreviousShards)
+		{
+			const int32 ShardIndex = FindShardIndex(PreviousShard.ContextName);
+
+			if (PreviousShard.ContextName != NAME_None && ShardIndex != INDEX_NONE)
+			{
+				FMotionDatabasePayloadData* ShardPayload = new FMotionDatabasePayloadData();
+				WriteShardPayload(ShardIndex, *ShardPayload);
+				ResidentShards.Add(FMotionDatabaseResidentShard(PreviousShard.ContextName, FMotionDatabasePayloadPtr(ShardPayload)));
+			}
+		}
+	}
+#endif//WITH_EDITORONLY_DATA
+
+	PublishResidentShards();
+
+#if WITH_EDITORONLY_DATA
+	if (!HasCookedPayload())
+	{
+		BuildDerivedBlocksAsync();
+	}
+#endif//WITH_EDITORONLY_DATA
+}
+
+void UAnimationDatabase::PublishResidentShards()
+{
+	// Build the new snapshot outside of the lock, readers keep using the previous one until it is swapped in
+	FMotionMirrorTable MirrorTable;
+	BuildMirrorTable(MirrorTable);
+
+	FMotionDatabaseSnapshotPtr NewSnapshot = FMotionDatabaseSnapshot::BuildFromShards(ResidentShards, SourceAnimations, RootMotionTracks, MotionMatchingBones, MirrorTable, ++RuntimeSnapshotVersion);
+
+	FScopeLock Lock(&RuntimeSnapshotCriticalSection);
+	RuntimeSnapshot = NewSnapshot;
+}
+
+#if WITH_EDITORONLY_DATA
+void UAnimationDatabase::BuildDerivedBlocksAsync()
+{
+	if (!TransitionGraph.bBuildTransitionGraph && !Quantization.bQuantizeFeatures)
+	{
+		return;
+	}
+
+	// One build at a time, the running build starts the next one against the shards that are resident by then
+	if (bBuildingDerivedBlocks)
+	{
+		bDerivedBlocksOutOfDate = true;
+		return;
+	}
+
+	bBuildingDerivedBlocks = true;
+	bDerivedBlocksOutOfDate = false;
+
+	// The snapshot without the derived blocks is already published, the search falls back to the full search until they are done
+	const TArray<FMotionDatabaseResidentShard> SourceShards = ResidentShards;
+	const FMotionTransitionGraphSettings TransitionGraphSettings = TransitionGraph;
+	const FMotionFeatureQuantizationSettings QuantizationSettings = Quantization;
+	TWeakObjectPtr<UAnimationDatabase> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, SourceShards, TransitionGraphSettings, QuantizationSettings]()
+	{
+		TArray<FMotionDatabasePayloadData*> Payloads;
+		for (const FMotionDatabaseResidentShard& SourceShard : SourceShards)
+		{
+			Payloads.Add(SourceShard.Payload.IsValid() ? new FMotionDatabasePayloadData(*SourceShard.Payload) : nullptr);
+		}
+
+		TArray<FMotionDatabasePayloadData*> ValidPayloads = Payloads;
+		ValidPayloads.Remove(nullptr);
+		AnimationDatabaseGlobals::WriteDerivedBlocks(TransitionGraphSettings, QuantizationSettings, ValidPayloads);
+
+		TArray<FMotionDatabaseResidentShard> DerivedShards;
+		for (int32 ShardIndex = 0; ShardIndex < SourceShards.Num(); ++ShardIndex)
+		{
+			DerivedShards.Add(FMotionDatabaseResidentShard(SourceShards[ShardIndex].ContextName, FMotionDatabasePayloadPtr(Payloads[ShardIndex])));
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SourceShards, DerivedShards]()
+		{
+			UAnimationDatabase* Database = WeakThis.Get();
+			if (!Database)
+			{
+				return;
+			}
+
+			Database->bBuildingDerivedBlocks = false;
+
+			// Shards may have been requested, released or rebuilt while building, only the payloads that are still resident take the result
+			bool bAnyReplaced = false;
+			for (FMotionDatabaseResidentShard& ResidentShard : Database->ResidentShards)
+			{
+				const int32 SourceIndex = SourceShards.IndexOfByPredicate([&ResidentShard](const FMotionDatabaseResidentShard& SourceShard) { return SourceShard.Payload == ResidentShard.Payload; });
+				if (SourceIndex != INDEX_NONE && DerivedShards[SourceIndex].Payload.IsValid())
+				{
+					ResidentShard.Payload = DerivedShards[SourceIndex].Payload;
+					bAnyReplaced = true;
+				}
+			}
+
+			if (bAnyReplaced)
+			{
+				Database->PublishResidentShards();
+			}
+
+			// Payloads that were added while building, the finished ones are skipped and the new ones share their codebooks
+			if (Database->bDerivedBlocksOutOfDate)
+			{
+				Database->BuildDerivedBlocksAsync();
+			}
+		});
+	});
+}
+#endif//WITH_EDITORONLY_DATA
+
+bool UAnimationDatabase::HasCookedPayload() const
+{
+	return SearchPayload.GetBulkDataSize() > 0;
+}
+
+int32 UAnimationDatabase::FindShardIndex(const FName InContextName) const
+{
+	return Shards.IndexOfByPredicate([InContextName](const FMotionDatabaseShardSettings& Shard) { return Shard.ContextName == InContextName; });
+}
+
+bool UAnimationDatabase::IsShardResident(const FName InContextName) const
+{
+	return ResidentShards.ContainsByPredicate([InContextName](const FMotionDatabaseResidentShard& Shard) { return Shard.ContextName == InContextName; });
+}
+
+bool UAnimationDatabase::RequestShard(const FName InContextName)
+{
+	check(IsInGameThread());
+
+	if (IsShardResident(InContextName) || PendingShardRequests.Contains(InContextName))
+	{
+		return true;
+	}
+
+	const int32 ShardIndex = FindShardIndex(InContextName);
+	if (ShardIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	if (ShardPayloads.IsValidIndex(ShardIndex) && ShardPayloads[ShardIndex].GetBulkDataSize() > 0)
+	{
+		// Stream the payload straight into the allocation the snapshot is going to search
+		FMotionDatabasePayloadData* Payload = new FMotionDatabasePayloadData();
+		Payload->SetNumUninitialized(ShardPayloads[ShardIndex].GetBulkDataSize());
+
+		FMotionDatabaseShardRequest ShardRequest;
+		ShardRequest.Payload = FMotionDatabasePayloadPtr(Payload);
+
+		TWeakObjectPtr<UAnimationDatabase> WeakThis(this);
+		FBulkDataIORequestCallBack OnRequestCompleted = [WeakThis, InContextName](bool bWasCancelled, IBulkDataIORequest* Request)
+		{
+			if (!bWasCancelled)
+			{
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, InContextName]()
+				{
+					if (UAnimationDatabase* Database = WeakThis.Get())
+					{
+						Database->OnShardStreamed(InContextName);
+					}
+				});
+			}
+		};
+
+		ShardRequest.Request = ShardPayloads[ShardIndex].CreateStreamingRequest(AIOP_BelowNormal, &OnRequestCompleted, Payload->GetData());
+		if (!ShardRequest.Request)
+		{
+			return false;
+		}
+
+		PendingShardRequests.Add(InContextName, ShardRequest);
+		return true;
+	}
+
+#if WITH_EDITORONLY_DATA
+	// Uncooked databases build the payload from the frame data right away, the resident payloads and their derived blocks are kept
+	FMotionDatabasePayloadData* Payload = new FMotionDatabasePayloadData();
+	WriteShardPayload(ShardIndex, *Payload);
+	ResidentShards.Add(FMotionDatabaseResidentShard(InContextName, FMotionDatabasePayloadPtr(Payload)));
+
+	PublishResidentShards();
+	BuildDerivedBlocksAsync();
+	return true;
+#else
+	return false;
+#endif//WITH_EDITORONLY_DATA
+}
+
+void UAnimationDatabase::ReleaseShard(const FName InContextName)
+{
+	check(IsInGameThread());
+
+	// The frames that are not part of any shard can not be released
+	if (InContextName == NAME_None)
+	{
+		return;
+	}
+
+	FMotionDatabaseShardRequest ShardRequest;
+	if (PendingShardRequests.RemoveAndCopyValue(InContextName, ShardRequest))
+	{
+		ShardRequest.Request->Cancel();
+		ShardRequest.Request->WaitCompletion();
+		delete ShardRequest.Request;
+	}
+
+	// The other payloads do not change, there is nothing to rebuild
+	const int32 NumRemoved = ResidentShards.RemoveAll([InContextName](const FMotionDatabaseResidentShard& Shard) { return Shard.ContextName == InContextName; });
+	if (NumRemoved > 0)
+	{
+		PublishResidentShards();
+	}
+}
+
+void UAnimationDatabase::OnShardStreamed(const FName InContextName)
+{
+	FMotionDatabaseShardRequest ShardRequest;
+
+	// The shard was released while it was streaming
+	if (!PendingShardRequests.RemoveAndCopyValue(InContextName, ShardRequest))
+	{
+		return;
+	}
+
+	ShardRequest.Request->WaitCompletion();
+	delete ShardRequest.Request;
+
+	// Streamed payloads are cooked, they already carry their derived blocks
+	ResidentShards.Add(FMotionDatabaseResidentShard(InContextName, ShardRequest.Payload));
+
+	PublishResidentShards();
+}
+
+#if WITH_EDITORONLY_DATA
+void UAnimationDatabase::WriteShardPayload(const int32 InShardIndex, FMotionDatabasePayloadData& OutPayload) const
+{
+	FMotionMirrorTable MirrorTable;
+	BuildMirrorTable(MirrorTable);
+
+	const int32 NumTrajectoryPoints = MotionFrameData.Num() > 0 ? MotionFrameData[0].MotionTrajectory.Num() : 0;
+	const FMotionFeatureLayout Layout(MotionMatchingBones.Num(), NumTrajectoryPoints);
+
+	// INDEX_NONE collects every animation that is not part of a shard
+	TSet<int32> ShardAnimationIndices;
+	for (int32 ShardIndex = 0; ShardIndex < Shards.Num(); ++ShardIndex)
+	{
+		if (InShardIndex == INDEX_NONE || InShardIndex == ShardIndex)
+		{
+			for (const UAnimSequence* Animation : Shards[ShardIndex].Animations)
+			{
+				ShardAnimationIndices.Add(SourceAnimations.IndexOfByKey(Animation));
+			}
+		}
+	}
+
+	const bool bBaseShard = InShardIndex == INDEX_NONE;
+	FMotionDatabasePayload::Write(MotionFrameData, Layout, MirrorTable.IsValid(), [&ShardAnimationIndices, bBaseShard](const FAnimationFrameData& FrameData)
+	{
+		return ShardAnimationIndices.Contains(FrameData.SourceAnimationIndex) != bBaseShard;
+	}, OutPayload);
+}
+#endif//WITH_EDITORONLY_DATA
+
+void UAnimationDatabase::BuildMirrorTable(FMotionMirrorTable& OutMirrorTable) const
+{
+	if (bBakeMirroredFrames)
+	{
+		OutMirrorTable.Build(Skeleton, MirrorBoneMapping, MotionMatchingBones, MirrorAxis);
+	}
+}
+
+float UAnimationDatabase::GetFrameTimeStep()
+{
+	return AnimationDatabaseGlobals::TimeStep;
 }
 
 void UAnimationDatabase::Initialize(class USkeleton* InSkeleton, const TArray<FName>& InBones)
 {
 	Skeleton = InSkeleton;
 	MotionMatchingBones = InBones;
+
+	PublishRuntimeSnapshot();
 }
 
 #if WITH_EDITOR
@@ -57,6 +588,8 @@ void UAnimationDatabase::AddSourceAnimations(TArray<UAnimSequence*> InAnimations
 			ProcessAnimation(Anim);
 		}
 	}
+
+	PublishRuntimeSnapshot();
 }
 
 void UAnimationDatabase::RemoveSourceAnimationAtIndex(const int InAnimationIndex)
@@ -67,7 +600,23 @@ void UAnimationDatabase::RemoveSourceAnimationAtIndex(const int InAnimationIndex
 	ClearFrameDataForAnimation(InAnimationIndex);
 	SourceAnimations.RemoveAt(InAnimationIndex);
 
+	if (RootMotionTracks.IsValidIndex(InAnimationIndex))
+	{
+		RootMotionTracks.RemoveAt(InAnimationIndex);
+	}
+
+	// The frames of the animations after the removed one moved down by one index
+	for (FAnimationFrameData& FrameData : MotionFrameData)
+	{
+		if (FrameData.SourceAnimationIndex > InAnimationIndex)
+		{
+			--FrameData.SourceAnimationIndex;
+		}
+	}
+
 	MarkPackageDirty();
+
+	PublishRuntimeSnapshot();
 }
 
 void UAnimationDatabase::ProcessAnimation(UAnimSequence* InAnimation)
@@ -88,8 +637,11 @@ void UAnimationDatabase::ClearAllFrameData()
 
 	MotionFrameData.Empty();
 	SourceAnimations.Empty();
+	RootMotionTracks.Empty();
 
 	MarkPackageDirty();
+
+	PublishRuntimeSnapshot();
 }
 
 void UAnimationDatabase::RebakeAllFrameData()
@@ -98,12 +650,43 @@ void UAnimationDatabase::RebakeAllFrameData()
 	{
 		Modify();
 
+		// Start from scratch, otherwise every rebake would add the frames again
+		MotionFrameData.Empty();
+
 		for (int i = 0; i < SourceAnimations.Num(); ++i)
 		{
 			RabakeFrameDataForAnimation(i);
 		}
 
 		MarkPackageDirty();
+
+		PublishRuntimeSnapshot();
+	}
+}
+
+void UAnimationDatabase::RemoveFrameData(const TArray<int32>& InFrameIndices)
+{
+	if (InFrameIndices.Num() > 0)
+	{
+		Modify();
+
+		// Remove from the back, so the indices that still have to be removed stay valid
+		TArray<int32> SortedFrameIndices = TSet<int32>(InFrameIndices).Array();
+		SortedFrameIndices.Sort(TGreater<int32>());
+
+		for (const int32 FrameIndex : SortedFrameIndices)
+		{
+			if (MotionFrameData.IsValidIndex(FrameIndex))
+			{
+				MotionFrameData.RemoveAt(FrameIndex, 1, false);
+			}
+		}
+
+		MotionFrameData.Shrink();
+
+		MarkPackageDirty();
+
+		PublishRuntimeSnapshot();
 	}
 }
 
@@ -137,25 +720,147 @@ void UAnimationDatabase::RabakeFrameDataForAnimation(const int InAnimationIndex,
 			ClearFrameDataForAnimation(InAnimationIndex);
 		}
 
-		const float PlayLength = AnimationSequence->GetPlayLength();
+		FMotionMirrorTable MirrorTable;
+		BuildMirrorTable(MirrorTable);
+
+		FAnimationDatabaseBakeSource BakeSource;
+		PrepareBakeSource(AnimationSequence, MotionMatchingBones, MirrorTable, BakeSource);
+
+		FAnimationDatabaseBakedAnimation BakedAnimation;
+		BakeAnimation(BakeSource, InAnimationIndex, MotionMatchingBones, MirrorTable, BakedAnimation);
+
+		RootMotionTracks.SetNum(SourceAnimations.Num());
+		RootMotionTracks[InAnimationIndex] = MoveTemp(BakedAnimation.RootMotionTrack);
+		MotionFrameData.Append(MoveTemp(BakedAnimation.FrameData));
+
+		MarkPackageDirty();
+	}
+}
+
+void UAnimationDatabase::PrepareBakeSource(const UAnimSequence* InAnimation, const TArray<FName>& InBones, const FMotionMirrorTable& InMirrorTable, FAnimationDatabaseBakeSource& OutBakeSource)
+{
+	check(IsInGameThread());
+
+	OutBakeSource.Initialize(InAnimation, InBones, AnimationDatabaseGlobals::RootMotionSampleRate);
+	OutBakeSource.DerivedDataKey = FAnimationDatabaseDerivedData::GetBakeKey(InAnimation, OutBakeSource, InBones, InMirrorTable, AnimationDatabaseGlobals::GetBakeSettingsKey());
+}
+
+void UAnimationDatabase::BakeAnimation(const FAnimationDatabaseBakeSource& InBakeSource, const int32 InAnimationIndex, const TArray<FName>& InBones, const FMotionMirrorTable& InMirrorTable, FAnimationDatabaseBakedAnimation& OutBakedAnimation)
+{
+	OutBakedAnimation.AnimationIndex = InAnimationIndex;
+	OutBakedAnimation.Animation = InBakeSource.Animation;
+	OutBakedAnimation.SettingsHash = FAnimationDatabaseBakedAnimation::GetSettingsHash(InBones, InMirrorTable);
+	OutBakedAnimation.FrameData.Reset();
+
+	if (!InBakeSource.IsValid())
+	{
+		return;
+	}
+
+	// Another machine (or an earlier bake) might already have baked this animation with the same settings
+	if (FAnimationDatabaseDerivedData::LoadBakedAnimation(InBakeSource.DerivedDataKey, InAnimationIndex, OutBakedAnimation))
+	{
+		return;
+	}
+
+	// The root motion is baked with the source, the frame data samples its velocity and trajectory from it
+	OutBakedAnimation.RootMotionTrack = InBakeSource.RootMotionTrack;
+
+	// Make sure we do not generate new frames at the end of the animation
+	const float MaxCurrentTime = InBakeSource.PlayLength - AnimationDatabaseGlobals::MaxFutureTime;
+
+	float CurrentPlayTime = 0.0f;
+
+	while (CurrentPlayTime <= MaxCurrentTime)
+	{
+		CurrentPlayTime += AnimationDatabaseGlobals::TimeStep;
+
+		FAnimationFrameData AnimationFrameData = FAnimationFrameData();
+		AnimationFrameData.ExtractAnimationData(InBakeSource, InAnimationIndex, CurrentPlayTime);
+
+		OutBakedAnimation.FrameData.Add(AnimationFrameData);
+
+		// The mirrored frame keeps pointing at the same animation, it is mirrored when the pose is evaluated
+		if (InMirrorTable.IsValid())
+		{
+			InMirrorTable.MirrorFrameData(AnimationFrameData);
+			OutBakedAnimation.FrameData.Add(AnimationFrameData);
+		}
+	}
+
+	FAnimationDatabaseDerivedData::StoreBakedAnimation(InBakeSource.DerivedDataKey, OutBakedAnimation);
+}
+
+bool UAnimationDatabase::ApplyBakedAnimations(TArray<FAnimationDatabaseBakedAnimation>& InBakedAnimations)
+{
+	check(IsInGameThread());
 
-		// Make sure we do not generate new frames at the end of the animation
-		const float MaxCurrentTime = PlayLength - AnimationDatabaseGlobals::MaxFutureTime;
-		
-		float CurrentPlayTime = 0.0f;
+	FMotionMirrorTable MirrorTable;
+	BuildMirrorTable(MirrorTable);
+	const uint32 SettingsHash = FAnimationDatabaseBakedAnimation::GetSettingsHash(MotionMatchingBones, MirrorTable);
 
-		while (CurrentPlayTime <= MaxCurrentTime)
+	// The bones or the mirror table changed while baking, the features would not match the rest of the database
+	for (const FAnimationDatabaseBakedAnimation& BakedAnimation : InBakedAnimations)
+	{
+		if (BakedAnimation.SettingsHash != SettingsHash)
 		{
-			CurrentPlayTime += AnimationDatabaseGlobals::TimeStep;
+			return false;
+		}
+	}
 
-			FAnimationFrameData AnimationFrameData = FAnimationFrameData();
-			AnimationFrameData.ExtractAnimationData(AnimationSequence, InAnimationIndex, CurrentPlayTime, MotionMatchingBones);
+	Modify();
+
+	// Swap everything in at once, so the runtime never sees a partially baked database
+	RootMotionTracks.SetNum(SourceAnimations.Num());
 
-			MotionFrameData.Add(AnimationFrameData);
+	for (FAnimationDatabaseBakedAnimation& BakedAnimation : InBakedAnimations)
+	{
+		// The source animations might have been added, removed or reordered while baking, find the animation where it is now
+		int32 AnimationIndex = BakedAnimation.AnimationIndex;
+		if (!SourceAnimations.IsValidIndex(AnimationIndex) || SourceAnimations[AnimationIndex] != BakedAnimation.Animation)
+		{
+			AnimationIndex = SourceAnimations.IndexOfByKey(BakedAnimation.Animation);
 		}
 
-		MarkPackageDirty();
+		// Removed while baking
+		if (AnimationIndex == INDEX_NONE || !BakedAnimation.Animation)
+		{
+			continue;
+		}
+
+		for (FAnimationFrameData& FrameData : BakedAnimation.FrameData)
+		{
+			FrameData.SourceAnimationIndex = AnimationIndex;
+		}
+
+		ClearFrameDataForAnimation(AnimationIndex);
+
+		RootMotionTracks[AnimationIndex] = MoveTemp(BakedAnimation.RootMotionTrack);
+		MotionFrameData.Append(MoveTemp(BakedAnimation.FrameData));
+	}
+
+	MarkPackageDirty();
+
+	PublishRuntimeSnapshot();
+
+	return true;
+}
+
+void UAnimationDatabase::AppendSourceAnimations(const TArray<UAnimSequence*>& InAnimations, TArray<int32>& OutAnimationIndices)
+{
+	Modify();
+
+	for (UAnimSequence* Anim : InAnimations)
+	{
+		if (Anim)
+		{
+			OutAnimationIndices.Add(SourceAnimations.Add(Anim));
+		}
 	}
+
+	RootMotionTracks.SetNum(SourceAnimations.Num());
+
+	MarkPackageDirty();
 }
 
 #endif//WITH_EDITOR
\ No newline at end of file
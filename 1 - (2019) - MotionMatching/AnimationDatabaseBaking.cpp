@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseBaking.h"
+
+#if WITH_EDITOR
+
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "AnimationUtils.h"
+#include "MotionMatchingMetaData.h"
+#include "AnimNotifyState_MotionCategory.h"
+
+
+FAnimationDatabaseBakeSource::FAnimationDatabaseBakeSource()
+	: Animation(nullptr)
+	, PlayLength(0.0f)
+	, NumFrames(0)
+	, Interpolation(EAnimInterpolationType::Linear)
+{
+}
+
+void FAnimationDatabaseBakeSource::Initialize(const UAnimSequence* InAnimation, const TArray<FName>& InBones, const float InRootMotionSampleRate)
+{
+	check(IsInGameThread());
+
+	*this = FAnimationDatabaseBakeSource();
+	Animation = InAnimation;
+
+	const USkeleton* Skeleton = InAnimation ? InAnimation->GetSkeleton() : nullptr;
+	if (!Skeleton)
+	{
+		return;
+	}
+
+	PlayLength = InAnimation->GetPlayLength();
+	NumFrames = InAnimation->GetRawNumberOfFrames();
+	Interpolation = InAnimation->Interpolation;
+
+	const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+	const int32 NumBones = ReferenceSkeleton.GetNum();
+
+	ReferencePose = ReferenceSkeleton.GetRefBonePose();
+	ParentIndices.SetNumUninitialized(NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		ParentIndices[BoneIndex] = ReferenceSkeleton.GetParentIndex(BoneIndex);
+	}
+
+	// Only the baked bones and their parents are sampled, there is no need to copy the other tracks
+	TArray<bool> RequiredBones;
+	RequiredBones.SetNumZeroed(NumBones);
+
+	for (const FName& BoneName : InBones)
+	{
+		const int32 BoneIndex = ReferenceSkeleton.FindBoneIndex(BoneName);
+		BoneIndices.Add(BoneIndex);
+
+		for (int32 ChainIndex = BoneIndex; ChainIndex != INDEX_NONE && !RequiredBones[ChainIndex]; ChainIndex = ParentIndices[ChainIndex])
+		{
+			RequiredBones[ChainIndex] = true;
+		}
+	}
+
+	// The root is sampled for every bone, it converts the bones to the space of the root
+	if (NumBones > 0)
+	{
+		RequiredBones[0] = true;
+	}
+
+	BoneTracks.Init(INDEX_NONE, NumBones);
+
+	const TArray<FRawAnimSequenceTrack>& RawTracks = InAnimation->GetRawAnimationData();
+	const TArray<FTrackToSkeletonMap>& TrackToSkeleton = InAnimation->GetRawTrackToSkeletonMapTable();
+
+	for (int32 TrackIndex = 0; TrackIndex < TrackToSkeleton.Num() && TrackIndex < RawTracks.Num(); ++TrackIndex)
+	{
+		const int32 BoneIndex = TrackToSkeleton[TrackIndex].BoneTreeIndex;
+		if (RequiredBones.IsValidIndex(BoneIndex) && RequiredBones[BoneIndex])
+		{
+			BoneTracks[BoneIndex] = Tracks.Add(RawTracks[TrackIndex]);
+		}
+	}
+
+	for (const UAnimMetaData* Data : InAnimation->GetMetaData())
+	{
+		if (const UMotionMatchingMetaData* MotionMatchingData = Cast<UMotionMatchingMetaData>(Data))
+		{
+			MetaDataFrame.Categories = MotionMatchingData->AnimationCategories;
+			MetaDataFrame.Pose = MotionMatchingData->AnimationPose;
+		}
+	}
+
+	for (const FAnimNotifyEvent& NotifyEvent : InAnimation->Notifies)
+	{
+		if (const UAnimNotifyState_MotionCategory* Category = Cast<UAnimNotifyState_MotionCategory>(NotifyEvent.NotifyStateClass))
+		{
+			FAnimationDatabaseBakeCategoryWindow& Window = CategoryWindows.AddDefaulted_GetRef();
+			Window.StartTime = NotifyEvent.GetTriggerTime();
+			Window.EndTime = NotifyEvent.GetEndTriggerTime();
+			Window.Categories = Category->Categories;
+		}
+	}
+
+	RootMotionTrack.Bake(InAnimation, InRootMotionSampleRate);
+}
+
+FTransform FAnimationDatabaseBakeSource::GetLocalBoneTransform(const int32 InBoneIndex, const float InTime) const
+{
+	if (!BoneTracks.IsValidIndex(InBoneIndex))
+	{
+		return FTransform::Identity;
+	}
+
+	const int32 TrackIndex = BoneTracks[InBoneIndex];
+	if (TrackIndex == INDEX_NONE)
+	{
+		return ReferencePose[InBoneIndex];
+	}
+
+	FTransform BoneTM;
+	FAnimationUtils::ExtractTransformFromTrack(FMath::Clamp(InTime, 0.0f, PlayLength), NumFrames, PlayLength, Tracks[TrackIndex], Interpolation, BoneTM);
+	return BoneTM;
+}
+
+FTransform FAnimationDatabaseBakeSource::GetComponentBoneTransform(const int32 InBoneIndex, const float InTime) const
+{
+	FTransform BoneTM = FTransform::Identity;
+
+	for (int32 ChainIndex = InBoneIndex; ParentIndices.IsValidIndex(ChainIndex); ChainIndex = ParentIndices[ChainIndex])
+	{
+		BoneTM = BoneTM * GetLocalBoneTransform(ChainIndex, InTime);
+	}
+
+	return BoneTM;
+}
+
+void FAnimationDatabaseBakeSource::GetNotifyCategories(const float InStartTime, const float InEndTime, FGameplayTagContainer& OutCategories) const
+{
+	for (const FAnimationDatabaseBakeCategoryWindow& Window : CategoryWindows)
+	{
+		if (Window.StartTime <= InEndTime && Window.EndTime > InStartTime)
+		{
+			OutCategories.AppendTags(Window.Categories);
+		}
+	}
+}
+
+#endif//WITH_EDITOR
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimationFrameData.h"
+#include "RootMotionTrack.h"
+#include "MotionMatchingMirroring.h"
+#include "GameplayTagContainer.h"
+#include "Animation/AnimSequence.h"
+
+#if WITH_EDITOR
+/** A motion category notify state of a source animation, see UAnimNotifyState_MotionCategory */
+struct FAnimationDatabaseBakeCategoryWindow
+{
+	float StartTime;
+	float EndTime;
+	FGameplayTagContainer Categories;
+};
+
+/**
+ * Everything the bake reads from a source animation, copied on the game thread before the bake is dispatched.
+ * The workers only read this copy, so an animation that is edited or reimported while baking is never touched from another thread.
+ */
+struct MOTIONMATCHING_API FAnimationDatabaseBakeSource
+{
+	FAnimationDatabaseBakeSource();
+
+	/** Copies the tracks of the given bones and their parents, the meta data, the category notifies and the root motion, game thread only */
+	void Initialize(const UAnimSequence* InAnimation, const TArray<FName>& InBones, const float InRootMotionSampleRate);
+
+	bool IsValid() const { return NumFrames > 0 && BoneIndices.Num() > 0; }
+
+	/** Transform of a skeleton bone relative to its parent, bones without a track keep their reference pose */
+	FTransform GetLocalBoneTransform(const int32 InBoneIndex, const float InTime) const;
+
+	/** Transform of a skeleton bone relative to the root of the skeleton */
+	FTransform GetComponentBoneTransform(const int32 InBoneIndex, const float InTime) const;
+
+	/** Adds the categories of the motion category notifies that overlap the given time range */
+	void GetNotifyCategories(const float InStartTime, const float InEndTime, FGameplayTagContainer& OutCategories) const;
+
+	/** Only identifies the animation, it is never read through this pointer */
+	const UAnimSequence* Animation;
+
+	float PlayLength;
+	int32 NumFrames;
+	EAnimInterpolationType Interpolation;
+
+	/** Skeleton bone index of every baked bone, INDEX_NONE when the skeleton does not have the bone */
+	TArray<int32> BoneIndices;
+
+	/** Parent and reference pose of every skeleton bone */
+	TArray<int32> ParentIndices;
+	TArray<FTransform> ReferencePose;
+
+	/** Index in Tracks of every skeleton bone, INDEX_NONE when the bone is not baked or not animated */
+	TArray<int32> BoneTracks;
+	TArray<FRawAnimSequenceTrack> Tracks;
+
+	/** Holds the categories and the pose of the motion matching meta data, every baked frame starts as a copy of it */
+	FAnimationFrameData MetaDataFrame;
+	TArray<FAnimationDatabaseBakeCategoryWindow> CategoryWindows;
+
+	FRootMotionTrack RootMotionTrack;
+
+	/** Key of the baked animation in the derived data cache, empty when the animation can not be identified */
+	FString DerivedDataKey;
+};
+#endif//WITH_EDITOR
+
+/** The baked data of a single source animation, produced away from the asset and applied to it afterwards */
+struct FAnimationDatabaseBakedAnimation
+{
+	FAnimationDatabaseBakedAnimation()
+		: AnimationIndex(INDEX_NONE)
+		, Animation(nullptr)
+		, SettingsHash(0)
+	{
+	}
+
+	/** Hash of the bones and the mirror table the features are baked with */
+	static uint32 GetSettingsHash(const TArray<FName>& InBones, const FMotionMirrorTable& InMirrorTable)
+	{
+		uint32 Hash = GetTypeHash(InBones.Num());
+		for (const FName& Bone : InBones)
+		{
+			Hash = HashCombine(Hash, GetTypeHash(Bone));
+		}
+
+		return HashCombine(Hash, InMirrorTable.GetFeatureHash());
+	}
+
+	/** Index in the source animations when the bake started, the result is applied to wherever Animation is when the bake finishes */
+	int32 AnimationIndex;
+	const UAnimSequence* Animation;
+
+	/** The result is only applied when the database still bakes with the same settings, see GetSettingsHash */
+	uint32 SettingsHash;
+
+	TArray<FAnimationFrameData> FrameData;
+	FRootMotionTrack RootMotionTrack;
+};
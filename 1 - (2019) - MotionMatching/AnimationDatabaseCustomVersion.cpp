@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+
+
+const FGuid FAnimationDatabaseCustomVersion::GUID(0xA0746325, 0x9E5B4C07, 0x94C5500D, 0x33EDBF57);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterAnimationDatabaseCustomVersion(FAnimationDatabaseCustomVersion::GUID, FAnimationDatabaseCustomVersion::LatestVersion, TEXT("AnimationDatabaseVer"));
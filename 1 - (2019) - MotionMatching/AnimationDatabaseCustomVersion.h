@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/** Custom serialization version for the data UAnimationDatabase::Serialize writes after its properties */
+struct MOTIONMATCHING_API FAnimationDatabaseCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made
+		BeforeCustomVersionWasAdded = 0,
+
+		// The cooked search matrix is stored as a bulk data payload
+		CookedSearchPayload,
+
+		// Every shard is cooked into its own bulk data payload after the search payload
+		CookedShardPayloads,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	// The GUID for this custom version number
+	const static FGuid GUID;
+
+private:
+	FAnimationDatabaseCustomVersion() {}
+};
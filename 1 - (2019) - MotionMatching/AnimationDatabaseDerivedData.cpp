@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseDerivedData.h"
+
+#if WITH_EDITOR
+
+#include "AnimationDatabaseBaking.h"
+#include "MotionMatchingMirroring.h"
+#include "Animation/AnimSequence.h"
+#include "DerivedDataCacheInterface.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+
+// Change this guid whenever the baked data changes in a way the key does not capture
+#define MOTIONMATCHING_BAKE_DERIVEDDATA_VER TEXT("6A0E2F4B1C7D4E93A85B3D2F90C1E7A4")
+
+namespace AnimationDatabaseDerivedDataGlobals
+{
+	static int32 UseDerivedDataCache = 1;
+	static FAutoConsoleVariableRef CVarUseDerivedDataCache(
+		TEXT("a.MotionMatching.UseDerivedDataCache"),
+		UseDerivedDataCache,
+		TEXT("Fetch and store baked animation database frames in the derived data cache.\n")
+		TEXT("0: Always bake locally\n")
+		TEXT("1: Use the derived data cache (default)"));
+
+	void SerializeBakedAnimation(FArchive& Ar, FAnimationDatabaseBakedAnimation& BakedAnimation)
+	{
+		int32 NumFrames = BakedAnimation.FrameData.Num();
+		Ar << NumFrames;
+
+		if (Ar.IsLoading())
+		{
+			BakedAnimation.FrameData.SetNum(NumFrames);
+		}
+
+		for (FAnimationFrameData& FrameData : BakedAnimation.FrameData)
+		{
+			FAnimationFrameData::StaticStruct()->SerializeItem(Ar, &FrameData, nullptr);
+		}
+
+		FRootMotionTrack::StaticStruct()->SerializeItem(Ar, &BakedAnimation.RootMotionTrack, nullptr);
+	}
+
+	/** Hashes the skeleton and the categories the bake source copied, the tracks are covered by the raw data guid */
+	uint32 GetBakeSourceHash(const FAnimationDatabaseBakeSource& BakeSource)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(BakeSource.NumFrames), GetTypeHash(BakeSource.PlayLength));
+		Hash = HashCombine(Hash, GetTypeHash((uint8)BakeSource.Interpolation));
+
+		for (const int32 BoneIndex : BakeSource.BoneIndices)
+		{
+			Hash = HashCombine(Hash, GetTypeHash(BoneIndex));
+		}
+
+		// The bone hierarchy and the reference pose decide the transforms of the bones without a track
+		for (int32 BoneIndex = 0; BoneIndex < BakeSource.ParentIndices.Num(); ++BoneIndex)
+		{
+			const FTransform& RefBoneTM = BakeSource.ReferencePose[BoneIndex];
+
+			Hash = HashCombine(Hash, GetTypeHash(BakeSource.ParentIndices[BoneIndex]));
+			Hash = HashCombine(Hash, GetTypeHash(RefBoneTM.GetTranslation()));
+			Hash = HashCombine(Hash, GetTypeHash(RefBoneTM.GetRotation().Euler()));
+			Hash = HashCombine(Hash, GetTypeHash(RefBoneTM.GetScale3D()));
+		}
+
+		Hash = HashCombine(Hash, GetTypeHash(BakeSource.MetaDataFrame.Categories.ToStringSimple()));
+
+		for (const FAnimationDatabaseBakeCategoryWindow& Window : BakeSource.CategoryWindows)
+		{
+			Hash = HashCombine(Hash, HashCombine(GetTypeHash(Window.StartTime), GetTypeHash(Window.EndTime)));
+			Hash = HashCombine(Hash, GetTypeHash(Window.Categories.ToStringSimple()));
+		}
+
+		return Hash;
+	}
+}
+
+
+bool FAnimationDatabaseDerivedData::IsEnabled()
+{
+	return AnimationDatabaseDerivedDataGlobals::UseDerivedDataCache != 0;
+}
+
+FString FAnimationDatabaseDerivedData::GetBakeKey(const UAnimSequence* InAnimation, const FAnimationDatabaseBakeSource& InBakeSource, const TArray<FName>& InBones, const FMotionMirrorTable& InMirrorTable, const FString& InSettingsKey)
+{
+	// Without a raw data guid there is no way to tell whether the animation changed
+	if (!InAnimation || !InAnimation->RawDataGuid.IsValid())
+	{
+		return FString();
+	}
+
+	FString KeySuffix = InAnimation->RawDataGuid.ToString();
+
+	uint32 BonesHash = GetTypeHash(InBones.Num());
+	for (const FName& Bone : InBones)
+	{
+		BonesHash = HashCombine(BonesHash, GetTypeHash(Bone.ToString()));
+	}
+
+	KeySuffix += FString::Printf(TEXT("_%08X_%08X_%08X_"), BonesHash, InMirrorTable.GetFeatureHash(), AnimationDatabaseDerivedDataGlobals::GetBakeSourceHash(InBakeSource));
+
+	// The root motion track is extracted with these
+	KeySuffix += FString::Printf(TEXT("%d%d%d%d_%s_"),
+		InAnimation->bEnableRootMotion ? 1 : 0,
+		(int32)InAnimation->RootMotionRootLock.GetValue(),
+		InAnimation->bForceRootLock ? 1 : 0,
+		InAnimation->bUseNormalizedRootMotionScale ? 1 : 0,
+		*InAnimation->RetargetSource.ToString());
+
+	// Covers the compression settings, the root motion is sampled from the compressed data
+	KeySuffix += InAnimation->GetDDCCacheKeySuffix(false);
+	KeySuffix += TEXT("_");
+	KeySuffix += InSettingsKey;
+
+	return FDerivedDataCacheInterface::BuildCacheKey(TEXT("MOTIONMATCHING_BAKE"), MOTIONMATCHING_BAKE_DERIVEDDATA_VER, *KeySuffix);
+}
+
+bool FAnimationDatabaseDerivedData::LoadBakedAnimation(const FString& InKey, const int32 InAnimationIndex, FAnimationDatabaseBakedAnimation& OutBakedAnimation)
+{
+	if (InKey.IsEmpty() || !IsEnabled())
+	{
+		return false;
+	}
+
+	TArray<uint8> Data;
+	if (!GetDerivedDataCacheRef().GetSynchronous(*InKey, Data))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data, true);
+	FNameAsStringProxyArchive Ar(Reader);
+	AnimationDatabaseDerivedDataGlobals::SerializeBakedAnimation(Ar, OutBakedAnimation);
+
+	if (Ar.IsError())
+	{
+		OutBakedAnimation.FrameData.Reset();
+		return false;
+	}
+
+	// The same animation can be at a different index in another database
+	for (FAnimationFrameData& FrameData : OutBakedAnimation.FrameData)
+	{
+		FrameData.SourceAnimationIndex = InAnimationIndex;
+	}
+
+	return true;
+}
+
+void FAnimationDatabaseDerivedData::StoreBakedAnimation(const FString& InKey, const FAnimationDatabaseBakedAnimation& InBakedAnimation)
+{
+	if (InKey.IsEmpty() || !IsEnabled())
+	{
+		return;
+	}
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data, true);
+	FNameAsStringProxyArchive Ar(Writer);
+	AnimationDatabaseDerivedDataGlobals::SerializeBakedAnimation(Ar, const_cast<FAnimationDatabaseBakedAnimation&>(InBakedAnimation));
+
+	GetDerivedDataCacheRef().Put(*InKey, Data);
+}
+
+#endif//WITH_EDITOR
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_EDITOR
+
+class UAnimSequence;
+class FMotionMirrorTable;
+struct FAnimationDatabaseBakedAnimation;
+struct FAnimationDatabaseBakeSource;
+
+/**
+ * Stores the baked data of source animations in the derived data cache.
+ * Every machine that bakes the same animation with the same bones and settings fetches the result instead of extracting it again.
+ */
+class MOTIONMATCHING_API FAnimationDatabaseDerivedData
+{
+public:
+	/** Returns false when the derived data cache is disabled */
+	static bool IsEnabled();
+
+	/**
+	 * Builds the cache key of a baked animation, returns an empty string when the animation can not be identified.
+	 * Covers everything the bake reads: the raw data, the root motion, retarget and compression settings of the animation and the skeleton the bake source copied.
+	 */
+	static FString GetBakeKey(const UAnimSequence* InAnimation, const FAnimationDatabaseBakeSource& InBakeSource, const TArray<FName>& InBones, const FMotionMirrorTable& InMirrorTable, const FString& InSettingsKey);
+
+	/** Fetches a baked animation, the frames are remapped to the given animation index */
+	static bool LoadBakedAnimation(const FString& InKey, const int32 InAnimationIndex, FAnimationDatabaseBakedAnimation& OutBakedAnimation);
+
+	static void StoreBakedAnimation(const FString& InKey, const FAnimationDatabaseBakedAnimation& InBakedAnimation);
+};
+
+#endif//WITH_EDITOR
@@ -7,6 +7,9 @@
 #include "MotionMatchingUtilities.h"
 #include "MotionMatchingMetaData.h"
 #include "AnimNotifyState_MotionCategory.h"
+#include "RootMotionTrack.h"
+#include "MotionTrajectory.h"
+#include "AnimationDatabaseBaking.h"
 
 
 namespace FrameDataGlobals
@@ -23,23 +26,25 @@ FAnimationFrameData::FAnimationFrameData()
 	: SourceAnimationIndex(INDEX_NONE)
 	, StartTime(0.0f)
 	, MotionVelocity(FVector::ZeroVector)
+	, bMirrored(false)
 {
-	MotionTrajectory.Empty();
+	MotionTrajectory.Reset();
 	MotionBonesData.Empty();
 }
 
-FAnimationFrameData::FAnimationFrameData(const UAnimSequence* InAnimSequence, const int InSourceIndex, const float InTime, const TArray<FName> InBones)
+FAnimationFrameData::FAnimationFrameData(const UAnimSequence* InAnimSequence, const FRootMotionTrack& InRootMotionTrack, const int InSourceIndex, const float InTime, const TArray<FName>& InBones)
 	: SourceAnimationIndex(INDEX_NONE)
 	, StartTime(0.0f)
 	, MotionVelocity(FVector::ZeroVector)
+	, bMirrored(false)
 {
-	MotionTrajectory.Empty();
+	MotionTrajectory.Reset();
 	MotionBonesData.Empty();
 
-	ExtractAnimationData(InAnimSequence, InSourceIndex, InTime, InBones);
+	ExtractAnimationData(InAnimSequence, InRootMotionTrack, InSourceIndex, InTime, InBones);
 }
 
-void FAnimationFrameData::ExtractAnimationData(const UAnimSequence* InAnimSequence, const int InSourceIndex, const float InTime, const TArray<FName> InBones)
+void FAnimationFrameData::ExtractAnimationData(const UAnimSequence* InAnimSequence, const FRootMotionTrack& InRootMotionTrack, const int InSourceIndex, const float InTime, const TArray<FName>& InBones)
 {
 	if (InAnimSequence)
 	{
@@ -48,15 +53,59 @@ void FAnimationFrameData::ExtractAnimationData(const UAnimSequence* InAnimSequen
 
 		InitializeFromMetaData(InAnimSequence);
 		InitializeBoneDataFromAnimation(InAnimSequence, InTime, InBones);
-		InitializeTrajectoryData(InAnimSequence, InTime);
+		InitializeTrajectoryData(InRootMotionTrack, InTime);
 
 		// Get the animation velocity between the current time and the next time
-		const FVector TempVelocity = InAnimSequence->ExtractRootMotion(StartTime, FrameDataGlobals::NextTimeDelta, true).GetTranslation();
-		const FVector Velocity = TempVelocity.GetSafeNormal() * (TempVelocity.Size() / FrameDataGlobals::NextTimeDelta);
+		MotionVelocity = InRootMotionTrack.GetVelocity(StartTime, FrameDataGlobals::NextTimeDelta);
+	}
+}
+
+#if WITH_EDITOR
+void FAnimationFrameData::ExtractAnimationData(const FAnimationDatabaseBakeSource& InSource, const int InSourceIndex, const float InTime)
+{
+	if (InSource.IsValid())
+	{
+		// Start from the meta data of the animation, the notifies add their categories on top
+		Categories = InSource.MetaDataFrame.Categories;
+		Pose = InSource.MetaDataFrame.Pose;
+		InSource.GetNotifyCategories(InTime - FrameDataGlobals::PreviousTimeDelta, InTime, Categories);
+
+		StartTime = InTime;
+		SourceAnimationIndex = InSourceIndex;
+
+		InitializeBoneDataFromBakeSource(InSource, InTime);
+		InitializeTrajectoryData(InSource.RootMotionTrack, InTime);
+
+		// Get the animation velocity between the current time and the next time
+		MotionVelocity = InSource.RootMotionTrack.GetVelocity(StartTime, FrameDataGlobals::NextTimeDelta);
+	}
+}
+
+void FAnimationFrameData::InitializeBoneDataFromBakeSource(const FAnimationDatabaseBakeSource& InSource, const float InTime)
+{
+	MotionBonesData.Empty();
+
+	// Required for conversion of world to component space
+	const FTransform RootTM = InSource.GetLocalBoneTransform(FrameDataGlobals::RootBoneIndex, InTime);
+
+	for (const int32 BoneIndex : InSource.BoneIndices)
+	{
+		FMotionBoneData BoneData;
+
+		const FTransform CurrentTimeBoneTM = InSource.GetComponentBoneTransform(BoneIndex, InTime);
+		const FTransform PreviousTimeBoneTM = InSource.GetComponentBoneTransform(BoneIndex, InTime - FrameDataGlobals::PreviousTimeDelta);
+
+		// Calculate velocity
+		const FVector Velocity = (CurrentTimeBoneTM.GetLocation() - PreviousTimeBoneTM.GetLocation());
+		const float VelocityDelta = Velocity.Size() / FrameDataGlobals::PreviousTimeDelta;
 
-		MotionVelocity = Velocity;
+		BoneData.BonePosition = RootTM.InverseTransformPositionNoScale(CurrentTimeBoneTM.GetLocation());
+		BoneData.BoneVelocity = RootTM.InverseTransformVectorNoScale(Velocity.GetSafeNormal() * VelocityDelta);
+
+		MotionBonesData.Add(BoneData);
 	}
 }
+#endif//WITH_EDITOR
 
 void FAnimationFrameData::InitializeFromMetaData(const UAnimSequence* InAnimSequence, const float InTime)
 {
@@ -139,18 +188,20 @@ void FAnimationFrameData::InitializeBoneDataFromAnimation(const UAnimSequence* I
 	}
 }
 
-void FAnimationFrameData::InitializeTrajectoryData(const UAnimSequence* InAnimSequence, const float InTime)
+void FAnimationFrameData::InitializeTrajectoryData(const FRootMotionTrack& InRootMotionTrack, const float InTime)
 {
-	if (InAnimSequence)
+	if (InRootMotionTrack.IsValid())
 	{
-		MotionTrajectory.Empty();
+		check(FMotionTrajectory::CanHoldIntervals(FMotionMatchingUtils::TrajectoryIntervals));
+
+		MotionTrajectory.Reset();
 
-		AnimationTransform = InAnimSequence->ExtractRootMotion(InTime, 0.0f, true);
+		AnimationTransform = InRootMotionTrack.ExtractRootMotion(InTime, 0.0f, true);
 
 		for (const float& TimeDelay : FMotionMatchingUtils::TrajectoryIntervals)
 		{
-			FTransform RootMotionTM = InAnimSequence->ExtractRootMotion(InTime, TimeDelay, true);
-			MotionTrajectory.Add(FTrajectoryPoint(RootMotionTM.GetTranslation(), RootMotionTM.GetRotation(), TimeDelay));
+			FTransform RootMotionTM = InRootMotionTrack.ExtractRootMotion(InTime, TimeDelay, true);
+			MotionTrajectory.Add(RootMotionTM.GetTranslation(), RootMotionTM.GetRotation(), TimeDelay);
 		}
 	}
 }
@@ -0,0 +1,300 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseAnalysisCommandlet.h"
+
+#include "AnimationDatabase.h"
+#include "AnimationFrameData.h"
+#include "MotionDatabasePayload.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingMirroring.h"
+#include "MotionTrajectory.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "Misc/PackageName.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAnimationDatabaseAnalysis, Log, All);
+
+namespace AnimationDatabaseAnalysisGlobals
+{
+	const float DefaultThreshold = 0.25f;
+	const float DefaultSpeedBin = 50.0f;
+	const float DefaultTurnRateBin = 30.0f;
+	const float DefaultMaxTurnRate = 180.0f;
+
+	// Dimensions that barely change over the whole database are not used to tell frames apart
+	const float MinStandardDeviation = KINDA_SMALL_NUMBER;
+}
+
+
+UAnimationDatabaseAnalysisCommandlet::UAnimationDatabaseAnalysisCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAnimationDatabaseAnalysisCommandlet::Main(const FString& Params)
+{
+	FString DatabasePath;
+	if (!FParse::Value(*Params, TEXT("Database="), DatabasePath))
+	{
+		UE_LOG(LogAnimationDatabaseAnalysis, Error, TEXT("No database specified, use -Database=/Game/Path/Database"));
+		return 1;
+	}
+
+	UAnimationDatabase* Database = LoadObject<UAnimationDatabase>(nullptr, *DatabasePath);
+	if (!Database)
+	{
+		UE_LOG(LogAnimationDatabaseAnalysis, Error, TEXT("Could not load animation database %s"), *DatabasePath);
+		return 1;
+	}
+
+	FString OutputPath = DatabasePath + TEXT("_Pruned");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	float Threshold = AnimationDatabaseAnalysisGlobals::DefaultThreshold;
+	float SpeedBin = AnimationDatabaseAnalysisGlobals::DefaultSpeedBin;
+	float TurnRateBin = AnimationDatabaseAnalysisGlobals::DefaultTurnRateBin;
+	float MaxTurnRate = AnimationDatabaseAnalysisGlobals::DefaultMaxTurnRate;
+	FParse::Value(*Params, TEXT("Threshold="), Threshold);
+	FParse::Value(*Params, TEXT("SpeedBin="), SpeedBin);
+	FParse::Value(*Params, TEXT("TurnRateBin="), TurnRateBin);
+	FParse::Value(*Params, TEXT("MaxTurnRate="), MaxTurnRate);
+
+	TArray<int32> RedundantFrames;
+	TArray<int32> KeptFrames;
+	FindRedundantFrames(Database, Threshold, RedundantFrames, KeptFrames);
+
+	const int32 NumFrames = Database->GetMotionFrameData().Num();
+	UE_LOG(LogAnimationDatabaseAnalysis, Display, TEXT("%s: %d of %d frames are within %.3f of another frame (%.1f%%)"),
+		*Database->GetName(), RedundantFrames.Num(), NumFrames, Threshold, NumFrames > 0 ? 100.0f * RedundantFrames.Num() / NumFrames : 0.0f);
+
+	// The coverage of the pruned database is what the animators end up with
+	WriteCoverageReport(Database, KeptFrames, FMath::Max(SpeedBin, 1.0f), FMath::Max(TurnRateBin, 1.0f), MaxTurnRate);
+
+	if (RedundantFrames.Num() > 0 && !SavePrunedDatabase(Database, OutputPath, RedundantFrames))
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+void UAnimationDatabaseAnalysisCommandlet::FindRedundantFrames(const UAnimationDatabase* InDatabase, const float InThreshold, TArray<int32>& OutRedundantFrames, TArray<int32>& OutKeptFrames) const
+{
+	const TArray<FAnimationFrameData> FrameData = InDatabase->GetMotionFrameData();
+	const int32 NumTrajectoryPoints = FrameData.Num() > 0 ? FrameData[0].MotionTrajectory.Num() : 0;
+	const FMotionFeatureLayout Layout(InDatabase->GetMotionMatchingBones().Num(), NumTrajectoryPoints);
+
+	// Flatten the frames the same way the runtime does, and remember which frame every row came from
+	TArray<int32> RowToFrame;
+	FMotionDatabasePayloadData Payload;
+	FMotionDatabasePayload::Write(FrameData, Layout, true, [&RowToFrame, &FrameData](const FAnimationFrameData& Frame)
+	{
+		RowToFrame.Add(&Frame - FrameData.GetData());
+		return true;
+	}, Payload);
+
+	const FMotionDatabasePayloadHeader* Header = FMotionDatabasePayload::GetValidatedHeader(Payload.GetData(), Payload.Num());
+	if (!Header || Header->NumFrames == 0)
+	{
+		return;
+	}
+
+	const int32 NumRows = Header->NumFrames;
+	const int32 Dimension = Layout.GetDimension();
+	const int32 Stride = Layout.GetStride();
+	const float* Rows = reinterpret_cast<const float*>(Payload.GetData() + Header->FeaturesOffset);
+
+	// Normalize every dimension to zero mean and unit variance, otherwise the dimensions with the largest units decide everything
+	TArray<float> Mean;
+	TArray<float> InverseDeviation;
+	Mean.AddZeroed(Dimension);
+	InverseDeviation.AddZeroed(Dimension);
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		for (int32 Dim = 0; Dim < Dimension; ++Dim)
+		{
+			Mean[Dim] += Rows[Row * Stride + Dim];
+		}
+	}
+
+	for (int32 Dim = 0; Dim < Dimension; ++Dim)
+	{
+		Mean[Dim] /= NumRows;
+	}
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		for (int32 Dim = 0; Dim < Dimension; ++Dim)
+		{
+			InverseDeviation[Dim] += FMath::Square(Rows[Row * Stride + Dim] - Mean[Dim]);
+		}
+	}
+
+	for (int32 Dim = 0; Dim < Dimension; ++Dim)
+	{
+		const float StandardDeviation = FMath::Sqrt(InverseDeviation[Dim] / NumRows);
+		InverseDeviation[Dim] = StandardDeviation > AnimationDatabaseAnalysisGlobals::MinStandardDeviation ? 1.0f / StandardDeviation : 0.0f;
+	}
+
+	TArray<float> Normalized;
+	Normalized.SetNumUninitialized(NumRows * Dimension);
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		for (int32 Dim = 0; Dim < Dimension; ++Dim)
+		{
+			Normalized[Row * Dimension + Dim] = (Rows[Row * Stride + Dim] - Mean[Dim]) * InverseDeviation[Dim];
+		}
+	}
+
+	// Greedy pass, a frame is kept unless a frame that is already kept is within the threshold
+	const float ThresholdSquared = FMath::Square(InThreshold);
+	TArray<int32> KeptRows;
+
+	for (int32 Row = 0; Row < NumRows; ++Row)
+	{
+		const float* Features = &Normalized[Row * Dimension];
+		bool bIsRedundant = false;
+
+		for (const int32 KeptRow : KeptRows)
+		{
+			const float* KeptFeatures = &Normalized[KeptRow * Dimension];
+
+			float DistanceSquared = 0.0f;
+			for (int32 Dim = 0; Dim < Dimension && DistanceSquared <= ThresholdSquared; ++Dim)
+			{
+				DistanceSquared += FMath::Square(Features[Dim] - KeptFeatures[Dim]);
+			}
+
+			if (DistanceSquared <= ThresholdSquared)
+			{
+				bIsRedundant = true;
+				break;
+			}
+		}
+
+		if (bIsRedundant)
+		{
+			OutRedundantFrames.Add(RowToFrame[Row]);
+		}
+		else
+		{
+			KeptRows.Add(Row);
+			OutKeptFrames.Add(RowToFrame[Row]);
+		}
+	}
+}
+
+void UAnimationDatabaseAnalysisCommandlet::WriteCoverageReport(const UAnimationDatabase* InDatabase, const TArray<int32>& InFrames, const float InSpeedBin, const float InTurnRateBin, const float InMaxTurnRate) const
+{
+	const TArray<FAnimationFrameData> FrameData = InDatabase->GetMotionFrameData();
+
+	TArray<float> Speeds;
+	TArray<float> TurnRates;
+	float MaxSpeed = 0.0f;
+
+	for (const int32 FrameIndex : InFrames)
+	{
+		const FAnimationFrameData& Frame = FrameData[FrameIndex];
+		const FMotionTrajectory& Trajectory = Frame.MotionTrajectory;
+
+		// Turn rate over the whole future trajectory. The yaw is accumulated point by point from the frame itself,
+		// the last yaw alone wraps around +-180 degrees and loses every turn of more than half a circle
+		float TurnRate = 0.0f;
+		float AccumulatedYaw = 0.0f;
+		float PreviousYaw = 0.0f;
+		float FutureTime = 0.0f;
+
+		for (int32 PointIndex = 0; PointIndex < Trajectory.Num(); ++PointIndex)
+		{
+			if (Trajectory.GetTime(PointIndex) <= 0.0f)
+			{
+				continue;
+			}
+
+			const float Yaw = Trajectory.GetRotation(PointIndex).Rotator().Yaw;
+			AccumulatedYaw += FMath::FindDeltaAngleDegrees(PreviousYaw, Yaw);
+			PreviousYaw = Yaw;
+			FutureTime = Trajectory.GetTime(PointIndex);
+		}
+
+		if (FutureTime > 0.0f)
+		{
+			TurnRate = AccumulatedYaw / FutureTime;
+		}
+
+		Speeds.Add(Frame.MotionVelocity.Size2D());
+		TurnRates.Add(TurnRate);
+		MaxSpeed = FMath::Max(MaxSpeed, Speeds.Last());
+	}
+
+	const int32 NumSpeedBins = FMath::Max(FMath::CeilToInt(MaxSpeed / InSpeedBin), 1);
+	const int32 NumTurnRateBins = FMath::Max(FMath::CeilToInt(2.0f * InMaxTurnRate / InTurnRateBin), 1);
+
+	TArray<int32> Counts;
+	Counts.AddZeroed(NumSpeedBins * NumTurnRateBins);
+
+	for (int32 Index = 0; Index < Speeds.Num(); ++Index)
+	{
+		const int32 SpeedBin = FMath::Clamp(FMath::FloorToInt(Speeds[Index] / InSpeedBin), 0, NumSpeedBins - 1);
+		const int32 TurnRateBin = FMath::Clamp(FMath::FloorToInt((TurnRates[Index] + InMaxTurnRate) / InTurnRateBin), 0, NumTurnRateBins - 1);
+		++Counts[SpeedBin * NumTurnRateBins + TurnRateBin];
+	}
+
+	FString Report = TEXT("SpeedMin,SpeedMax,TurnRateMin,TurnRateMax,Frames\n");
+	int32 NumGaps = 0;
+
+	for (int32 SpeedBin = 0; SpeedBin < NumSpeedBins; ++SpeedBin)
+	{
+		for (int32 TurnRateBin = 0; TurnRateBin < NumTurnRateBins; ++TurnRateBin)
+		{
+			const float SpeedMin = SpeedBin * InSpeedBin;
+			const float TurnRateMin = TurnRateBin * InTurnRateBin - InMaxTurnRate;
+			const int32 Count = Counts[SpeedBin * NumTurnRateBins + TurnRateBin];
+
+			Report += FString::Printf(TEXT("%.1f,%.1f,%.1f,%.1f,%d\n"), SpeedMin, SpeedMin + InSpeedBin, TurnRateMin, TurnRateMin + InTurnRateBin, Count);
+
+			if (Count == 0)
+			{
+				++NumGaps;
+				UE_LOG(LogAnimationDatabaseAnalysis, Display, TEXT("Coverage gap: speed %.0f-%.0f cm/s, turn rate %.0f-%.0f deg/s"), SpeedMin, SpeedMin + InSpeedBin, TurnRateMin, TurnRateMin + InTurnRateBin);
+			}
+		}
+	}
+
+	const FString ReportFile = FPaths::ProjectSavedDir() / TEXT("MotionMatching") / (InDatabase->GetName() + TEXT("_Coverage.csv"));
+	FFileHelper::SaveStringToFile(Report, *ReportFile);
+
+	UE_LOG(LogAnimationDatabaseAnalysis, Display, TEXT("%d of %d speed and turn rate bins have no frames, report written to %s"), NumGaps, Counts.Num(), *ReportFile);
+}
+
+bool UAnimationDatabaseAnalysisCommandlet::SavePrunedDatabase(UAnimationDatabase* InDatabase, const FString& InOutputPath, const TArray<int32>& InRedundantFrames) const
+{
+	const FString PackageName = FPackageName::ObjectPathToPackageName(InOutputPath);
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	if (!Package)
+	{
+		UE_LOG(LogAnimationDatabaseAnalysis, Error, TEXT("Could not create package %s"), *PackageName);
+		return false;
+	}
+
+	UAnimationDatabase* PrunedDatabase = DuplicateObject<UAnimationDatabase>(InDatabase, Package, *FPackageName::GetShortName(PackageName));
+	PrunedDatabase->SetFlags(RF_Public | RF_Standalone);
+	PrunedDatabase->RemoveFrameData(InRedundantFrames);
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	if (!UPackage::SavePackage(Package, PrunedDatabase, RF_Public | RF_Standalone, *Filename))
+	{
+		UE_LOG(LogAnimationDatabaseAnalysis, Error, TEXT("Could not save the pruned database to %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogAnimationDatabaseAnalysis, Display, TEXT("Pruned database with %d frames saved to %s"), PrunedDatabase->GetMotionFrameData().Num(), *Filename);
+	return true;
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AnimationDatabaseAnalysisCommandlet.generated.h"
+
+class UAnimationDatabase;
+
+/**
+ * Offline analysis of an animation database.
+ * Finds frames that are near duplicates of other frames in normalized feature space, writes a copy of the database without them,
+ * and reports the speeds and turn rates that have no frame close to them.
+ *
+ * Usage: UE4Editor-Cmd.exe Project.uproject -run=AnimationDatabaseAnalysis -Database=/Game/Path/Database
+ *        [-Output=/Game/Path/Database_Pruned] [-Threshold=0.25] [-SpeedBin=50] [-TurnRateBin=30] [-MaxTurnRate=180]
+ */
+UCLASS()
+class UAnimationDatabaseAnalysisCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAnimationDatabaseAnalysisCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Returns the indices of the frames that are within the threshold of a frame that is kept */
+	void FindRedundantFrames(const UAnimationDatabase* InDatabase, const float InThreshold, TArray<int32>& OutRedundantFrames, TArray<int32>& OutKeptFrames) const;
+
+	/** Writes a csv with the amount of frames per speed and turn rate bin, and logs the bins without frames */
+	void WriteCoverageReport(const UAnimationDatabase* InDatabase, const TArray<int32>& InFrames, const float InSpeedBin, const float InTurnRateBin, const float InMaxTurnRate) const;
+
+	/** Duplicates the database into a new package without the redundant frames */
+	bool SavePrunedDatabase(UAnimationDatabase* InDatabase, const FString& InOutputPath, const TArray<int32>& InRedundantFrames) const;
+};
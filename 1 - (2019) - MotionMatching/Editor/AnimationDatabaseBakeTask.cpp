@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseBakeTask.h"
+
+#include "AnimationDatabase.h"
+#include "Animation/AnimSequence.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+
+#define LOCTEXT_NAMESPACE "AnimationDatabaseBakeTask"
+
+namespace AnimationDatabaseBakeTaskGlobals
+{
+	// How often the game thread checks whether the workers are done
+	const float PollInterval = 0.1f;
+}
+
+TMap<const UAnimationDatabase*, TSharedPtr<FAnimationDatabaseBakeTask>> FAnimationDatabaseBakeTask::RunningTasks;
+
+
+TSharedPtr<FAnimationDatabaseBakeTask> FAnimationDatabaseBakeTask::Launch(UAnimationDatabase* InDatabase, const TArray<int32>& InAnimationIndices)
+{
+	check(IsInGameThread());
+
+	if (!InDatabase)
+	{
+		return nullptr;
+	}
+
+	TArray<int32> AnimationIndices = InAnimationIndices;
+
+	// Take over the animations of the running bake, otherwise cancelling it would leave them stale
+	if (TSharedPtr<FAnimationDatabaseBakeTask> RunningTask = Find(InDatabase))
+	{
+		RunningTask->GetCurrentAnimationIndices(AnimationIndices);
+
+		RunningTask->Cancel();
+	}
+
+	TSharedPtr<FAnimationDatabaseBakeTask> Task = MakeShareable(new FAnimationDatabaseBakeTask(InDatabase, AnimationIndices));
+	RunningTasks.Add(InDatabase, Task);
+
+	Task->Start();
+	return Task;
+}
+
+TSharedPtr<FAnimationDatabaseBakeTask> FAnimationDatabaseBakeTask::Find(const UAnimationDatabase* InDatabase)
+{
+	const TSharedPtr<FAnimationDatabaseBakeTask>* Task = RunningTasks.Find(InDatabase);
+	return (Task && !(*Task)->IsCancelled()) ? *Task : nullptr;
+}
+
+FAnimationDatabaseBakeTask::FAnimationDatabaseBakeTask(UAnimationDatabase* InDatabase, const TArray<int32>& InAnimationIndices)
+	: Database(InDatabase)
+	, bCancelRequested(false)
+{
+	Bones = Database->GetMotionMatchingBones();
+	Database->BuildMirrorTable(MirrorTable);
+
+	const TArray<UAnimSequence*> SourceAnimations = Database->GetSourceAnimations();
+
+	for (const int32 AnimationIndex : InAnimationIndices)
+	{
+		if (SourceAnimations.IsValidIndex(AnimationIndex) && SourceAnimations[AnimationIndex])
+		{
+			FAnimationDatabaseBakedAnimation& BakedAnimation = BakedAnimations.AddDefaulted_GetRef();
+			BakedAnimation.AnimationIndex = AnimationIndex;
+			BakedAnimation.Animation = SourceAnimations[AnimationIndex];
+
+			// Copy what the workers need here, they never read the animation itself
+			UAnimationDatabase::PrepareBakeSource(SourceAnimations[AnimationIndex], Bones, MirrorTable, BakeSources.AddDefaulted_GetRef());
+		}
+	}
+}
+
+void FAnimationDatabaseBakeTask::GetCurrentAnimationIndices(TArray<int32>& OutAnimationIndices) const
+{
+	const TArray<UAnimSequence*> SourceAnimations = Database ? Database->GetSourceAnimations() : TArray<UAnimSequence*>();
+
+	// The indices the bake started with are stale once the source animations changed, look the animations up instead
+	for (const FAnimationDatabaseBakedAnimation& BakedAnimation : BakedAnimations)
+	{
+		const int32 AnimationIndex = SourceAnimations.IndexOfByKey(BakedAnimation.Animation);
+		if (AnimationIndex != INDEX_NONE)
+		{
+			OutAnimationIndices.AddUnique(AnimationIndex);
+		}
+	}
+}
+
+FAnimationDatabaseBakeTask::~FAnimationDatabaseBakeTask()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+}
+
+void FAnimationDatabaseBakeTask::Start()
+{
+	FNotificationInfo Info(TAttribute<FText>::Create(TAttribute<FText>::FGetter::CreateSP(this, &FAnimationDatabaseBakeTask::GetProgressText)));
+	Info.bFireAndForget = false;
+	Info.bUseThrobber = true;
+	Info.ExpireDuration = 2.0f;
+	Info.ButtonDetails.Add(FNotificationButtonInfo(
+		LOCTEXT("CancelBake", "Cancel"),
+		LOCTEXT("CancelBakeToolTip", "Stop baking, the database keeps its current data"),
+		FSimpleDelegate::CreateSP(this, &FAnimationDatabaseBakeTask::Cancel),
+		SNotificationItem::CS_Pending));
+
+	Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(SNotificationItem::CS_Pending);
+	}
+
+	TSharedRef<FAnimationDatabaseBakeTask> Task = SharedThis(this);
+	BakeFuture = Async(EAsyncExecution::ThreadPool, [Task]()
+	{
+		ParallelFor(Task->BakedAnimations.Num(), [&Task](int32 Index)
+		{
+			if (Task->bCancelRequested)
+			{
+				return;
+			}
+
+			FAnimationDatabaseBakedAnimation& BakedAnimation = Task->BakedAnimations[Index];
+			UAnimationDatabase::BakeAnimation(Task->BakeSources[Index], BakedAnimation.AnimationIndex, Task->Bones, Task->MirrorTable, BakedAnimation);
+
+			// The copied tracks are not needed anymore
+			Task->BakeSources[Index] = FAnimationDatabaseBakeSource();
+
+			Task->NumBaked.Increment();
+		});
+	});
+
+	// The ticker keeps the task alive until it is finished, even after it was cancelled and replaced by another bake
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Task](float DeltaTime) { return Task->Tick(DeltaTime); }), AnimationDatabaseBakeTaskGlobals::PollInterval);
+}
+
+void FAnimationDatabaseBakeTask::Cancel()
+{
+	bCancelRequested = true;
+}
+
+bool FAnimationDatabaseBakeTask::Tick(float DeltaTime)
+{
+	if (!BakeFuture.IsReady())
+	{
+		return true;
+	}
+
+	TickerHandle.Reset();
+	Finish();
+
+	return false;
+}
+
+void FAnimationDatabaseBakeTask::Finish()
+{
+	// Keep this alive until the end of the function, removing it from the running tasks might release the last reference
+	TSharedRef<FAnimationDatabaseBakeTask> Task = SharedThis(this);
+
+	const TSharedPtr<FAnimationDatabaseBakeTask>* RunningTask = RunningTasks.Find(Database);
+	if (RunningTask && *RunningTask == Task)
+	{
+		RunningTasks.Remove(Database);
+	}
+
+	bool bApplied = false;
+	FText ResultText;
+
+	if (bCancelRequested)
+	{
+		ResultText = LOCTEXT("BakeCancelled", "Baking the animation database was cancelled");
+	}
+	else if (Database && Database->ApplyBakedAnimations(BakedAnimations))
+	{
+		bApplied = true;
+		ResultText = FText::Format(LOCTEXT("BakeFinished", "Baked {0} animations of {1}"), FText::AsNumber(BakedAnimations.Num()), FText::FromString(Database->GetName()));
+	}
+	else if (Database)
+	{
+		// The bake settings changed while baking, bake the animations that are still in the database again with the new settings
+		TArray<int32> AnimationIndices;
+		GetCurrentAnimationIndices(AnimationIndices);
+
+		if (AnimationIndices.Num() > 0)
+		{
+			Launch(Database, AnimationIndices);
+			ResultText = LOCTEXT("BakeRelaunched", "The bake settings changed while baking, baking again with the new settings");
+		}
+		else
+		{
+			ResultText = LOCTEXT("BakeDiscarded", "The baked animations were removed from the database while baking, the result was discarded");
+		}
+	}
+
+	if (Notification.IsValid())
+	{
+		Notification->SetText(ResultText);
+		Notification->SetCompletionState(bApplied ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+		Notification->ExpireAndFadeout();
+		Notification.Reset();
+	}
+
+	BakeFinished.Broadcast(Database, bApplied);
+}
+
+FText FAnimationDatabaseBakeTask::GetProgressText() const
+{
+	return FText::Format(LOCTEXT("BakeProgress", "Baking {0}: {1} / {2} animations"),
+		FText::FromString(GetNameSafe(Database)), FText::AsNumber(NumBaked.GetValue()), FText::AsNumber(BakedAnimations.Num()));
+}
+
+void FAnimationDatabaseBakeTask::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObject(Database);
+
+	for (FAnimationDatabaseBakedAnimation& BakedAnimation : BakedAnimations)
+	{
+		Collector.AddReferencedObject(BakedAnimation.Animation);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Async/Future.h"
+#include "UObject/GCObject.h"
+#include "AnimationDatabaseBaking.h"
+#include "MotionMatchingMirroring.h"
+
+class UAnimationDatabase;
+class SNotificationItem;
+
+/**
+ * Bakes animations of an animation database on the thread pool while the editor stays responsive.
+ * Progress is shown in a notification with a cancel button, the result is swapped into the asset on the game thread in one go.
+ */
+class FAnimationDatabaseBakeTask : public TSharedFromThis<FAnimationDatabaseBakeTask>, public FGCObject
+{
+public:
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnBakeFinished, UAnimationDatabase* /*Database*/, bool /*bApplied*/);
+
+	/** Starts baking the animations at the given indices, a bake that is still running for the same database is cancelled and its animations are baked as well */
+	static TSharedPtr<FAnimationDatabaseBakeTask> Launch(UAnimationDatabase* InDatabase, const TArray<int32>& InAnimationIndices);
+
+	/** Returns the bake that is running for the database, if any */
+	static TSharedPtr<FAnimationDatabaseBakeTask> Find(const UAnimationDatabase* InDatabase);
+
+	virtual ~FAnimationDatabaseBakeTask();
+
+	void Cancel();
+	bool IsCancelled() const { return bCancelRequested; }
+
+	FOnBakeFinished& OnFinished() { return BakeFinished; }
+
+	// FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	// End of FGCObject interface
+
+private:
+	FAnimationDatabaseBakeTask(UAnimationDatabase* InDatabase, const TArray<int32>& InAnimationIndices);
+
+	void Start();
+	bool Tick(float DeltaTime);
+	void Finish();
+
+	FText GetProgressText() const;
+
+	/** Adds the indices the baked animations have in the database now, animations that were removed are skipped */
+	void GetCurrentAnimationIndices(TArray<int32>& OutAnimationIndices) const;
+
+private:
+	UAnimationDatabase* Database;
+
+	/** One entry per animation, filled in by the workers */
+	TArray<FAnimationDatabaseBakedAnimation> BakedAnimations;
+
+	/** Copies of the source animations, taken on the game thread, one per baked animation */
+	TArray<FAnimationDatabaseBakeSource> BakeSources;
+
+	/** Copies of the settings, the asset is not touched until the bake is applied */
+	TArray<FName> Bones;
+	FMotionMirrorTable MirrorTable;
+
+	FThreadSafeBool bCancelRequested;
+	FThreadSafeCounter NumBaked;
+	TFuture<void> BakeFuture;
+
+	TSharedPtr<SNotificationItem> Notification;
+	FDelegateHandle TickerHandle;
+	FOnBakeFinished BakeFinished;
+
+	static TMap<const UAnimationDatabase*, TSharedPtr<FAnimationDatabaseBakeTask>> RunningTasks;
+};
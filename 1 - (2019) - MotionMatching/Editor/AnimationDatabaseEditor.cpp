@@ -23,6 +23,10 @@
 #include "Commands.h"
 #include "AnimationDatabase.h"
 #include "Animation/Skeleton.h"
+#include "Animation/AnimSequence.h"
+#include "AnimationDatabaseBakeTask.h"
+#include "SAnimationDatabaseStatisticsView.h"
+#include "Editor.h"
 
 
 #define LOCTEXT_NAMESPACE "MotionFieldEditor"
@@ -30,6 +34,7 @@
 const FName FAnimationDatabaseEditor::ToolkitFName(TEXT("AnimationDatabaseEditor"));
 const FName FAnimationDatabaseEditor::PropertiesTabId(TEXT("AnimationDatabaseEditor_Properties"));
 const FName FAnimationDatabaseEditor::AnimationContextTabId(TEXT("AnimationDatabaseEditor_AnimationContext"));
+const FName FAnimationDatabaseEditor::StatisticsTabId(TEXT("AnimationDatabaseEditor_Statistics"));
 const FName FAnimationDatabaseEditor::AnimationDatabaseEditorAppIdentifier(TEXT("AnimationDatabaseEditorApp"));
 
 FAnimationDatabaseEditor::~FAnimationDatabaseEditor()
@@ -55,6 +60,11 @@ void FAnimationDatabaseEditor::RegisterTabSpawners(const TSharedRef<class FTabMa
 		.SetDisplayName(LOCTEXT("AnimationContextTab", "Animations"))
 		.SetGroup(WorkspaceMenuCategory.ToSharedRef())
 		.SetIcon(FSlateIcon(FEditorStyle::GetStyleSetName(), "LevelEditor.Tabs.Details"));
+
+	InTabManager->RegisterTabSpawner(StatisticsTabId, FOnSpawnTab::CreateSP(this, &FAnimationDatabaseEditor::SpawnStatisticsTab))
+		.SetDisplayName(LOCTEXT("StatisticsTab", "Search Statistics"))
+		.SetGroup(WorkspaceMenuCategory.ToSharedRef())
+		.SetIcon(FSlateIcon(FEditorStyle::GetStyleSetName(), "LevelEditor.Tabs.StatsViewer"));
 }
 
 void FAnimationDatabaseEditor::UnregisterTabSpawners(const TSharedRef<class FTabManager>& InTabManager)
@@ -63,6 +73,7 @@ void FAnimationDatabaseEditor::UnregisterTabSpawners(const TSharedRef<class FTab
 	
 	InTabManager->UnregisterTabSpawner(PropertiesTabId);
 	InTabManager->UnregisterTabSpawner(AnimationContextTabId);
+	InTabManager->UnregisterTabSpawner(StatisticsTabId);
 }
 
 void FAnimationDatabaseEditor::InitAnimationDatabaseEditor(const EToolkitMode::Type InMode, const TSharedPtr<IToolkitHost>& InToolkistHost, UAnimationDatabase* InAnimationDatabase)
@@ -72,6 +83,9 @@ void FAnimationDatabaseEditor::InitAnimationDatabaseEditor(const EToolkitMode::T
 	const bool bIsLockable = false;
 
 	SetAnimationDatabase(InAnimationDatabase);
+
+	// Reimported source animations are rebaked by the watcher the module created, this editor only has to refresh its views afterwards
+	FEditorDelegates::OnAssetPostImport.AddSP(this, &FAnimationDatabaseEditor::HandleAssetPostImport);
 	
 	FPropertyEditorModule& PropertyEditorModule = FModuleManager::GetModuleChecked<FPropertyEditorModule>("PropertyEditor");
 	
@@ -82,7 +96,7 @@ void FAnimationDatabaseEditor::InitAnimationDatabaseEditor(const EToolkitMode::T
 	const FDetailsViewArgs DetailViewArgs(bIsUpdatable, bIsLockable, true, FDetailsViewArgs::ObjectsUseNameArea, false);
 	DetailsView = PropertyEditorModule.CreateDetailView(DetailViewArgs);
 
-	const TSharedRef<FTabManager::FLayout> StandaloneDefaultLayout = FTabManager::NewLayout("Standalone_AnimationDatabaseEditor_Layout_v1")
+	const TSharedRef<FTabManager::FLayout> StandaloneDefaultLayout = FTabManager::NewLayout("Standalone_AnimationDatabaseEditor_Layout_v2")
 	->AddArea
 	(
 		FTabManager::NewPrimaryArea()
@@ -110,6 +124,8 @@ void FAnimationDatabaseEditor::InitAnimationDatabaseEditor(const EToolkitMode::T
 				FTabManager::NewStack()
 				->SetSizeCoefficient(0.7f)
 				->AddTab(AnimationContextTabId, ETabState::OpenedTab)
+				->AddTab(StatisticsTabId, ETabState::OpenedTab)
+				->SetForegroundTab(AnimationContextTabId)
 			)
 		)
 	);
@@ -158,19 +174,52 @@ FLinearColor FAnimationDatabaseEditor::GetWorldCentricTabColorScale() const
 
 void FAnimationDatabaseEditor::OnProcessAllClicked()
 {
-	FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("OnProcessAll", "On Process All still needs to be implemented"));
+	TArray<int32> AnimationIndices;
+	for (int32 AnimationIndex = 0; AnimationIndex < GetSourceAnimations().Num(); ++AnimationIndex)
+	{
+		AnimationIndices.Add(AnimationIndex);
+	}
+
+	LaunchBake(AnimationIndices);
 }
 
 void FAnimationDatabaseEditor::OnClearAllClicked()
 {
+	// Otherwise the bake would put the frames right back when it finishes
+	if (TSharedPtr<FAnimationDatabaseBakeTask> BakeTask = FAnimationDatabaseBakeTask::Find(GetAnimationDatabase()))
+	{
+		BakeTask->Cancel();
+	}
+
 	GetAnimationDatabase()->ClearAllFrameData();
 	AnimationContextView->RepopulateAnimationView();
 }
 
 void FAnimationDatabaseEditor::AddSourceAnimations(TArray<UAnimSequence*> InAnimations)
 {
-	GetAnimationDatabase()->AddSourceAnimations(InAnimations);
+	// Add the animations right away, their frames are baked in the background
+	TArray<int32> AnimationIndices;
+	GetAnimationDatabase()->AppendSourceAnimations(InAnimations, AnimationIndices);
 	AnimationContextView->RepopulateAnimationView();
+
+	LaunchBake(AnimationIndices);
+}
+
+void FAnimationDatabaseEditor::LaunchBake(const TArray<int32>& InAnimationIndices)
+{
+	TSharedPtr<FAnimationDatabaseBakeTask> BakeTask = FAnimationDatabaseBakeTask::Launch(GetAnimationDatabase(), InAnimationIndices);
+	if (BakeTask.IsValid())
+	{
+		BakeTask->OnFinished().AddSP(this, &FAnimationDatabaseEditor::OnBakeFinished);
+	}
+}
+
+void FAnimationDatabaseEditor::OnBakeFinished(UAnimationDatabase* InDatabase, bool bApplied)
+{
+	if (bApplied && AnimationContextView.IsValid())
+	{
+		AnimationContextView->RepopulateAnimationView();
+	}
 }
 
 void FAnimationDatabaseEditor::RemoveSourceAnimationAtIndex(const int InAnimationIndex)
@@ -256,13 +305,34 @@ TSharedRef<SDockTab> FAnimationDatabaseEditor::SpawnAnimationContextTab(const FS
 		];
 }
 
+TSharedRef<SDockTab> FAnimationDatabaseEditor::SpawnStatisticsTab(const FSpawnTabArgs& Args)
+{
+	check(Args.GetTabId() == StatisticsTabId);
+
+	TSharedPtr<FAnimationDatabaseEditor> AnimationDatabaseEditorPtr = SharedThis(this);
+
+	return SNew(SDockTab)
+		.Icon(FEditorStyle::GetBrush("LevelEditor.Tabs.StatsViewer"))
+		.Label(LOCTEXT("StatisticsTitle", "Search Statistics"))
+		.TabColorScale(GetTabColorScale())
+		[
+			SNew(SAnimationDatabaseStatisticsView, AnimationDatabaseEditorPtr)
+		];
+}
+
 void FAnimationDatabaseEditor::HandleAssetPostImport(class UFactory* InFactory, UObject* InObject)
 {
-	//if (EditingObjects.Contains(InObject))
-	//{
-	//	// The details panel likely needs to be refreshed if an asset was imported again
-	//	DetailsView->SetObjects(EditingObjects);
-	//}
+	UAnimSequence* Animation = Cast<UAnimSequence>(InObject);
+	if (!Animation || !GetSourceAnimations().Contains(Animation))
+	{
+		return;
+	}
+
+	// The details panel likely needs to be refreshed if an asset was imported again
+	if (DetailsView.IsValid())
+	{
+		DetailsView->SetObject(GetAnimationDatabase(), true);
+	}
 }
 
 void FAnimationDatabaseEditor::PopulateToolbar()
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationDatabaseReimportWatcher.h"
+
+#include "AnimationDatabase.h"
+#include "AnimationDatabaseBakeTask.h"
+#include "Animation/AnimSequence.h"
+#include "Containers/Ticker.h"
+#include "Editor.h"
+#include "UObject/UObjectIterator.h"
+
+
+namespace AnimationDatabaseReimportWatcherGlobals
+{
+	// Seconds without a new reimport before the queued animations are rebaked
+	const double DebounceDelay = 1.0;
+
+	const float PollInterval = 0.25f;
+}
+
+
+FAnimationDatabaseReimportWatcher* FAnimationDatabaseReimportWatcher::Instance = nullptr;
+
+
+void FAnimationDatabaseReimportWatcher::Initialize()
+{
+	if (!Instance)
+	{
+		Instance = new FAnimationDatabaseReimportWatcher();
+	}
+}
+
+void FAnimationDatabaseReimportWatcher::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+FAnimationDatabaseReimportWatcher& FAnimationDatabaseReimportWatcher::Get()
+{
+	check(Instance);
+	return *Instance;
+}
+
+FAnimationDatabaseReimportWatcher::FAnimationDatabaseReimportWatcher()
+	: LastQueueTime(0.0)
+{
+	FEditorDelegates::OnAssetPostImport.AddRaw(this, &FAnimationDatabaseReimportWatcher::HandleAssetPostImport);
+}
+
+FAnimationDatabaseReimportWatcher::~FAnimationDatabaseReimportWatcher()
+{
+	FEditorDelegates::OnAssetPostImport.RemoveAll(this);
+
+	if (TickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+}
+
+void FAnimationDatabaseReimportWatcher::HandleAssetPostImport(UFactory* InFactory, UObject* InObject)
+{
+	if (UAnimSequence* Animation = Cast<UAnimSequence>(InObject))
+	{
+		QueueAnimation(Animation);
+	}
+}
+
+void FAnimationDatabaseReimportWatcher::QueueAnimation(UAnimSequence* InAnimation)
+{
+	if (!InAnimation)
+	{
+		return;
+	}
+
+	QueuedAnimations.Add(InAnimation);
+	LastQueueTime = FPlatformTime::Seconds();
+
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAnimationDatabaseReimportWatcher::Tick), AnimationDatabaseReimportWatcherGlobals::PollInterval);
+	}
+}
+
+bool FAnimationDatabaseReimportWatcher::Tick(float DeltaTime)
+{
+	if (FPlatformTime::Seconds() - LastQueueTime < AnimationDatabaseReimportWatcherGlobals::DebounceDelay)
+	{
+		return true;
+	}
+
+	RebakeQueuedAnimations();
+
+	TickerHandle.Reset();
+	return false;
+}
+
+void FAnimationDatabaseReimportWatcher::RebakeQueuedAnimations()
+{
+	for (TObjectIterator<UAnimationDatabase> It; It; ++It)
+	{
+		UAnimationDatabase* Database = *It;
+		if (Database->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || Database->IsPendingKill())
+		{
+			continue;
+		}
+
+		// Only the reimported animations are rebaked, the rest of the database keeps its frames
+		const TArray<UAnimSequence*> SourceAnimations = Database->GetSourceAnimations();
+
+		TArray<int32> AnimationIndices;
+		for (int32 AnimationIndex = 0; AnimationIndex < SourceAnimations.Num(); ++AnimationIndex)
+		{
+			if (QueuedAnimations.Contains(SourceAnimations[AnimationIndex]))
+			{
+				AnimationIndices.Add(AnimationIndex);
+			}
+		}
+
+		if (AnimationIndices.Num() > 0)
+		{
+			FAnimationDatabaseBakeTask::Launch(Database, AnimationIndices);
+		}
+	}
+
+	QueuedAnimations.Empty();
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UAnimSequence;
+class UFactory;
+
+/**
+ * Rebakes the animations of every loaded animation database when they are reimported.
+ * Reimports are collected for a short while first, so reimporting a batch of animations only starts one bake per database.
+ * The editor module creates the watcher in StartupModule and destroys it in ShutdownModule, while the ticker and the editor delegates still exist.
+ */
+class FAnimationDatabaseReimportWatcher
+{
+public:
+	static void Initialize();
+	static void Shutdown();
+
+	/** Only valid between Initialize and Shutdown */
+	static FAnimationDatabaseReimportWatcher& Get();
+
+	~FAnimationDatabaseReimportWatcher();
+
+	/** Queues the animation, every database that uses it is rebaked once no other animation was queued for the debounce delay */
+	void QueueAnimation(UAnimSequence* InAnimation);
+
+private:
+	FAnimationDatabaseReimportWatcher();
+
+	void HandleAssetPostImport(UFactory* InFactory, UObject* InObject);
+
+	bool Tick(float DeltaTime);
+
+	/** Starts a bake of the queued animations for every database that uses them */
+	void RebakeQueuedAnimations();
+
+private:
+	TSet<TWeakObjectPtr<UAnimSequence>> QueuedAnimations;
+	double LastQueueTime;
+
+	FDelegateHandle TickerHandle;
+
+	static FAnimationDatabaseReimportWatcher* Instance;
+};
@@ -0,0 +1,12 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingEditorSettings.h"
+
+
+UMotionMatchingEditorSettings::UMotionMatchingEditorSettings()
+	: MaxFeatureDimension(64)
+	, MaxSearchTime(500.0f)
+	, ProjectedAnimationLength(600.0f)
+	, NanosecondsPerFeature(0.25f)
+{
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "MotionMatchingEditorSettings.generated.h"
+
+/**
+ * Project wide budgets for animation databases, the create dialog warns when a bone selection does not fit them.
+ * The projected search time is an estimate, calibrate NanosecondsPerFeature with the search statistics tab of a representative database.
+ */
+UCLASS(config = Editor, defaultconfig, meta = (DisplayName = "Motion Matching"))
+class UMotionMatchingEditorSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UMotionMatchingEditorSettings();
+
+	/** Highest amount of floats per frame a database should search */
+	UPROPERTY(config, EditAnywhere, Category = "Budget", meta = (ClampMin = 1))
+	int32 MaxFeatureDimension;
+
+	/** Highest time a single search of a database with ProjectedAnimationLength of animation should take, in microseconds */
+	UPROPERTY(config, EditAnywhere, Category = "Budget", meta = (ClampMin = 0.0f))
+	float MaxSearchTime;
+
+	/** Length of animation in seconds a database is expected to hold, used to project the search time */
+	UPROPERTY(config, EditAnywhere, Category = "Projection", meta = (ClampMin = 1.0f))
+	float ProjectedAnimationLength;
+
+	/** Time the search spends per float of the search matrix, in nanoseconds */
+	UPROPERTY(config, EditAnywhere, Category = "Projection", meta = (ClampMin = 0.0f))
+	float NanosecondsPerFeature;
+
+	// UDeveloperSettings interface
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+	// End of UDeveloperSettings interface
+};
@@ -0,0 +1,453 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SAnimationDatabaseStatisticsView.h"
+
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SScrollBox.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSpinBox.h"
+#include "Widgets/Colors/SColorBlock.h"
+#include "EditorStyleSet.h"
+
+#include "AnimationDatabase.h"
+#include "AnimationDatabaseEditor.h"
+
+
+#define LOCTEXT_NAMESPACE "AnimationDatabaseStatisticsView"
+
+namespace AnimationDatabaseStatisticsViewGlobals
+{
+	const int32 NumHistogramBins = 32;
+	const float HistogramHeight = 120.0f;
+
+	const int32 DefaultNumBenchmarkQueries = 256;
+	const int32 MaxNumBenchmarkQueries = 16384;
+
+	/** Names the feature a dimension of the layout belongs to, so a histogram can be read without knowing the layout */
+	FText GetDimensionName(const FMotionFeatureLayout& InLayout, const TArray<FName>& InBones, const int32 InDimension)
+	{
+		static const TCHAR* AxisNames[] = { TEXT("X"), TEXT("Y"), TEXT("Z") };
+
+		if (InDimension < InLayout.GetBoneOffset(0))
+		{
+			return FText::Format(LOCTEXT("VelocityDimension", "Velocity {0}"), FText::FromString(AxisNames[InDimension % 3]));
+		}
+
+		if (InDimension < InLayout.GetTrajectoryOffset())
+		{
+			const int32 BoneIndex = (InDimension - InLayout.GetBoneOffset(0)) / FMotionFeatureLayout::BoneDimension;
+			const int32 BoneDimension = (InDimension - InLayout.GetBoneOffset(0)) % FMotionFeatureLayout::BoneDimension;
+			const FText BoneName = InBones.IsValidIndex(BoneIndex) ? FText::FromName(InBones[BoneIndex]) : FText::AsNumber(BoneIndex);
+
+			return FText::Format(BoneDimension < 3 ? LOCTEXT("BonePositionDimension", "{0} Position {1}") : LOCTEXT("BoneVelocityDimension", "{0} Velocity {1}"),
+				BoneName, FText::FromString(AxisNames[BoneDimension % 3]));
+		}
+
+		const int32 PointIndex = (InDimension - InLayout.GetTrajectoryOffset()) / FMotionFeatureLayout::TrajectoryPointDimension;
+		const int32 PointDimension = (InDimension - InLayout.GetTrajectoryOffset()) % FMotionFeatureLayout::TrajectoryPointDimension;
+
+		return FText::Format(LOCTEXT("TrajectoryDimension", "Trajectory Point {0} {1}"), FText::AsNumber(PointIndex), FText::FromString(AxisNames[PointDimension]));
+	}
+}
+
+
+void SAnimationDatabaseStatisticsView::Construct(const FArguments& InArgs, TSharedPtr<FAnimationDatabaseEditor> InAnimationDatabaseEditor)
+{
+	AnimationDatabaseEditor = InAnimationDatabaseEditor;
+
+	SelectedDimension = 0;
+	NumBenchmarkQueries = AnimationDatabaseStatisticsViewGlobals::DefaultNumBenchmarkQueries;
+	DistributionVersion = 0;
+	bHasDistribution = false;
+	bHasBenchmarkResult = false;
+
+	ChildSlot
+	[
+		SNew(SScrollBox)
+		+ SScrollBox::Slot()
+		.Padding(4.0f)
+		[
+			SNew(SVerticalBox)
+			// Summary of the search matrix
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0.0f, 0.0f, 0.0f, 8.0f)
+			[
+				SNew(SBorder)
+				.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+				.Padding(4.0f)
+				[
+					SNew(STextBlock)
+					.Text(this, &SAnimationDatabaseStatisticsView::GetSummaryText)
+				]
+			]
+			// Transition graph
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0.0f, 0.0f, 0.0f, 8.0f)
+			[
+				SNew(SBorder)
+				.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+				.Padding(4.0f)
+				[
+					SNew(STextBlock)
+					.Text(this, &SAnimationDatabaseStatisticsView::GetTransitionGraphText)
+				]
+			]
+			// Feature distribution
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(0.0f, 0.0f, 0.0f, 8.0f)
+			[
+				SNew(SBorder)
+				.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+				.Padding(4.0f)
+				[
+					SNew(SVerticalBox)
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					[
+						SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						.VAlign(VAlign_Center)
+						.Padding(0.0f, 0.0f, 8.0f, 0.0f)
+						[
+							SNew(STextBlock)
+							.Text(LOCTEXT("FeatureDimension", "Feature Dimension"))
+						]
+						+ SHorizontalBox::Slot()
+						.FillWidth(1.0f)
+						[
+							SNew(SSpinBox<int32>)
+							.MinValue(0)
+							.MaxValue(this, &SAnimationDatabaseStatisticsView::GetMaxDimension)
+							.Value(this, &SAnimationDatabaseStatisticsView::GetSelectedDimension)
+							.OnValueChanged(this, &SAnimationDatabaseStatisticsView::OnSelectedDimensionChanged)
+						]
+					]
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					.Padding(0.0f, 4.0f)
+					[
+						SNew(STextBlock)
+						.Text(this, &SAnimationDatabaseStatisticsView::GetDistributionText)
+					]
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					[
+						SNew(SBox)
+						.HeightOverride(AnimationDatabaseStatisticsViewGlobals::HistogramHeight)
+						[
+							SAssignNew(HistogramContainer, SHorizontalBox)
+						]
+					]
+				]
+			]
+			// Benchmark
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			[
+				SNew(SBorder)
+				.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+				.Padding(4.0f)
+				[
+					SNew(SVerticalBox)
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					[
+						SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						.VAlign(VAlign_Center)
+						.Padding(0.0f, 0.0f, 8.0f, 0.0f)
+						[
+							SNew(STextBlock)
+							.Text(LOCTEXT("BenchmarkQueries", "Queries"))
+						]
+						+ SHorizontalBox::Slot()
+						.FillWidth(1.0f)
+						[
+							SNew(SSpinBox<int32>)
+							.MinValue(1)
+							.MaxValue(AnimationDatabaseStatisticsViewGlobals::MaxNumBenchmarkQueries)
+							.Value(this, &SAnimationDatabaseStatisticsView::GetNumBenchmarkQueries)
+							.OnValueChanged(this, &SAnimationDatabaseStatisticsView::OnNumBenchmarkQueriesChanged)
+						]
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(8.0f, 0.0f, 0.0f, 0.0f)
+						[
+							SNew(SButton)
+							.Text(LOCTEXT("RunBenchmark", "Run Benchmark"))
+							.ToolTipText(LOCTEXT("RunBenchmarkToolTip", "Searches the current snapshot with queries taken from its own frames, with and without pruning"))
+							.IsEnabled(this, &SAnimationDatabaseStatisticsView::CanRunBenchmark)
+							.OnClicked(this, &SAnimationDatabaseStatisticsView::OnRunBenchmarkClicked)
+						]
+					]
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					.Padding(0.0f, 4.0f)
+					[
+						SNew(STextBlock)
+						.Text(this, &SAnimationDatabaseStatisticsView::GetBenchmarkText)
+					]
+				]
+			]
+		]
+	];
+}
+
+void SAnimationDatabaseStatisticsView::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+
+	// A rebake publishes a new snapshot, everything that was computed for the old one is stale
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	const uint32 SnapshotVersion = Snapshot.IsValid() ? Snapshot->GetVersion() : 0;
+
+	if (!bHasDistribution || SnapshotVersion != DistributionVersion)
+	{
+		bHasBenchmarkResult = false;
+		RefreshDistribution();
+		RefreshTransitionGraphStats();
+	}
+}
+
+FMotionDatabaseSnapshotPtr SAnimationDatabaseStatisticsView::GetSnapshot() const
+{
+	TSharedPtr<FAnimationDatabaseEditor> Editor = AnimationDatabaseEditor.Pin();
+	UAnimationDatabase* AnimationDatabase = Editor.IsValid() ? Editor->GetAnimationDatabase() : nullptr;
+
+	return AnimationDatabase ? AnimationDatabase->GetRuntimeSnapshot() : nullptr;
+}
+
+FText SAnimationDatabaseStatisticsView::GetSummaryText() const
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	if (!Snapshot.IsValid() || Snapshot->Num() == 0)
+	{
+		return LOCTEXT("NoSnapshot", "The database has no baked frames, process the source animations first.");
+	}
+
+	const FMotionFeatureLayout& Layout = Snapshot->GetLayout();
+
+	TArray<FString> ShardNames;
+	for (const FName& ShardName : Snapshot->GetResidentShards())
+	{
+		ShardNames.Add(ShardName.IsNone() ? TEXT("Base") : ShardName.ToString());
+	}
+
+	FFormatNamedArguments Args;
+	Args.Add(TEXT("NumFrames"), FText::AsNumber(Snapshot->Num()));
+	Args.Add(TEXT("NumAnimations"), FText::AsNumber(Snapshot->GetNumAnimations()));
+	Args.Add(TEXT("Dimension"), FText::AsNumber(Layout.GetDimension()));
+	Args.Add(TEXT("Stride"), FText::AsNumber(Layout.GetStride()));
+	Args.Add(TEXT("NumBones"), FText::AsNumber(Layout.NumBones));
+	Args.Add(TEXT("NumTrajectoryPoints"), FText::AsNumber(Layout.NumTrajectoryPoints));
+	Args.Add(TEXT("MatrixSize"), FText::AsMemory(Snapshot->Num() * Layout.GetStride() * sizeof(float)));
+	Args.Add(TEXT("PayloadSize"), FText::AsMemory(Snapshot->GetPayload().Num()));
+	Args.Add(TEXT("Shards"), FText::FromString(FString::Join(ShardNames, TEXT(", "))));
+
+	return FText::Format(LOCTEXT("SnapshotSummary",
+		"Frames: {NumFrames} from {NumAnimations} animations\n"
+		"Dimension: {Dimension} (stride {Stride}), {NumBones} bones, {NumTrajectoryPoints} trajectory points\n"
+		"Search matrix: {MatrixSize}, payload: {PayloadSize}\n"
+		"Resident shards: {Shards}"), Args);
+}
+
+FText SAnimationDatabaseStatisticsView::GetDistributionText() const
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	if (!bHasDistribution || !Snapshot.IsValid() || Snapshot->Num() == 0)
+	{
+		return FText::GetEmpty();
+	}
+
+	FNumberFormattingOptions Options;
+	Options.MinimumFractionalDigits = 2;
+	Options.MaximumFractionalDigits = 2;
+
+	return FText::Format(LOCTEXT("DistributionSummary", "{0}: min {1}, max {2}, mean {3}, standard deviation {4}"),
+		AnimationDatabaseStatisticsViewGlobals::GetDimensionName(Snapshot->GetLayout(), Snapshot->GetBones(), SelectedDimension),
+		FText::AsNumber(Distribution.Min, &Options),
+		FText::AsNumber(Distribution.Max, &Options),
+		FText::AsNumber(Distribution.Mean, &Options),
+		FText::AsNumber(Distribution.StandardDeviation, &Options));
+}
+
+FText SAnimationDatabaseStatisticsView::GetBenchmarkText() const
+{
+	if (!bHasBenchmarkResult)
+	{
+		return LOCTEXT("NoBenchmark", "Run the benchmark to measure the search of the current snapshot.");
+	}
+
+	FNumberFormattingOptions Options;
+	Options.MaximumFractionalDigits = 1;
+
+	const double Speedup = BenchmarkResult.AcceleratedNanoseconds > 0.0 ? BenchmarkResult.BruteForceNanoseconds / BenchmarkResult.AcceleratedNanoseconds : 0.0;
+
+	FText Summary = FText::Format(LOCTEXT("BenchmarkSummary",
+		"{0} queries\n"
+		"Brute force: {1} us per query\n"
+		"Pruned search: {2} us per query ({3}x)\n"
+		"Same best cost: {4}"),
+		FText::AsNumber(BenchmarkResult.NumQueries),
+		FText::AsNumber(BenchmarkResult.BruteForceNanoseconds / 1000.0, &Options),
+		FText::AsNumber(BenchmarkResult.AcceleratedNanoseconds / 1000.0, &Options),
+		FText::AsNumber(Speedup, &Options),
+		FText::AsPercent(BenchmarkResult.Agreement));
+
+	// Recall against speed of the approximate search, one line per rerank depth
+	for (const FMotionMatchingApproximateResult& Approximate : BenchmarkResult.Approximate)
+	{
+		const double ApproximateSpeedup = Approximate.Nanoseconds > 0.0 ? BenchmarkResult.BruteForceNanoseconds / Approximate.Nanoseconds : 0.0;
+
+		Summary = FText::Format(LOCTEXT("BenchmarkApproximate", "{0}\nApproximate, {1} reranked: {2} us per query ({3}x), recall {4}"),
+			Summary,
+			FText::AsNumber(Approximate.NumRerankCandidates),
+			FText::AsNumber(Approximate.Nanoseconds / 1000.0, &Options),
+			FText::AsNumber(ApproximateSpeedup, &Options),
+			FText::AsPercent(Approximate.Recall));
+	}
+
+	return Summary;
+}
+
+void SAnimationDatabaseStatisticsView::OnSelectedDimensionChanged(int32 InDimension)
+{
+	if (SelectedDimension != InDimension)
+	{
+		SelectedDimension = InDimension;
+		RefreshDistribution();
+	}
+}
+
+TOptional<int32> SAnimationDatabaseStatisticsView::GetMaxDimension() const
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	return Snapshot.IsValid() ? FMath::Max(0, Snapshot->GetLayout().GetDimension() - 1) : 0;
+}
+
+FReply SAnimationDatabaseStatisticsView::OnRunBenchmarkClicked()
+{
+	if (const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot())
+	{
+		FMotionMatchingBenchmark::Run(*Snapshot, NumBenchmarkQueries, BenchmarkResult);
+		bHasBenchmarkResult = true;
+	}
+
+	return FReply::Handled();
+}
+
+bool SAnimationDatabaseStatisticsView::CanRunBenchmark() const
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	return Snapshot.IsValid() && Snapshot->Num() > 0;
+}
+
+void SAnimationDatabaseStatisticsView::RefreshDistribution()
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+
+	DistributionVersion = Snapshot.IsValid() ? Snapshot->GetVersion() : 0;
+	bHasDistribution = true;
+	Distribution = FMotionFeatureDistribution();
+
+	if (Snapshot.IsValid())
+	{
+		SelectedDimension = FMath::Clamp(SelectedDimension, 0, FMath::Max(0, Snapshot->GetLayout().GetDimension() - 1));
+		FMotionMatchingBenchmark::ComputeFeatureDistribution(*Snapshot, SelectedDimension, AnimationDatabaseStatisticsViewGlobals::NumHistogramBins, Distribution);
+	}
+
+	HistogramContainer->ClearChildren();
+
+	int32 MaxCount = 0;
+	for (const int32 Count : Distribution.Histogram)
+	{
+		MaxCount = FMath::Max(MaxCount, Count);
+	}
+
+	const float BinWidth = (Distribution.Max - Distribution.Min) / FMath::Max(1, Distribution.Histogram.Num());
+
+	for (int32 Bin = 0; Bin < Distribution.Histogram.Num(); ++Bin)
+	{
+		const float Fraction = MaxCount > 0 ? (float)Distribution.Histogram[Bin] / MaxCount : 0.0f;
+		const float BinStart = Distribution.Min + Bin * BinWidth;
+
+		HistogramContainer->AddSlot()
+		.FillWidth(1.0f)
+		.VAlign(VAlign_Bottom)
+		.Padding(1.0f, 0.0f)
+		[
+			SNew(SBox)
+			.HeightOverride(FMath::Max(1.0f, Fraction * AnimationDatabaseStatisticsViewGlobals::HistogramHeight))
+			.ToolTipText(FText::Format(LOCTEXT("HistogramBinToolTip", "[{0}, {1}): {2} frames"),
+				FText::AsNumber(BinStart), FText::AsNumber(BinStart + BinWidth), FText::AsNumber(Distribution.Histogram[Bin])))
+			[
+				SNew(SColorBlock)
+				.Color(FLinearColor(0.1f, 0.4f, 0.8f))
+			]
+		];
+	}
+}
+
+void SAnimationDatabaseStatisticsView::RefreshTransitionGraphStats()
+{
+	const FMotionDatabaseSnapshotPtr Snapshot = GetSnapshot();
+	if (!Snapshot.IsValid() || !Snapshot->HasTransitionGraph())
+	{
+		TransitionGraphText = LOCTEXT("NoTransitionGraph", "Transition graph: not built, every search scans all frames.");
+		return;
+	}
+
+	const int32 NumSegments = Snapshot->GetNumSegments();
+	const int32 TransitionsPerSegment = Snapshot->GetTransitionsPerSegment();
+
+	// The transitions of a segment are padded with INDEX_NONE when there are not enough good targets
+	int64 NumTransitions = 0;
+	int32 MinTransitions = TransitionsPerSegment;
+	int32 MaxTransitions = 0;
+
+	for (int32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+	{
+		int32 NumSegmentTransitions = 0;
+		for (const int32 TargetFrame : Snapshot->GetSegmentTransitions(SegmentIndex))
+		{
+			NumSegmentTransitions += (TargetFrame != INDEX_NONE) ? 1 : 0;
+		}
+
+		NumTransitions += NumSegmentTransitions;
+		MinTransitions = FMath::Min(MinTransitions, NumSegmentTransitions);
+		MaxTransitions = FMath::Max(MaxTransitions, NumSegmentTransitions);
+	}
+
+	FNumberFormattingOptions Options;
+	Options.MaximumFractionalDigits = 1;
+
+	// The segment of every frame and the padded transitions of every segment, see FMotionTransitionGraph::Build
+	const uint64 FrameSegmentsSize = (uint64)Snapshot->Num() * sizeof(int32);
+	const uint64 TransitionsSize = (uint64)NumSegments * TransitionsPerSegment * sizeof(int32);
+
+	FFormatNamedArguments Args;
+	Args.Add(TEXT("NumSegments"), FText::AsNumber(NumSegments));
+	Args.Add(TEXT("FramesPerSegment"), FText::AsNumber((float)Snapshot->Num() / NumSegments, &Options));
+	Args.Add(TEXT("TransitionsPerSegment"), FText::AsNumber(TransitionsPerSegment));
+	Args.Add(TEXT("AverageTransitions"), FText::AsNumber((float)NumTransitions / NumSegments, &Options));
+	Args.Add(TEXT("MinTransitions"), FText::AsNumber(MinTransitions));
+	Args.Add(TEXT("MaxTransitions"), FText::AsNumber(MaxTransitions));
+	Args.Add(TEXT("GraphSize"), FText::AsMemory(FrameSegmentsSize + TransitionsSize));
+	Args.Add(TEXT("FrameSegmentsSize"), FText::AsMemory(FrameSegmentsSize));
+	Args.Add(TEXT("TransitionsSize"), FText::AsMemory(TransitionsSize));
+
+	TransitionGraphText = FText::Format(LOCTEXT("TransitionGraphSummary",
+		"Transition graph: {NumSegments} segments, {FramesPerSegment} frames per segment\n"
+		"Transitions per segment: {AverageTransitions} of {TransitionsPerSegment} used on average (min {MinTransitions}, max {MaxTransitions})\n"
+		"Graph memory: {GraphSize} ({FrameSegmentsSize} frame segments, {TransitionsSize} transitions)"), Args);
+}
+
+#undef LOCTEXT_NAMESPACE
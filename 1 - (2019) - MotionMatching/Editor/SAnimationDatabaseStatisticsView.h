@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingBenchmark.h"
+
+class FAnimationDatabaseEditor;
+class SHorizontalBox;
+
+/**
+ * Shows what the search of the edited database works with: the size of the search matrix, the shape of the transition graph,
+ * the distribution of a single feature dimension, and the timings of a benchmark run against the current snapshot.
+ */
+class SAnimationDatabaseStatisticsView : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SAnimationDatabaseStatisticsView) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, TSharedPtr<FAnimationDatabaseEditor> InAnimationDatabaseEditor);
+
+	// SWidget interface
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	// End of SWidget interface
+
+private:
+	FMotionDatabaseSnapshotPtr GetSnapshot() const;
+
+	FText GetSummaryText() const;
+	FText GetTransitionGraphText() const { return TransitionGraphText; }
+	FText GetDistributionText() const;
+	FText GetBenchmarkText() const;
+
+	int32 GetSelectedDimension() const { return SelectedDimension; }
+	void OnSelectedDimensionChanged(int32 InDimension);
+	TOptional<int32> GetMaxDimension() const;
+
+	int32 GetNumBenchmarkQueries() const { return NumBenchmarkQueries; }
+	void OnNumBenchmarkQueriesChanged(int32 InNumQueries) { NumBenchmarkQueries = InNumQueries; }
+
+	FReply OnRunBenchmarkClicked();
+	bool CanRunBenchmark() const;
+
+	/** Recomputes the distribution of the selected dimension and rebuilds the histogram bars */
+	void RefreshDistribution();
+
+	/** Counts the transitions of every segment, too slow to do every time the text is painted */
+	void RefreshTransitionGraphStats();
+
+private:
+	TWeakPtr<FAnimationDatabaseEditor> AnimationDatabaseEditor;
+
+	TSharedPtr<SHorizontalBox> HistogramContainer;
+
+	int32 SelectedDimension;
+	int32 NumBenchmarkQueries;
+
+	FMotionFeatureDistribution Distribution;
+	FText TransitionGraphText;
+
+	/** Version of the snapshot the distribution was computed for, the benchmark result is dropped when the snapshot changes */
+	uint32 DistributionVersion;
+	bool bHasDistribution;
+
+	FMotionMatchingBenchmarkResult BenchmarkResult;
+	bool bHasBenchmarkResult;
+};
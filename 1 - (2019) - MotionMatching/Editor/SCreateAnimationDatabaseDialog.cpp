@@ -10,6 +10,7 @@
 #include "Widgets/Layout/SUniformGridPanel.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
 
 #include "AnimationDatabaseFactory.h"
 #include "AssetData.h"
@@ -20,9 +21,56 @@
 #include "Slate/SBonePickerItem.h"
 #include "Misc/MessageDialog.h"
 
+#include "AnimationDatabase.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingUtilities.h"
+#include "MotionMatchingEditorSettings.h"
+
 
 #define LOCTEXT_NAMESPACE "CreateAnimationDatabaseDialog"
 
+namespace CreateAnimationDatabaseDialogGlobals
+{
+	/** What a database baked with a bone selection is going to cost, before any animation was added */
+	struct FBoneSelectionEstimate
+	{
+		FBoneSelectionEstimate(const int32 InNumBones, const bool bInBakeMirroredFrames)
+			: Layout(InNumBones, FMotionMatchingUtils::TrajectoryIntervals.Num())
+			, bBakeMirroredFrames(bInBakeMirroredFrames)
+		{
+			const UMotionMatchingEditorSettings* Settings = GetDefault<UMotionMatchingEditorSettings>();
+
+			BytesPerFrame = Layout.GetStride() * sizeof(float) + sizeof(FMotionFrameInfo);
+			ProjectedNumFrames = FMath::CeilToInt(Settings->ProjectedAnimationLength / UAnimationDatabase::GetFrameTimeStep());
+
+			// Every frame is baked a second time mirrored, both rows are searched
+			if (bBakeMirroredFrames)
+			{
+				ProjectedNumFrames *= 2;
+			}
+
+			// The search touches every float of the matrix in the worst case
+			ProjectedSearchTime = ProjectedNumFrames * Layout.GetStride() * Settings->NanosecondsPerFeature / 1000.0f;
+
+			bExceedsDimensionBudget = Layout.GetDimension() > Settings->MaxFeatureDimension;
+			bExceedsSearchTimeBudget = ProjectedSearchTime > Settings->MaxSearchTime;
+		}
+
+		bool ExceedsBudget() const { return bExceedsDimensionBudget || bExceedsSearchTimeBudget; }
+
+		FMotionFeatureLayout Layout;
+		bool bBakeMirroredFrames;
+		int32 BytesPerFrame;
+		int32 ProjectedNumFrames;
+
+		/** In microseconds */
+		float ProjectedSearchTime;
+
+		bool bExceedsDimensionBudget;
+		bool bExceedsSearchTimeBudget;
+	};
+}
+
 
 void SCreateAnimationDatabaseDialog::Construct(const FArguments& InArgs, const bool Ow)
 {
@@ -113,6 +161,50 @@ void SCreateAnimationDatabaseDialog::Construct(const FArguments& InArgs, const b
 						]
 					]
 				]
+				// Begin Feature Budget
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.0f, 8.0f, 0.0f, 0.0f)
+				[
+					SNew(SBorder)
+					.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+					.Padding(4.0f)
+					.Content()
+					[
+						SNew(SVerticalBox)
+						+ SVerticalBox::Slot()
+						.AutoHeight()
+						.Padding(0.0f, 0.0f, 0.0f, 4.0f)
+						[
+							SNew(SCheckBox)
+							.IsChecked(this, &SCreateAnimationDatabaseDialog::IsBakeMirroredFramesChecked)
+							.OnCheckStateChanged(this, &SCreateAnimationDatabaseDialog::OnBakeMirroredFramesChanged)
+							.ToolTipText(LOCTEXT("BakeMirroredFramesToolTip", "Bakes every frame a second time mirrored, which doubles the frames the search goes through"))
+							[
+								SNew(STextBlock)
+								.Text(LOCTEXT("BakeMirroredFrames", "Bake Mirrored Frames"))
+							]
+						]
+						+ SVerticalBox::Slot()
+						.AutoHeight()
+						[
+							SNew(STextBlock)
+							.Text(this, &SCreateAnimationDatabaseDialog::GetBudgetText)
+							.ShadowOffset(FVector2D(1.0f, 1.0f))
+						]
+						+ SVerticalBox::Slot()
+						.AutoHeight()
+						.Padding(0.0f, 4.0f, 0.0f, 0.0f)
+						[
+							SNew(STextBlock)
+							.Text(this, &SCreateAnimationDatabaseDialog::GetBudgetWarningText)
+							.Visibility(this, &SCreateAnimationDatabaseDialog::GetBudgetWarningVisibility)
+							.ColorAndOpacity(FLinearColor(1.0f, 0.3f, 0.1f))
+							.AutoWrapText(true)
+						]
+					]
+				]
+				// End Feature Budget
 				// Begin Confirm and Cancel Buttons
 				+ SVerticalBox::Slot()
 				.AutoHeight()
@@ -146,10 +238,46 @@ void SCreateAnimationDatabaseDialog::Construct(const FArguments& InArgs, const b
 		]
 	];
 
+	bBakeMirroredFrames = false;
+
 	CreateSkeletonPicker();
 	CreateBonePicker();
 }
 
+void SCreateAnimationDatabaseDialog::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+
+	// The bone picker items do not report their changes, so the selection is checked once per frame
+	// instead of every time one of the budget texts is painted
+	const int32 NumSelectedBones = GetNumSelectedBones();
+	if (Estimate.IsValid() && Estimate->Layout.NumBones != NumSelectedBones)
+	{
+		Estimate.Reset();
+	}
+}
+
+const CreateAnimationDatabaseDialogGlobals::FBoneSelectionEstimate& SCreateAnimationDatabaseDialog::GetEstimate() const
+{
+	if (!Estimate.IsValid())
+	{
+		Estimate = MakeShared<CreateAnimationDatabaseDialogGlobals::FBoneSelectionEstimate>(GetNumSelectedBones(), bBakeMirroredFrames);
+	}
+
+	return *Estimate;
+}
+
+ECheckBoxState SCreateAnimationDatabaseDialog::IsBakeMirroredFramesChecked() const
+{
+	return bBakeMirroredFrames ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SCreateAnimationDatabaseDialog::OnBakeMirroredFramesChanged(ECheckBoxState InState)
+{
+	bBakeMirroredFrames = (InState == ECheckBoxState::Checked);
+	Estimate.Reset();
+}
+
 bool SCreateAnimationDatabaseDialog::ConfigureProperties(TWeakObjectPtr<UAnimationDatabaseFactory> InAnimationDatabaseFactory)
 {
 	AnimationDatabaseFactory = InAnimationDatabaseFactory;
@@ -214,6 +342,7 @@ FReply SCreateAnimationDatabaseDialog::OnConfirmClicked()
 	if (AnimationDatabaseFactory.IsValid())
 	{
 		AnimationDatabaseFactory->MotionMatchingSkeleton = Cast<USkeleton>(SelectedSkeleton.GetAsset());
+		AnimationDatabaseFactory->bBakeMirroredFrames = bBakeMirroredFrames;
 	}
 
 	if (!SelectedSkeleton.IsValid())
@@ -222,15 +351,94 @@ FReply SCreateAnimationDatabaseDialog::OnConfirmClicked()
 		return FReply::Handled();
 	}
 
+	// The selection might have changed since the last tick
+	Estimate.Reset();
+
+	if (GetEstimate().ExceedsBudget())
+	{
+		const FText Message = FText::Format(LOCTEXT("BudgetExceededConfirm", "{0}" LINE_TERMINATOR LINE_TERMINATOR "Create the Animation Database anyway?"), GetBudgetWarningText());
+		if (FMessageDialog::Open(EAppMsgType::YesNo, Message) != EAppReturnType::Yes)
+		{
+			return FReply::Handled();
+		}
+	}
+
 	CloseDialog(true);
 
 	return FReply::Handled();
 }
 
+int32 SCreateAnimationDatabaseDialog::GetNumSelectedBones() const
+{
+	int32 NumSelectedBones = 0;
+	for (const TSharedPtr<SBonePickerItem>& BoneItem : BonePickerItems)
+	{
+		if (BoneItem.IsValid() && BoneItem->IsBoneUsedForMotionMatching())
+		{
+			++NumSelectedBones;
+		}
+	}
+
+	return NumSelectedBones;
+}
+
+FText SCreateAnimationDatabaseDialog::GetBudgetText() const
+{
+	const CreateAnimationDatabaseDialogGlobals::FBoneSelectionEstimate& CurrentEstimate = GetEstimate();
+
+	FNumberFormattingOptions Options;
+	Options.MaximumFractionalDigits = 1;
+
+	FFormatNamedArguments Args;
+	Args.Add(TEXT("NumBones"), FText::AsNumber(CurrentEstimate.Layout.NumBones));
+	Args.Add(TEXT("Dimension"), FText::AsNumber(CurrentEstimate.Layout.GetDimension()));
+	Args.Add(TEXT("BytesPerFrame"), FText::AsMemory(CurrentEstimate.BytesPerFrame));
+	Args.Add(TEXT("FramesPerSecond"), FText::AsNumber(1.0f / UAnimationDatabase::GetFrameTimeStep(), &Options));
+	Args.Add(TEXT("ProjectedNumFrames"), FText::AsNumber(CurrentEstimate.ProjectedNumFrames));
+	Args.Add(TEXT("ProjectedSearchTime"), FText::AsNumber(CurrentEstimate.ProjectedSearchTime, &Options));
+	Args.Add(TEXT("Mirrored"), CurrentEstimate.bBakeMirroredFrames ? LOCTEXT("MirroredFramesIncluded", " (half of them mirrored)") : FText::GetEmpty());
+
+	return FText::Format(LOCTEXT("BudgetSummary",
+		"{NumBones} bones selected, {Dimension} features per frame, {BytesPerFrame} per frame" LINE_TERMINATOR
+		"Sampled at {FramesPerSecond} frames per second, {ProjectedNumFrames} frames{Mirrored} are searched in about {ProjectedSearchTime} us"), Args);
+}
+
+FText SCreateAnimationDatabaseDialog::GetBudgetWarningText() const
+{
+	const CreateAnimationDatabaseDialogGlobals::FBoneSelectionEstimate& CurrentEstimate = GetEstimate();
+	const UMotionMatchingEditorSettings* Settings = GetDefault<UMotionMatchingEditorSettings>();
+
+	TArray<FText> Warnings;
+	if (CurrentEstimate.bExceedsDimensionBudget)
+	{
+		Warnings.Add(FText::Format(LOCTEXT("DimensionBudgetExceeded", "The selection has {0} features per frame, the budget is {1}."),
+			FText::AsNumber(CurrentEstimate.Layout.GetDimension()), FText::AsNumber(Settings->MaxFeatureDimension)));
+	}
+
+	if (CurrentEstimate.bExceedsSearchTimeBudget)
+	{
+		Warnings.Add(FText::Format(LOCTEXT("SearchTimeBudgetExceeded", "The projected search takes {0} us, the budget is {1} us."),
+			FText::AsNumber(FMath::RoundToInt(CurrentEstimate.ProjectedSearchTime)), FText::AsNumber(FMath::RoundToInt(Settings->MaxSearchTime))));
+	}
+
+	if (Warnings.Num() > 0)
+	{
+		Warnings.Add(LOCTEXT("BudgetHint", "Select fewer bones, the budget is set in the Motion Matching project settings."));
+	}
+
+	return FText::Join(FText::FromString(TEXT(" ")), Warnings);
+}
+
+EVisibility SCreateAnimationDatabaseDialog::GetBudgetWarningVisibility() const
+{
+	return GetEstimate().ExceedsBudget() ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
 void SCreateAnimationDatabaseDialog::CreateBonePicker()
 {
 	BonePickerItems.Empty();
 	SkeletonBoneContainer->ClearChildren();
+	Estimate.Reset();
 
 	if (SelectedSkeleton.IsValid())
 	{
@@ -0,0 +1,437 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionDatabasePayload.h"
+#include "MotionDatabaseSnapshot.h"
+#include "AnimationFrameData.h"
+#include "MotionTransitionGraph.h"
+#include "MotionFeatureQuantization.h"
+
+
+namespace MotionDatabasePayloadGlobals
+{
+	const uint32 Magic = 0x4D4D4442; // 'MMDB'
+}
+
+static_assert(sizeof(FMotionDatabasePayloadHeader) % MOTION_DATABASE_PAYLOAD_ALIGNMENT == 0, "The payload header has to keep the blocks after it aligned");
+static_assert(TIsTriviallyCopyConstructible<FMotionFrameInfo>::Value, "Frame info is copied into the payload as raw memory");
+
+
+void FMotionDatabasePayload::Write(const TArray<FAnimationFrameData>& InFrameData, const FMotionFeatureLayout& InLayout, const bool bAllowMirroredFrames, FMotionDatabasePayloadData& OutPayload)
+{
+	Write(InFrameData, InLayout, bAllowMirroredFrames, [](const FAnimationFrameData&) { return true; }, OutPayload);
+}
+
+void FMotionDatabasePayload::Write(const TArray<FAnimationFrameData>& InFrameData, const FMotionFeatureLayout& InLayout, const bool bAllowMirroredFrames, TFunctionRef<bool(const FAnimationFrameData&)> InFilter, FMotionDatabasePayloadData& OutPayload)
+{
+	// Gather the frames first, the size of the blocks depends on how many of them are valid
+	TArray<const FAnimationFrameData*> ValidFrames;
+	ValidFrames.Reserve(InFrameData.Num());
+
+	for (const FAnimationFrameData& FrameData : InFrameData)
+	{
+		// Skip frames that were baked with different settings, they can not be compared with the rest
+		if (!FrameData.IsValid() || FrameData.MotionBonesData.Num() != InLayout.NumBones || FrameData.MotionTrajectory.Num() != InLayout.NumTrajectoryPoints)
+		{
+			continue;
+		}
+
+		// Mirrored frames can not be played without a mirror table
+		if (FrameData.bMirrored && !bAllowMirroredFrames)
+		{
+			continue;
+		}
+
+		if (!InFilter(FrameData))
+		{
+			continue;
+		}
+
+		ValidFrames.Add(&FrameData);
+	}
+
+	const int32 Stride = InLayout.GetStride();
+
+	FMotionDatabasePayloadHeader Header;
+	Header.Magic = MotionDatabasePayloadGlobals::Magic;
+	Header.Version = MOTION_DATABASE_PAYLOAD_VERSION;
+	Header.NumBones = InLayout.NumBones;
+	Header.NumTrajectoryPoints = InLayout.NumTrajectoryPoints;
+	Header.NumFrames = ValidFrames.Num();
+	Header.FrameInfoOffset = sizeof(FMotionDatabasePayloadHeader);
+	Header.FeaturesOffset = Align(Header.FrameInfoOffset + Header.NumFrames * (int32)sizeof(FMotionFrameInfo), MOTION_DATABASE_PAYLOAD_ALIGNMENT);
+	Header.TotalSize = Header.FeaturesOffset + Header.NumFrames * Stride * (int32)sizeof(float);
+
+	OutPayload.Reset();
+	OutPayload.AddZeroed(Header.TotalSize);
+
+	uint8* Data = OutPayload.GetData();
+	FMemory::Memcpy(Data, &Header, sizeof(FMotionDatabasePayloadHeader));
+
+	FMotionFrameInfo* FrameInfos = reinterpret_cast<FMotionFrameInfo*>(Data + Header.FrameInfoOffset);
+	float* Features = reinterpret_cast<float*>(Data + Header.FeaturesOffset);
+
+	for (int32 FrameIndex = 0; FrameIndex < ValidFrames.Num(); ++FrameIndex)
+	{
+		const FAnimationFrameData& FrameData = *ValidFrames[FrameIndex];
+
+		FMotionFrameInfo FrameInfo;
+		FrameInfo.SourceAnimationIndex = FrameData.SourceAnimationIndex;
+		FrameInfo.StartTime = FrameData.StartTime;
+		FrameInfo.bMirrored = FrameData.bMirrored;
+		FMemory::Memcpy(&FrameInfos[FrameIndex], &FrameInfo, sizeof(FMotionFrameInfo));
+
+		float* Row = Features + FrameIndex * Stride;
+
+		FMemory::Memcpy(Row + InLayout.GetVelocityOffset(), &FrameData.MotionVelocity, sizeof(FVector));
+
+		for (int32 BoneIndex = 0; BoneIndex < InLayout.NumBones; ++BoneIndex)
+		{
+			float* BoneFeatures = Row + InLayout.GetBoneOffset(BoneIndex);
+			FMemory::Memcpy(BoneFeatures, &FrameData.MotionBonesData[BoneIndex].BonePosition, sizeof(FVector));
+			FMemory::Memcpy(BoneFeatures + 3, &FrameData.MotionBonesData[BoneIndex].BoneVelocity, sizeof(FVector));
+		}
+
+		for (int32 PointIndex = 0; PointIndex < InLayout.NumTrajectoryPoints; ++PointIndex)
+		{
+			FMemory::Memcpy(Row + InLayout.GetTrajectoryOffset(PointIndex), &FrameData.MotionTrajectory.GetLocation(PointIndex), sizeof(FVector));
+		}
+	}
+}
+
+const FMotionDatabasePayloadHeader* FMotionDatabasePayload::GetValidatedHeader(const uint8* InData, const int64 InSize)
+{
+	if (!InData || InSize < (int64)sizeof(FMotionDatabasePayloadHeader) || !IsAligned(InData, MOTION_DATABASE_PAYLOAD_ALIGNMENT))
+	{
+		return nullptr;
+	}
+
+	const FMotionDatabasePayloadHeader* Header = reinterpret_cast<const FMotionDatabasePayloadHeader*>(InData);
+
+	if (Header->Magic != MotionDatabasePayloadGlobals::Magic || Header->Version != MOTION_DATABASE_PAYLOAD_VERSION)
+	{
+		return nullptr;
+	}
+
+	// Make sure every block the header points at is inside of the payload
+	const int64 FeaturesSize = (int64)Header->NumFrames * GetLayout(*Header).GetStride() * sizeof(float);
+	const int64 FrameInfoEnd = (int64)Header->FrameInfoOffset + (int64)Header->NumFrames * sizeof(FMotionFrameInfo);
+	const int64 FeaturesEnd = Header->FeaturesOffset + FeaturesSize;
+
+	if (Header->NumFrames < 0 || Header->NumBones < 0 || Header->NumTrajectoryPoints < 0
+		|| Header->TotalSize != InSize
+		|| FrameInfoEnd > Header->FeaturesOffset
+		|| !IsAligned(Header->FeaturesOffset, MOTION_DATABASE_PAYLOAD_ALIGNMENT)
+		|| FeaturesEnd > InSize)
+	{
+		return nullptr;
+	}
+
+	if (Header->HasTransitionGraph())
+	{
+		const int64 SegmentsEnd = (int64)Header->SegmentsOffset + (int64)Header->NumFrames * sizeof(int32);
+		const int64 TransitionsEnd = (int64)Header->TransitionsOffset + (int64)Header->NumSegments * Header->TransitionsPerSegment * sizeof(int32);
+
+		if (Header->TransitionsPerSegment <= 0
+			|| Header->SegmentsOffset < FeaturesEnd
+			|| !IsAligned(Header->SegmentsOffset, sizeof(int32))
+			|| Header->TransitionsOffset < SegmentsEnd
+			|| TransitionsEnd > InSize)
+		{
+			return nullptr;
+		}
+	}
+
+	if (Header->HasQuantizedFeatures())
+	{
+		const int64 CodebooksEnd = (int64)Header->CodebooksOffset + (int64)Header->NumCodeGroups * Header->CodebookSize * 3 * sizeof(float);
+		const int64 CodesEnd = (int64)Header->CodesOffset + (int64)Header->NumFrames * Header->NumCodeGroups;
+
+		if (Header->CodebookSize > FMotionFeatureQuantization::MaxCodebookSize
+			|| Header->NumCodeGroups != FMotionFeatureQuantization::GetNumGroups(GetLayout(*Header))
+			|| Header->CodebooksOffset < FeaturesEnd
+			|| !IsAligned(Header->CodebooksOffset, sizeof(float))
+			|| Header->CodesOffset < CodebooksEnd
+			|| CodesEnd > InSize)
+		{
+			return nullptr;
+		}
+	}
+
+	return Header;
+}
+
+bool FMotionDatabasePayload::Concatenate(const TArray<const FMotionDatabasePayloadData*>& InPayloads, FMotionDatabasePayloadData& OutPayload)
+{
+	TArray<const FMotionDatabasePayloadHeader*, TInlineAllocator<8>> Headers;
+	int32 NumFrames = 0;
+	int32 NumSegments = 0;
+	bool bKeepTransitionGraph = InPayloads.Num() > 0;
+
+	for (const FMotionDatabasePayloadData* Payload : InPayloads)
+	{
+		const FMotionDatabasePayloadHeader* Header = Payload ? GetValidatedHeader(Payload->GetData(), Payload->Num()) : nullptr;
+
+		if (!Header || (Headers.Num() > 0 && GetLayout(*Header) != GetLayout(*Headers[0])))
+		{
+			return false;
+		}
+
+		Headers.Add(Header);
+		NumFrames += Header->NumFrames;
+		NumSegments += Header->NumSegments;
+
+		bKeepTransitionGraph &= Header->HasTransitionGraph() && Header->TransitionsPerSegment == Headers[0]->TransitionsPerSegment;
+	}
+
+	// Codes can only be searched together when they index the same codebooks
+	bool bKeepQuantizedFeatures = Headers.Num() > 0 && Headers[0]->HasQuantizedFeatures();
+	const int32 CodebooksSize = bKeepQuantizedFeatures ? Headers[0]->NumCodeGroups * Headers[0]->CodebookSize * 3 * (int32)sizeof(float) : 0;
+
+	for (int32 PayloadIndex = 1; PayloadIndex < Headers.Num() && bKeepQuantizedFeatures; ++PayloadIndex)
+	{
+		const FMotionDatabasePayloadHeader& SourceHeader = *Headers[PayloadIndex];
+
+		bKeepQuantizedFeatures = SourceHeader.HasQuantizedFeatures()
+			&& SourceHeader.CodebookSize == Headers[0]->CodebookSize
+			&& SourceHeader.NumCodeGroups == Headers[0]->NumCodeGroups
+			&& FMemory::Memcmp(InPayloads[PayloadIndex]->GetData() + SourceHeader.CodebooksOffset, InPayloads[0]->GetData() + Headers[0]->CodebooksOffset, CodebooksSize) == 0;
+	}
+
+	const FMotionFeatureLayout Layout = Headers.Num() > 0 ? GetLayout(*Headers[0]) : FMotionFeatureLayout();
+	const int32 RowSize = Layout.GetStride() * sizeof(float);
+
+	FMotionDatabasePayloadHeader Header;
+	Header.Magic = MotionDatabasePayloadGlobals::Magic;
+	Header.Version = MOTION_DATABASE_PAYLOAD_VERSION;
+	Header.NumBones = Layout.NumBones;
+	Header.NumTrajectoryPoints = Layout.NumTrajectoryPoints;
+	Header.NumFrames = NumFrames;
+	Header.FrameInfoOffset = sizeof(FMotionDatabasePayloadHeader);
+	Header.FeaturesOffset = Align(Header.FrameInfoOffset + NumFrames * (int32)sizeof(FMotionFrameInfo), MOTION_DATABASE_PAYLOAD_ALIGNMENT);
+	Header.TotalSize = Header.FeaturesOffset + NumFrames * RowSize;
+
+	if (bKeepTransitionGraph)
+	{
+		Header.NumSegments = NumSegments;
+		Header.TransitionsPerSegment = Headers[0]->TransitionsPerSegment;
+		Header.SegmentsOffset = Header.TotalSize;
+		Header.TransitionsOffset = Header.SegmentsOffset + NumFrames * (int32)sizeof(int32);
+		Header.TotalSize = Header.TransitionsOffset + NumSegments * Header.TransitionsPerSegment * (int32)sizeof(int32);
+	}
+
+	if (bKeepQuantizedFeatures)
+	{
+		Header.CodebookSize = Headers[0]->CodebookSize;
+		Header.NumCodeGroups = Headers[0]->NumCodeGroups;
+		Header.CodebooksOffset = Align(Header.TotalSize, MOTION_DATABASE_PAYLOAD_ALIGNMENT);
+		Header.CodesOffset = Header.CodebooksOffset + CodebooksSize;
+		Header.TotalSize = Header.CodesOffset + NumFrames * Header.NumCodeGroups;
+	}
+
+	OutPayload.Reset();
+	OutPayload.AddZeroed(Header.TotalSize);
+
+	uint8* Data = OutPayload.GetData();
+	FMemory::Memcpy(Data, &Header, sizeof(FMotionDatabasePayloadHeader));
+
+	if (bKeepQuantizedFeatures)
+	{
+		FMemory::Memcpy(Data + Header.CodebooksOffset, InPayloads[0]->GetData() + Headers[0]->CodebooksOffset, CodebooksSize);
+	}
+
+	// Both blocks of every payload are contiguous, so each payload is two copies
+	int32 FrameOffset = 0;
+	int32 SegmentOffset = 0;
+	for (int32 PayloadIndex = 0; PayloadIndex < Headers.Num(); ++PayloadIndex)
+	{
+		const uint8* SourceData = InPayloads[PayloadIndex]->GetData();
+		const FMotionDatabasePayloadHeader& SourceHeader = *Headers[PayloadIndex];
+
+		FMemory::Memcpy(Data + Header.FrameInfoOffset + FrameOffset * sizeof(FMotionFrameInfo), SourceData + SourceHeader.FrameInfoOffset, SourceHeader.NumFrames * sizeof(FMotionFrameInfo));
+		FMemory::Memcpy(Data + Header.FeaturesOffset + FrameOffset * RowSize, SourceData + SourceHeader.FeaturesOffset, SourceHeader.NumFrames * RowSize);
+
+		// The graph refers to frames and segments by index, move them behind the ones of the previous payloads
+		if (bKeepTransitionGraph)
+		{
+			const int32* SourceSegments = reinterpret_cast<const int32*>(SourceData + SourceHeader.SegmentsOffset);
+			int32* Segments = reinterpret_cast<int32*>(Data + Header.SegmentsOffset) + FrameOffset;
+
+			for (int32 FrameIndex = 0; FrameIndex < SourceHeader.NumFrames; ++FrameIndex)
+			{
+				Segments[FrameIndex] = SourceSegments[FrameIndex] + SegmentOffset;
+			}
+
+			const int32 NumTransitions = SourceHeader.NumSegments * SourceHeader.TransitionsPerSegment;
+			const int32* SourceTransitions = reinterpret_cast<const int32*>(SourceData + SourceHeader.TransitionsOffset);
+			int32* Transitions = reinterpret_cast<int32*>(Data + Header.TransitionsOffset) + SegmentOffset * Header.TransitionsPerSegment;
+
+			for (int32 TransitionIndex = 0; TransitionIndex < NumTransitions; ++TransitionIndex)
+			{
+				Transitions[TransitionIndex] = SourceTransitions[TransitionIndex] != INDEX_NONE ? SourceTransitions[TransitionIndex] + FrameOffset : INDEX_NONE;
+			}
+		}
+
+		// Codes are stored per frame, so they only have to be appended
+		if (bKeepQuantizedFeatures)
+		{
+			FMemory::Memcpy(Data + Header.CodesOffset + FrameOffset * Header.NumCodeGroups, SourceData + SourceHeader.CodesOffset, SourceHeader.NumFrames * SourceHeader.NumCodeGroups);
+		}
+
+		FrameOffset += SourceHeader.NumFrames;
+		SegmentOffset += SourceHeader.NumSegments;
+	}
+
+	return true;
+}
+
+void FMotionDatabasePayload::WriteTransitionGraph(const FMotionTransitionGraphSettings& InSettings, FMotionDatabasePayloadData& InOutPayload)
+{
+	const FMotionDatabasePayloadHeader* ValidatedHeader = GetValidatedHeader(InOutPayload.GetData(), InOutPayload.Num());
+	if (!ValidatedHeader || ValidatedHeader->HasTransitionGraph())
+	{
+		return;
+	}
+
+	FMotionDatabasePayloadHeader Header = *ValidatedHeader;
+	const FMotionFeatureLayout Layout = GetLayout(Header);
+
+	TArray<int32> FrameSegments;
+	TArray<int32> Transitions;
+	FMotionTransitionGraph::Build(
+		Layout,
+		reinterpret_cast<const FMotionFrameInfo*>(InOutPayload.GetData() + Header.FrameInfoOffset),
+		reinterpret_cast<const float*>(InOutPayload.GetData() + Header.FeaturesOffset),
+		Header.NumFrames,
+		InSettings.FramesPerSegment,
+		InSettings.TransitionsPerSegment,
+		FrameSegments,
+		Transitions);
+
+	if (FrameSegments.Num() == 0)
+	{
+		return;
+	}
+
+	// Append the graph after the last block
+	Header.NumSegments = Transitions.Num() / FMath::Max(1, InSettings.TransitionsPerSegment);
+	Header.TransitionsPerSegment = FMath::Max(1, InSettings.TransitionsPerSegment);
+	Header.SegmentsOffset = Align(Header.TotalSize, MOTION_DATABASE_PAYLOAD_ALIGNMENT);
+	Header.TransitionsOffset = Header.SegmentsOffset + FrameSegments.Num() * (int32)sizeof(int32);
+	Header.TotalSize = Header.TransitionsOffset + Transitions.Num() * (int32)sizeof(int32);
+
+	InOutPayload.SetNumZeroed(Header.TotalSize);
+
+	uint8* Data = InOutPayload.GetData();
+	FMemory::Memcpy(Data, &Header, sizeof(FMotionDatabasePayloadHeader));
+	FMemory::Memcpy(Data + Header.SegmentsOffset, FrameSegments.GetData(), FrameSegments.Num() * sizeof(int32));
+	FMemory::Memcpy(Data + Header.TransitionsOffset, Transitions.GetData(), Transitions.Num() * sizeof(int32));
+}
+
+void FMotionDatabasePayload::WriteQuantizedFeatures(const FMotionFeatureQuantizationSettings& InSettings, const TArray<FMotionDatabasePayloadData*>& InOutPayloads)
+{
+	TArray<FMotionDatabasePayloadData*> TargetPayloads;
+	TArray<const FMotionDatabasePayloadData*> TrainingPayloads;
+	const FMotionDatabasePayloadData* EncodedPayload = nullptr;
+	for (FMotionDatabasePayloadData* Payload : InOutPayloads)
+	{
+		const FMotionDatabasePayloadHeader* Header = GetValidatedHeader(Payload->GetData(), Payload->Num());
+		if (Header && !Header->HasQuantizedFeatures())
+		{
+			TargetPayloads.Add(Payload);
+			TrainingPayloads.Add(Payload);
+		}
+		else if (Header && !EncodedPayload)
+		{
+			EncodedPayload = Payload;
+		}
+	}
+
+	if (TrainingPayloads.Num() == 0)
+	{
+		return;
+	}
+
+	int32 CodebookSize = 0;
+	TArray<float> Codebooks;
+	FMotionFeatureLayout Layout;
+
+	if (EncodedPayload)
+	{
+		// Payloads that join encoded ones are encoded with the same codebooks, so the codes can still be concatenated
+		const FMotionDatabasePayloadHeader& EncodedHeader = *GetValidatedHeader(EncodedPayload->GetData(), EncodedPayload->Num());
+		Layout = GetLayout(EncodedHeader);
+		CodebookSize = EncodedHeader.CodebookSize;
+		Codebooks.Append(reinterpret_cast<const float*>(EncodedPayload->GetData() + EncodedHeader.CodebooksOffset), EncodedHeader.NumCodeGroups * CodebookSize * 3);
+	}
+	else
+	{
+		// Train on the frames of every payload at once, so all of them share the same codebooks
+		FMotionDatabasePayloadData CombinedPayload;
+		const FMotionDatabasePayloadData* TrainingPayload = TrainingPayloads[0];
+
+		if (TrainingPayloads.Num() > 1)
+		{
+			if (!Concatenate(TrainingPayloads, CombinedPayload))
+			{
+				return;
+			}
+
+			TrainingPayload = &CombinedPayload;
+		}
+
+		const FMotionDatabasePayloadHeader& TrainingHeader = *GetValidatedHeader(TrainingPayload->GetData(), TrainingPayload->Num());
+		Layout = GetLayout(TrainingHeader);
+
+		FMotionFeatureQuantization::Train(
+			Layout,
+			reinterpret_cast<const float*>(TrainingPayload->GetData() + TrainingHeader.FeaturesOffset),
+			TrainingHeader.NumFrames,
+			InSettings.TrainingIterations,
+			CodebookSize,
+			Codebooks);
+	}
+
+	if (CodebookSize == 0)
+	{
+		return;
+	}
+
+	for (FMotionDatabasePayloadData* Payload : TargetPayloads)
+	{
+		FMotionDatabasePayloadData& OutPayload = *Payload;
+		FMotionDatabasePayloadHeader Header = *GetValidatedHeader(OutPayload.GetData(), OutPayload.Num());
+
+		if (GetLayout(Header) != Layout)
+		{
+			continue;
+		}
+
+		TArray<uint8> Codes;
+		FMotionFeatureQuantization::Encode(
+			Layout,
+			reinterpret_cast<const float*>(OutPayload.GetData() + Header.FeaturesOffset),
+			Header.NumFrames,
+			CodebookSize,
+			Codebooks.GetData(),
+			Codes);
+
+		// Append the codebooks and the codes after the last block
+		Header.CodebookSize = CodebookSize;
+		Header.NumCodeGroups = FMotionFeatureQuantization::GetNumGroups(Layout);
+		Header.CodebooksOffset = Align(Header.TotalSize, MOTION_DATABASE_PAYLOAD_ALIGNMENT);
+		Header.CodesOffset = Header.CodebooksOffset + Codebooks.Num() * (int32)sizeof(float);
+		Header.TotalSize = Header.CodesOffset + Codes.Num();
+
+		OutPayload.SetNumZeroed(Header.TotalSize);
+
+		uint8* Data = OutPayload.GetData();
+		FMemory::Memcpy(Data, &Header, sizeof(FMotionDatabasePayloadHeader));
+		FMemory::Memcpy(Data + Header.CodebooksOffset, Codebooks.GetData(), Codebooks.Num() * sizeof(float));
+		FMemory::Memcpy(Data + Header.CodesOffset, Codes.GetData(), Codes.Num());
+	}
+}
+
+FMotionFeatureLayout FMotionDatabasePayload::GetLayout(const FMotionDatabasePayloadHeader& InHeader)
+{
+	return FMotionFeatureLayout(InHeader.NumBones, InHeader.NumTrajectoryPoints);
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "Templates/SharedPointer.h"
+
+struct FAnimationFrameData;
+struct FMotionFeatureLayout;
+struct FMotionTransitionGraphSettings;
+struct FMotionFeatureQuantizationSettings;
+
+/** Bump whenever the layout of the payload changes, payloads with a different version are rebuilt from the frame data */
+#define MOTION_DATABASE_PAYLOAD_VERSION 3
+
+/** Alignment of every block inside the payload, matches the alignment of the search matrix rows */
+#define MOTION_DATABASE_PAYLOAD_ALIGNMENT 16
+
+/**
+ * Start of a baked search matrix payload.
+ * [Header] [FMotionFrameInfo * NumFrames] [Padding] [float * Stride * NumFrames]
+ * The transition graph and the quantized features are optional, they follow the features in the order they were written.
+ * [int32 Segment * NumFrames] [int32 Transition * TransitionsPerSegment * NumSegments]
+ * [float Codebook * 3 * CodebookSize * NumCodeGroups] [uint8 Code * NumCodeGroups * NumFrames]
+ */
+struct FMotionDatabasePayloadHeader
+{
+	FMotionDatabasePayloadHeader()
+		: Magic(0)
+		, Version(0)
+		, NumBones(0)
+		, NumTrajectoryPoints(0)
+		, NumFrames(0)
+		, FrameInfoOffset(0)
+		, FeaturesOffset(0)
+		, TotalSize(0)
+		, NumSegments(0)
+		, TransitionsPerSegment(0)
+		, SegmentsOffset(0)
+		, TransitionsOffset(0)
+		, CodebookSize(0)
+		, NumCodeGroups(0)
+		, CodebooksOffset(0)
+		, CodesOffset(0)
+	{
+	}
+
+	bool HasTransitionGraph() const { return NumSegments > 0; }
+	bool HasQuantizedFeatures() const { return CodebookSize > 0; }
+
+	uint32 Magic;
+	uint32 Version;
+	int32 NumBones;
+	int32 NumTrajectoryPoints;
+	int32 NumFrames;
+	int32 FrameInfoOffset;
+	int32 FeaturesOffset;
+	int32 TotalSize;
+	int32 NumSegments;
+	int32 TransitionsPerSegment;
+	int32 SegmentsOffset;
+	int32 TransitionsOffset;
+	int32 CodebookSize;
+	int32 NumCodeGroups;
+	int32 CodebooksOffset;
+	int32 CodesOffset;
+};
+
+/** Payload bytes, allocated so the search matrix inside of it can be used in place */
+typedef TArray<uint8, TAlignedHeapAllocator<MOTION_DATABASE_PAYLOAD_ALIGNMENT>> FMotionDatabasePayloadData;
+
+/** Payloads are shared between the snapshots that search them */
+typedef TSharedPtr<const FMotionDatabasePayloadData, ESPMode::ThreadSafe> FMotionDatabasePayloadPtr;
+
+/**
+ * Binary format of the search matrix of an animation database.
+ * Cooked databases store it as bulk data, so loading the matrix is a single read into a single allocation
+ * instead of constructing every baked frame and its nested arrays.
+ */
+class MOTIONMATCHING_API FMotionDatabasePayload
+{
+public:
+	/** Flattens the baked frame data, frames that do not match the layout (or mirrored frames when they are not allowed) are skipped */
+	static void Write(const TArray<FAnimationFrameData>& InFrameData, const FMotionFeatureLayout& InLayout, const bool bAllowMirroredFrames, FMotionDatabasePayloadData& OutPayload);
+
+	/** Same as Write, but only the frames that pass the filter end up in the payload */
+	static void Write(const TArray<FAnimationFrameData>& InFrameData, const FMotionFeatureLayout& InLayout, const bool bAllowMirroredFrames, TFunctionRef<bool(const FAnimationFrameData&)> InFilter, FMotionDatabasePayloadData& OutPayload);
+
+	/** Builds the transition graph of the frames in the payload and appends it, does nothing when the payload already has one */
+	static void WriteTransitionGraph(const FMotionTransitionGraphSettings& InSettings, FMotionDatabasePayloadData& InOutPayload);
+
+	/**
+	 * Trains one set of codebooks on the frames of all payloads, encodes the frames of every payload with it and appends both.
+	 * Payloads that already have quantized features are left alone, when there are any the others are encoded with their codebooks.
+	 * Sharing the codebooks lets Concatenate keep the codes.
+	 */
+	static void WriteQuantizedFeatures(const FMotionFeatureQuantizationSettings& InSettings, const TArray<FMotionDatabasePayloadData*>& InOutPayloads);
+
+	/**
+	 * Appends the frames of every payload into a single payload, returns false when a payload is not valid or the layouts differ.
+	 * The transition graphs are kept when every payload has one, transitions stay within the frames of their own payload.
+	 * The quantized features are kept when every payload was encoded with the same codebooks, see WriteQuantizedFeatures.
+	 */
+	static bool Concatenate(const TArray<const FMotionDatabasePayloadData*>& InPayloads, FMotionDatabasePayloadData& OutPayload);
+
+	/** Returns the header when the payload is complete and was written with the current version, nullptr otherwise */
+	static const FMotionDatabasePayloadHeader* GetValidatedHeader(const uint8* InData, const int64 InSize);
+
+	/** Layout of the rows of a validated payload */
+	static FMotionFeatureLayout GetLayout(const FMotionDatabasePayloadHeader& InHeader);
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MotionDatabasePayload.h"
+#include "MotionDatabaseShard.generated.h"
+
+class UAnimSequence;
+
+/**
+ * A part of an animation database that is only needed in a certain gameplay context (traversal, combat, ...).
+ * Every shard is cooked into its own payload, so it can be streamed in when the context becomes relevant and released afterwards.
+ * Animations that are not part of any shard are always resident.
+ */
+USTRUCT()
+struct MOTIONMATCHING_API FMotionDatabaseShardSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FMotionDatabaseShardSettings()
+		: ContextName(NAME_None)
+		, bResidentOnLoad(false)
+	{
+	}
+
+	/** Name gameplay code uses to request the shard */
+	UPROPERTY(EditAnywhere, Category = "Shard")
+	FName ContextName;
+
+	/** The frames of these source animations are only searched while the shard is resident */
+	UPROPERTY(EditAnywhere, Category = "Shard")
+	TArray<UAnimSequence*> Animations;
+
+	/** Request the shard as soon as the database is loaded */
+	UPROPERTY(EditAnywhere, Category = "Shard")
+	bool bResidentOnLoad;
+};
+
+/** The search payload of a shard that is currently in memory */
+struct FMotionDatabaseResidentShard
+{
+	FMotionDatabaseResidentShard()
+		: ContextName(NAME_None)
+	{
+	}
+
+	FMotionDatabaseResidentShard(const FName InContextName, const FMotionDatabasePayloadPtr& InPayload)
+		: ContextName(InContextName)
+		, Payload(InPayload)
+	{
+	}
+
+	/** NAME_None for the frames that are not part of any shard */
+	FName ContextName;
+	FMotionDatabasePayloadPtr Payload;
+};
+
+/** A shard that is being streamed in, the request reads straight into the payload */
+struct FMotionDatabaseShardRequest
+{
+	FMotionDatabaseShardRequest()
+		: Request(nullptr)
+	{
+	}
+
+	class IBulkDataIORequest* Request;
+	FMotionDatabasePayloadPtr Payload;
+};
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionDatabaseSnapshot.h"
+#include "MotionTransitionGraph.h"
+#include "Animation/AnimSequence.h"
+#include "Algo/BinarySearch.h"
+
+
+FMotionDatabaseSnapshot::FMotionDatabaseSnapshot()
+	: Frames(nullptr)
+	, Features(nullptr)
+	, NumFrames(0)
+	, FrameSegments(nullptr)
+	, Transitions(nullptr)
+	, NumSegments(0)
+	, TransitionsPerSegment(0)
+	, Codebooks(nullptr)
+	, Codes(nullptr)
+	, CodebookSize(0)
+	, NumCodeGroups(0)
+	, Version(0)
+{
+}
+
+FMotionDatabaseSnapshotPtr FMotionDatabaseSnapshot::BuildFromShards(
+	const TArray<FMotionDatabaseResidentShard>& InResidentShards,
+	const TArray<UAnimSequence*>& InAnimations,
+	const TArray<FRootMotionTrack>& InRootMotionTracks,
+	const TArray<FName>& InBones,
+	const FMotionMirrorTable& InMirrorTable,
+	const uint32 InVersion)
+{
+	FMotionDatabaseSnapshot* Snapshot = new FMotionDatabaseSnapshot();
+	Snapshot->Animations.Append(InAnimations);
+	Snapshot->RootMotionTracks = InRootMotionTracks;
+	Snapshot->Bones = InBones;
+	Snapshot->MirrorTable = InMirrorTable;
+	Snapshot->Version = InVersion;
+
+	TArray<const FMotionDatabasePayloadData*> Payloads;
+	for (const FMotionDatabaseResidentShard& ResidentShard : InResidentShards)
+	{
+		// Shards without a payload do not add any frames, but they are still resident
+		Snapshot->ResidentShards.Add(ResidentShard.ContextName);
+
+		if (ResidentShard.Payload.IsValid())
+		{
+			Payloads.Add(ResidentShard.Payload.Get());
+			Snapshot->Payload = ResidentShard.Payload;
+		}
+	}
+
+	// Only a single payload can be searched in place
+	if (Payloads.Num() != 1)
+	{
+		FMotionDatabasePayloadData* CombinedPayload = new FMotionDatabasePayloadData();
+		Snapshot->Payload = FMotionDatabasePayloadPtr(CombinedPayload);
+
+		if (!FMotionDatabasePayload::Concatenate(Payloads, *CombinedPayload))
+		{
+			delete Snapshot;
+			return nullptr;
+		}
+	}
+
+	if (!Snapshot->InitializeFromPayload())
+	{
+		delete Snapshot;
+		return nullptr;
+	}
+
+	return FMotionDatabaseSnapshotPtr(Snapshot);
+}
+
+bool FMotionDatabaseSnapshot::InitializeFromPayload()
+{
+	const FMotionDatabasePayloadHeader* Header = FMotionDatabasePayload::GetValidatedHeader(Payload->GetData(), Payload->Num());
+	if (!Header)
+	{
+		return false;
+	}
+
+	// The payload was baked against a different set of bones, the features can not be compared with the current pose
+	if (Header->NumBones != Bones.Num())
+	{
+		return false;
+	}
+
+	Layout = FMotionDatabasePayload::GetLayout(*Header);
+	NumFrames = Header->NumFrames;
+	Frames = reinterpret_cast<const FMotionFrameInfo*>(Payload->GetData() + Header->FrameInfoOffset);
+	Features = reinterpret_cast<const float*>(Payload->GetData() + Header->FeaturesOffset);
+
+	// FindFrameIndex is used with and without a transition graph, the tracks only depend on the frames
+	FMotionTransitionGraph::ForEachAnimationTrack(Frames, NumFrames, [this](const TArray<int32>& SortedFrames)
+	{
+		const FMotionFrameInfo& FirstFrame = Frames[SortedFrames[0]];
+		AnimationTracks.Add(((uint64)(uint32)FirstFrame.SourceAnimationIndex << 1) | (FirstFrame.bMirrored ? 1 : 0), SortedFrames);
+	});
+
+	if (Header->HasTransitionGraph())
+	{
+		FrameSegments = reinterpret_cast<const int32*>(Payload->GetData() + Header->SegmentsOffset);
+		Transitions = reinterpret_cast<const int32*>(Payload->GetData() + Header->TransitionsOffset);
+		NumSegments = Header->NumSegments;
+		TransitionsPerSegment = Header->TransitionsPerSegment;
+
+		// The graph is used for indexing without further checks, a graph that points outside of the payload is dropped
+		bool bValidGraph = true;
+		for (int32 FrameIndex = 0; FrameIndex < NumFrames && bValidGraph; ++FrameIndex)
+		{
+			bValidGraph = FrameSegments[FrameIndex] >= 0 && FrameSegments[FrameIndex] < NumSegments;
+		}
+
+		for (int32 TransitionIndex = 0; TransitionIndex < NumSegments * TransitionsPerSegment && bValidGraph; ++TransitionIndex)
+		{
+			bValidGraph = Transitions[TransitionIndex] >= INDEX_NONE && Transitions[TransitionIndex] < NumFrames;
+		}
+
+		if (!bValidGraph)
+		{
+			FrameSegments = nullptr;
+			Transitions = nullptr;
+			NumSegments = 0;
+			TransitionsPerSegment = 0;
+		}
+	}
+
+	if (Header->HasQuantizedFeatures())
+	{
+		Codebooks = reinterpret_cast<const float*>(Payload->GetData() + Header->CodebooksOffset);
+		Codes = Payload->GetData() + Header->CodesOffset;
+		CodebookSize = Header->CodebookSize;
+		NumCodeGroups = Header->NumCodeGroups;
+
+		// Codes index the cost table of a query, codes outside of the codebook would read past it
+		for (int32 CodeIndex = 0; CodeIndex < NumFrames * NumCodeGroups; ++CodeIndex)
+		{
+			if (Codes[CodeIndex] >= CodebookSize)
+			{
+				Codebooks = nullptr;
+				Codes = nullptr;
+				CodebookSize = 0;
+				NumCodeGroups = 0;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+TArrayView<const int32> FMotionDatabaseSnapshot::GetTransitions(const int32 FrameIndex) const
+{
+	if (!HasTransitionGraph() || !IsValidIndex(FrameIndex))
+	{
+		return TArrayView<const int32>();
+	}
+
+	return TArrayView<const int32>(Transitions + FrameSegments[FrameIndex] * TransitionsPerSegment, TransitionsPerSegment);
+}
+
+TArrayView<const int32> FMotionDatabaseSnapshot::GetSegmentTransitions(const int32 SegmentIndex) const
+{
+	if (SegmentIndex < 0 || SegmentIndex >= NumSegments)
+	{
+		return TArrayView<const int32>();
+	}
+
+	return TArrayView<const int32>(Transitions + SegmentIndex * TransitionsPerSegment, TransitionsPerSegment);
+}
+
+int32 FMotionDatabaseSnapshot::FindFrameIndex(const int32 AnimationIndex, const float Time, const bool bMirrored) const
+{
+	const TArray<int32>* Track = AnimationTracks.Find(((uint64)(uint32)AnimationIndex << 1) | (bMirrored ? 1 : 0));
+	if (!Track)
+	{
+		return INDEX_NONE;
+	}
+
+	// First frame that starts after the time, the one before it is the frame that is playing
+	const int32 NextFrame = Algo::UpperBoundBy(*Track, Time, [this](const int32 FrameIndex) { return Frames[FrameIndex].StartTime; });
+	return (*Track)[FMath::Max(0, NextFrame - 1)];
+}
+
+UAnimSequence* FMotionDatabaseSnapshot::GetAnimation(const int32 AnimationIndex) const
+{
+	return Animations.IsValidIndex(AnimationIndex) ? Animations[AnimationIndex].Get() : nullptr;
+}
+
+int32 FMotionDatabaseSnapshot::FindAnimationIndex(const UAnimSequence* InAnimation) const
+{
+	// Collected animations read as null, they must not match a null animation
+	if (!InAnimation)
+	{
+		return INDEX_NONE;
+	}
+
+	return Animations.IndexOfByPredicate([InAnimation](const TWeakObjectPtr<UAnimSequence>& Animation) { return Animation.Get() == InAnimation; });
+}
+
+const FRootMotionTrack* FMotionDatabaseSnapshot::GetRootMotionTrack(const int32 AnimationIndex) const
+{
+	if (RootMotionTracks.IsValidIndex(AnimationIndex) && RootMotionTracks[AnimationIndex].IsValid())
+	{
+		return &RootMotionTracks[AnimationIndex];
+	}
+
+	return nullptr;
+}
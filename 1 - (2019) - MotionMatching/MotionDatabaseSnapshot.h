@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "RootMotionTrack.h"
+#include "MotionMatchingMirroring.h"
+#include "MotionDatabasePayload.h"
+#include "MotionDatabaseShard.h"
+#include "Containers/ArrayView.h"
+
+class UAnimSequence;
+
+/**
+ * Describes how the features of a single frame are laid out in the search matrix.
+ * [Velocity (3)] [Bone Position (3), Bone Velocity (3)] * NumBones [Trajectory Location (3)] * NumTrajectoryPoints
+ */
+struct MOTIONMATCHING_API FMotionFeatureLayout
+{
+	FMotionFeatureLayout()
+		: NumBones(0)
+		, NumTrajectoryPoints(0)
+	{
+	}
+
+	FMotionFeatureLayout(const int32 InNumBones, const int32 InNumTrajectoryPoints)
+		: NumBones(InNumBones)
+		, NumTrajectoryPoints(InNumTrajectoryPoints)
+	{
+	}
+
+	static const int32 VelocityDimension = 3;
+	static const int32 BoneDimension = 6;
+	static const int32 TrajectoryPointDimension = 3;
+
+	FORCEINLINE int32 GetVelocityOffset() const { return 0; }
+	FORCEINLINE int32 GetBoneOffset(const int32 BoneIndex) const { return VelocityDimension + BoneIndex * BoneDimension; }
+	FORCEINLINE int32 GetTrajectoryOffset(const int32 PointIndex = 0) const { return VelocityDimension + NumBones * BoneDimension + PointIndex * TrajectoryPointDimension; }
+
+	/** Number of floats that describe a frame */
+	FORCEINLINE int32 GetDimension() const { return VelocityDimension + NumBones * BoneDimension + NumTrajectoryPoints * TrajectoryPointDimension; }
+
+	/** Number of floats between two rows, rows are padded so every row starts 16 byte aligned */
+	FORCEINLINE int32 GetStride() const { return Align(GetDimension(), 4); }
+
+	bool operator==(const FMotionFeatureLayout& Other) const { return NumBones == Other.NumBones && NumTrajectoryPoints == Other.NumTrajectoryPoints; }
+	bool operator!=(const FMotionFeatureLayout& Other) const { return !(*this == Other); }
+
+	int32 NumBones;
+	int32 NumTrajectoryPoints;
+};
+
+/** The part of a baked frame that is needed after the search, to start playing the winner */
+struct FMotionFrameInfo
+{
+	FMotionFrameInfo()
+		: SourceAnimationIndex(INDEX_NONE)
+		, StartTime(0.0f)
+		, bMirrored(false)
+	{
+	}
+
+	int32 SourceAnimationIndex;
+	float StartTime;
+
+	/** The source animation has to be mirrored when this frame is played */
+	bool bMirrored;
+};
+
+typedef TSharedPtr<const class FMotionDatabaseSnapshot, ESPMode::ThreadSafe> FMotionDatabaseSnapshotPtr;
+
+/**
+ * Immutable copy of everything the runtime needs from an animation database.
+ * The animation database publishes a new snapshot every time it is rebaked, nodes hold on to the snapshot they acquired,
+ * so the search on the animation worker threads never reads data that the editor is modifying.
+ */
+class MOTIONMATCHING_API FMotionDatabaseSnapshot
+{
+public:
+	/**
+	 * Searches the payloads of the resident shards. A single shard is searched in place, multiple shards are appended into one matrix.
+	 * Returns nullptr when a payload is not valid.
+	 */
+	static FMotionDatabaseSnapshotPtr BuildFromShards(
+		const TArray<FMotionDatabaseResidentShard>& InResidentShards,
+		const TArray<UAnimSequence*>& InAnimations,
+		const TArray<FRootMotionTrack>& InRootMotionTracks,
+		const TArray<FName>& InBones,
+		const FMotionMirrorTable& InMirrorTable,
+		const uint32 InVersion);
+
+	FORCEINLINE const FMotionFeatureLayout& GetLayout() const { return Layout; }
+	FORCEINLINE int32 Num() const { return NumFrames; }
+	FORCEINLINE bool IsValidIndex(const int32 FrameIndex) const { return FrameIndex >= 0 && FrameIndex < NumFrames; }
+
+	FORCEINLINE const float* GetFeatures(const int32 FrameIndex) const { return Features + FrameIndex * Layout.GetStride(); }
+	FORCEINLINE const FMotionFrameInfo& GetFrameInfo(const int32 FrameIndex) const { return Frames[FrameIndex]; }
+
+	/** The serialized form of the search matrix, the frame info and features point into it */
+	FORCEINLINE const FMotionDatabasePayloadData& GetPayload() const { return *Payload; }
+
+	/** Shards whose frames are part of this snapshot, NAME_None stands for the frames that are not part of any shard */
+	FORCEINLINE const TArray<FName>& GetResidentShards() const { return ResidentShards; }
+	FORCEINLINE bool IsShardResident(const FName InContextName) const { return ResidentShards.Contains(InContextName); }
+
+	/** Whether the payload carries a transition graph, see FMotionTransitionGraph */
+	FORCEINLINE bool HasTransitionGraph() const { return NumSegments > 0; }
+
+	/** Frames the frame can plausibly jump to, empty without a transition graph. The list can be padded with INDEX_NONE */
+	TArrayView<const int32> GetTransitions(const int32 FrameIndex) const;
+
+	FORCEINLINE int32 GetNumSegments() const { return NumSegments; }
+	FORCEINLINE int32 GetTransitionsPerSegment() const { return TransitionsPerSegment; }
+
+	/** Frames the segment can jump to, padded with INDEX_NONE */
+	TArrayView<const int32> GetSegmentTransitions(const int32 SegmentIndex) const;
+
+	/** The latest frame of the animation that starts at or before the time, only tracked for snapshots with a transition graph */
+	int32 FindFrameIndex(const int32 AnimationIndex, const float Time, const bool bMirrored) const;
+
+	/** Whether the payload carries quantized features, see FMotionFeatureQuantization */
+	FORCEINLINE bool HasQuantizedFeatures() const { return CodebookSize > 0; }
+	FORCEINLINE int32 GetCodebookSize() const { return CodebookSize; }
+	FORCEINLINE int32 GetNumCodeGroups() const { return NumCodeGroups; }
+
+	/** CodebookSize entries of 3 floats */
+	FORCEINLINE const float* GetCodebook(const int32 GroupIndex) const { return Codebooks + GroupIndex * CodebookSize * 3; }
+
+	/** A byte per group */
+	FORCEINLINE const uint8* GetCodes(const int32 FrameIndex) const { return Codes + FrameIndex * NumCodeGroups; }
+
+	UAnimSequence* GetAnimation(const int32 AnimationIndex) const;
+	int32 FindAnimationIndex(const UAnimSequence* InAnimation) const;
+	const FRootMotionTrack* GetRootMotionTrack(const int32 AnimationIndex) const;
+
+	FORCEINLINE int32 GetNumAnimations() const { return Animations.Num(); }
+	FORCEINLINE const TArray<FName>& GetBones() const { return Bones; }
+	FORCEINLINE const FMotionMirrorTable& GetMirrorTable() const { return MirrorTable; }
+	FORCEINLINE uint32 GetVersion() const { return Version; }
+
+private:
+	FMotionDatabaseSnapshot();
+
+	/** Points the frame info and features into the payload, returns false when the payload is not valid */
+	bool InitializeFromPayload();
+
+	FMotionFeatureLayout Layout;
+	FMotionDatabasePayloadPtr Payload;
+	TArray<FName> ResidentShards;
+
+	const FMotionFrameInfo* Frames;
+	const float* Features;
+	int32 NumFrames;
+
+	const int32* FrameSegments;
+	const int32* Transitions;
+	int32 NumSegments;
+	int32 TransitionsPerSegment;
+
+	const float* Codebooks;
+	const uint8* Codes;
+	int32 CodebookSize;
+	int32 NumCodeGroups;
+
+	/** Frames of every animation sorted by time, keyed by the animation index and whether the frames are mirrored */
+	TMap<uint64, TArray<int32>> AnimationTracks;
+
+	/** The snapshot outlives the database it was built from on the reading threads, it must not keep the animations alive or point at collected ones */
+	TArray<TWeakObjectPtr<UAnimSequence>> Animations;
+	TArray<FRootMotionTrack> RootMotionTracks;
+	TArray<FName> Bones;
+	FMotionMirrorTable MirrorTable;
+
+	uint32 Version;
+};
@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionFeatureQuantization.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingQuery.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+
+namespace MotionFeatureQuantizationGlobals
+{
+	static int32 ApproximateSearch = 0;
+	static FAutoConsoleVariableRef CVarApproximateSearch(
+		TEXT("a.MotionMatching.ApproximateSearch"),
+		ApproximateSearch,
+		TEXT("Search animation databases that carry quantized features with the approximate search.\n")
+		TEXT("0: Always search the exact features (default)\n")
+		TEXT("1: Rank the candidates with the quantized features, and only compute the exact cost of the best ones"));
+
+	FORCEINLINE float SquaredDistance(const float* A, const float* B)
+	{
+		const float X = A[0] - B[0];
+		const float Y = A[1] - B[1];
+		const float Z = A[2] - B[2];
+		return X * X + Y * Y + Z * Z;
+	}
+
+	int32 FindClosestEntry(const float* Vector, const float* Codebook, const int32 CodebookSize)
+	{
+		int32 BestEntry = 0;
+		float BestDistance = BIG_NUMBER;
+		for (int32 EntryIndex = 0; EntryIndex < CodebookSize; ++EntryIndex)
+		{
+			const float Distance = SquaredDistance(Vector, Codebook + EntryIndex * 3);
+			if (Distance < BestDistance)
+			{
+				BestDistance = Distance;
+				BestEntry = EntryIndex;
+			}
+		}
+
+		return BestEntry;
+	}
+}
+
+
+bool FMotionFeatureQuantization::IsEnabled()
+{
+	return MotionFeatureQuantizationGlobals::ApproximateSearch != 0;
+}
+
+int32 FMotionFeatureQuantization::GetNumGroups(const FMotionFeatureLayout& InLayout)
+{
+	return InLayout.GetDimension() / 3;
+}
+
+void FMotionFeatureQuantization::Train(
+	const FMotionFeatureLayout& InLayout,
+	const float* InFeatures,
+	const int32 InNumFrames,
+	const int32 InTrainingIterations,
+	int32& OutCodebookSize,
+	TArray<float>& OutCodebooks)
+{
+	const int32 NumGroups = GetNumGroups(InLayout);
+	const int32 Stride = InLayout.GetStride();
+
+	OutCodebookSize = FMath::Min(InNumFrames, MaxCodebookSize);
+	OutCodebooks.SetNumZeroed(NumGroups * OutCodebookSize * 3);
+
+	if (OutCodebookSize == 0)
+	{
+		return;
+	}
+
+	const int32 CodebookSize = OutCodebookSize;
+
+	// The groups are independent of each other
+	ParallelFor(NumGroups, [&](int32 GroupIndex)
+	{
+		const int32 GroupOffset = GroupIndex * 3;
+		float* Codebook = OutCodebooks.GetData() + GroupIndex * CodebookSize * 3;
+
+		// Start from frames spread over the whole database, so the result does not depend on a random seed
+		for (int32 EntryIndex = 0; EntryIndex < CodebookSize; ++EntryIndex)
+		{
+			const int32 FrameIndex = (int32)((int64)EntryIndex * InNumFrames / CodebookSize);
+			FMemory::Memcpy(Codebook + EntryIndex * 3, InFeatures + FrameIndex * Stride + GroupOffset, 3 * sizeof(float));
+		}
+
+		TArray<int32> Assignments;
+		Assignments.SetNumUninitialized(InNumFrames);
+
+		TArray<double> Sums;
+		TArray<int32> Counts;
+
+		for (int32 Iteration = 0; Iteration < InTrainingIterations; ++Iteration)
+		{
+			// Assign every frame to its closest entry
+			for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+			{
+				Assignments[FrameIndex] = MotionFeatureQuantizationGlobals::FindClosestEntry(InFeatures + FrameIndex * Stride + GroupOffset, Codebook, CodebookSize);
+			}
+
+			// Move every entry to the mean of its frames, entries without frames stay where they are
+			Sums.Reset();
+			Sums.SetNumZeroed(CodebookSize * 3);
+			Counts.Reset();
+			Counts.SetNumZeroed(CodebookSize);
+
+			for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+			{
+				const float* Vector = InFeatures + FrameIndex * Stride + GroupOffset;
+				const int32 EntryIndex = Assignments[FrameIndex];
+
+				Sums[EntryIndex * 3 + 0] += Vector[0];
+				Sums[EntryIndex * 3 + 1] += Vector[1];
+				Sums[EntryIndex * 3 + 2] += Vector[2];
+				++Counts[EntryIndex];
+			}
+
+			for (int32 EntryIndex = 0; EntryIndex < CodebookSize; ++EntryIndex)
+			{
+				if (Counts[EntryIndex] > 0)
+				{
+					for (int32 Axis = 0; Axis < 3; ++Axis)
+					{
+						Codebook[EntryIndex * 3 + Axis] = (float)(Sums[EntryIndex * 3 + Axis] / Counts[EntryIndex]);
+					}
+				}
+			}
+		}
+	});
+}
+
+void FMotionFeatureQuantization::Encode(
+	const FMotionFeatureLayout& InLayout,
+	const float* InFeatures,
+	const int32 InNumFrames,
+	const int32 InCodebookSize,
+	const float* InCodebooks,
+	TArray<uint8>& OutCodes)
+{
+	const int32 NumGroups = GetNumGroups(InLayout);
+	const int32 Stride = InLayout.GetStride();
+
+	OutCodes.SetNumZeroed(InNumFrames * NumGroups);
+
+	if (InCodebookSize == 0)
+	{
+		return;
+	}
+
+	ParallelFor(NumGroups, [&](int32 GroupIndex)
+	{
+		const int32 GroupOffset = GroupIndex * 3;
+		const float* Codebook = InCodebooks + GroupIndex * InCodebookSize * 3;
+
+		for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+		{
+			const int32 EntryIndex = MotionFeatureQuantizationGlobals::FindClosestEntry(InFeatures + FrameIndex * Stride + GroupOffset, Codebook, InCodebookSize);
+			OutCodes[FrameIndex * NumGroups + GroupIndex] = (uint8)EntryIndex;
+		}
+	});
+}
+
+void FMotionQuantizedCostTable::Build(const FMotionDatabaseSnapshot& InSnapshot, const FMotionMatchingQuery& InQuery)
+{
+	const FMotionFeatureLayout& Layout = InSnapshot.GetLayout();
+	const int32 NumGroups = FMotionFeatureQuantization::GetNumGroups(Layout);
+
+	CodebookSize = InSnapshot.GetCodebookSize();
+	ActiveGroups.Reset();
+	Table.Reset(NumGroups * CodebookSize);
+
+	for (int32 GroupIndex = 0; GroupIndex < NumGroups; ++GroupIndex)
+	{
+		const int32 GroupOffset = GroupIndex * 3;
+
+		// Same terms as FMotionMatchingQuery::ComputeCost, per group
+		FVector Axis = FVector::OneVector;
+		float Scale = 1.0f;
+
+		if (GroupOffset >= Layout.GetTrajectoryOffset())
+		{
+			if (!InQuery.bTrajectoryMatching)
+			{
+				continue;
+			}
+
+			Axis = InQuery.TrajectoryPositionAxis;
+			Scale = InQuery.Responsiveness;
+		}
+		else if (GroupOffset >= Layout.GetBoneOffset(0))
+		{
+			if (!InQuery.bPoseMatching)
+			{
+				continue;
+			}
+
+			// Bone positions are masked, bone velocities are not
+			const bool bBonePosition = ((GroupOffset - Layout.GetBoneOffset(0)) % FMotionFeatureLayout::BoneDimension) == 0;
+			Axis = bBonePosition ? InQuery.BonePositionAxis : FVector::OneVector;
+		}
+
+		ActiveGroups.Add(GroupIndex);
+
+		const float* QueryVector = InQuery.Features.GetData() + GroupOffset;
+		const float* Codebook = InSnapshot.GetCodebook(GroupIndex);
+
+		for (int32 EntryIndex = 0; EntryIndex < CodebookSize; ++EntryIndex)
+		{
+			const float* Entry = Codebook + EntryIndex * 3;
+			const float X = (QueryVector[0] - Entry[0]) * Axis.X;
+			const float Y = (QueryVector[1] - Entry[1]) * Axis.Y;
+			const float Z = (QueryVector[2] - Entry[2]) * Axis.Z;
+
+			Table.Add(Scale * FMath::Sqrt(X * X + Y * Y + Z * Z));
+		}
+	}
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MotionFeatureQuantization.generated.h"
+
+struct FMotionFeatureLayout;
+struct FMotionMatchingQuery;
+class FMotionDatabaseSnapshot;
+
+/**
+ * Product quantization of the search matrix for the approximate search.
+ * Every feature is a 3D vector (velocity, bone position, bone velocity, trajectory point) and the cost is a sum of distances
+ * between those vectors, so every vector gets its own codebook and is stored as a single byte. The cost of a candidate is then
+ * a sum of table lookups, one per vector, see FMotionQuantizedCostTable.
+ */
+USTRUCT()
+struct MOTIONMATCHING_API FMotionFeatureQuantizationSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FMotionFeatureQuantizationSettings()
+		: bQuantizeFeatures(false)
+		, TrainingIterations(8)
+	{
+	}
+
+	/** Store byte codes of the features in the search payload, so the approximate search can be used on this database */
+	UPROPERTY(EditAnywhere, Category = "Quantization")
+	bool bQuantizeFeatures;
+
+	/** K-means iterations when training the codebooks, more iterations give better codebooks and slower bakes */
+	UPROPERTY(EditAnywhere, Category = "Quantization", meta = (ClampMin = 1, EditCondition = "bQuantizeFeatures"))
+	int32 TrainingIterations;
+};
+
+class MOTIONMATCHING_API FMotionFeatureQuantization
+{
+public:
+	/** Entries per codebook, a code is a single byte */
+	static const int32 MaxCodebookSize = 256;
+
+	/** Whether the approximate search should be used for snapshots that carry codes, see a.MotionMatching.ApproximateSearch */
+	static bool IsEnabled();
+
+	/** Number of 3D vectors in a row, every one of them has a codebook */
+	static int32 GetNumGroups(const FMotionFeatureLayout& InLayout);
+
+	/** Trains a codebook per group with k-means, OutCodebooks holds OutCodebookSize * 3 floats per group */
+	static void Train(
+		const FMotionFeatureLayout& InLayout,
+		const float* InFeatures,
+		const int32 InNumFrames,
+		const int32 InTrainingIterations,
+		int32& OutCodebookSize,
+		TArray<float>& OutCodebooks);
+
+	/** Encodes every frame with the closest entry of the codebook of each group, OutCodes holds a byte per group per frame */
+	static void Encode(
+		const FMotionFeatureLayout& InLayout,
+		const float* InFeatures,
+		const int32 InNumFrames,
+		const int32 InCodebookSize,
+		const float* InCodebooks,
+		TArray<uint8>& OutCodes);
+};
+
+/**
+ * Asymmetric distance table of a single query: the exact query against every codebook entry.
+ * Groups that do not contribute to the cost (pose matching or trajectory matching disabled) are left out.
+ */
+struct MOTIONMATCHING_API FMotionQuantizedCostTable
+{
+public:
+	FMotionQuantizedCostTable()
+		: CodebookSize(0)
+	{
+	}
+
+	void Build(const FMotionDatabaseSnapshot& InSnapshot, const FMotionMatchingQuery& InQuery);
+
+	FORCEINLINE float ComputeCost(const uint8* InCodes) const
+	{
+		float Cost = 0.0f;
+		for (int32 ActiveIndex = 0; ActiveIndex < ActiveGroups.Num(); ++ActiveIndex)
+		{
+			Cost += Table[ActiveIndex * CodebookSize + InCodes[ActiveGroups[ActiveIndex]]];
+		}
+
+		return Cost;
+	}
+
+private:
+	int32 CodebookSize;
+
+	/** Groups that are part of the cost, the table has CodebookSize entries per active group */
+	TArray<int32, TInlineAllocator<64>> ActiveGroups;
+	TArray<float> Table;
+};
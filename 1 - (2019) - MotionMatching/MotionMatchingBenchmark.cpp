@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingBenchmark.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingQuery.h"
+#include "MotionMatchingUtilities.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+
+
+namespace MotionMatchingBenchmarkGlobals
+{
+	// Same seed every run, so runs with different settings are measured with the same queries
+	const int32 RandomSeed = 0x4D4D;
+
+	// Fraction of the range of a dimension that is added as noise, a query that exactly matches a frame is not representative
+	const float QueryNoise = 0.05f;
+
+	// Rerank depths of the approximate search, to show how much exact work buys how much recall
+	const int32 RerankDepths[] = { 1, 4, 16, 64 };
+
+	FORCEINLINE bool IsSameCost(const float Cost, const float BruteForceCost)
+	{
+		// Compare costs instead of indices, frames with the same cost are equally good answers
+		return FMath::IsNearlyEqual(Cost, BruteForceCost, KINDA_SMALL_NUMBER * FMath::Max(1.0f, BruteForceCost));
+	}
+}
+
+
+void FMotionMatchingBenchmark::Run(const FMotionDatabaseSnapshot& InSnapshot, const int32 InNumQueries, FMotionMatchingBenchmarkResult& OutResult)
+{
+	OutResult = FMotionMatchingBenchmarkResult();
+
+	const int32 NumFrames = InSnapshot.Num();
+	if (NumFrames == 0 || InNumQueries <= 0)
+	{
+		return;
+	}
+
+	const FMotionFeatureLayout& Layout = InSnapshot.GetLayout();
+	const int32 Dimension = Layout.GetDimension();
+
+	// Scale the noise per dimension, positions and velocities have very different ranges
+	TArray<float> NoiseScale;
+	NoiseScale.SetNumZeroed(Dimension);
+	for (int32 Dim = 0; Dim < Dimension; ++Dim)
+	{
+		FMotionFeatureDistribution Distribution;
+		ComputeFeatureDistribution(InSnapshot, Dim, 0, Distribution);
+		NoiseScale[Dim] = (Distribution.Max - Distribution.Min) * MotionMatchingBenchmarkGlobals::QueryNoise;
+	}
+
+	FRandomStream RandomStream(MotionMatchingBenchmarkGlobals::RandomSeed);
+
+	TArray<FMotionMatchingQuery> Queries;
+	Queries.SetNum(InNumQueries);
+
+	for (FMotionMatchingQuery& Query : Queries)
+	{
+		Query.BuildFromFeatures(Layout, InSnapshot.GetFeatures(RandomStream.RandHelper(NumFrames)));
+
+		for (int32 Dim = 0; Dim < Dimension; ++Dim)
+		{
+			Query.Features[Dim] += RandomStream.FRandRange(-NoiseScale[Dim], NoiseScale[Dim]);
+		}
+	}
+
+	TArray<float> BruteForceCosts;
+	BruteForceCosts.SetNumUninitialized(InNumQueries);
+
+	const double BruteForceStart = FPlatformTime::Seconds();
+
+	for (int32 QueryIndex = 0; QueryIndex < InNumQueries; ++QueryIndex)
+	{
+		float BestCost = BIG_NUMBER;
+		for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			BestCost = FMath::Min(BestCost, Queries[QueryIndex].ComputeCost(InSnapshot.GetFeatures(FrameIndex)));
+		}
+
+		BruteForceCosts[QueryIndex] = BestCost;
+	}
+
+	const double AcceleratedStart = FPlatformTime::Seconds();
+
+	int32 NumAgreements = 0;
+	for (int32 QueryIndex = 0; QueryIndex < InNumQueries; ++QueryIndex)
+	{
+		int BestIndex = INDEX_NONE;
+		float BestCost = BIG_NUMBER;
+		UMotionMatchingUtilities::GetLowestCostAnimation(InSnapshot, Queries[QueryIndex], BestIndex, BestCost);
+
+		if (MotionMatchingBenchmarkGlobals::IsSameCost(BestCost, BruteForceCosts[QueryIndex]))
+		{
+			++NumAgreements;
+		}
+	}
+
+	const double End = FPlatformTime::Seconds();
+
+	OutResult.NumQueries = InNumQueries;
+	OutResult.BruteForceNanoseconds = (AcceleratedStart - BruteForceStart) * 1e9 / InNumQueries;
+	OutResult.AcceleratedNanoseconds = (End - AcceleratedStart) * 1e9 / InNumQueries;
+	OutResult.Agreement = (float)NumAgreements / InNumQueries;
+
+	if (!InSnapshot.HasQuantizedFeatures())
+	{
+		return;
+	}
+
+	TArray<FMotionMatchingCandidate> Candidates;
+
+	for (const int32 NumRerankCandidates : MotionMatchingBenchmarkGlobals::RerankDepths)
+	{
+		int32 NumFound = 0;
+		const double ApproximateStart = FPlatformTime::Seconds();
+
+		for (int32 QueryIndex = 0; QueryIndex < InNumQueries; ++QueryIndex)
+		{
+			UMotionMatchingUtilities::GetLowestCostAnimationsApproximate(InSnapshot, Queries[QueryIndex], 1, NumRerankCandidates, Candidates);
+
+			if (Candidates.Num() > 0 && MotionMatchingBenchmarkGlobals::IsSameCost(Candidates[0].Cost, BruteForceCosts[QueryIndex]))
+			{
+				++NumFound;
+			}
+		}
+
+		FMotionMatchingApproximateResult& ApproximateResult = OutResult.Approximate.AddDefaulted_GetRef();
+		ApproximateResult.NumRerankCandidates = NumRerankCandidates;
+		ApproximateResult.Nanoseconds = (FPlatformTime::Seconds() - ApproximateStart) * 1e9 / InNumQueries;
+		ApproximateResult.Recall = (float)NumFound / InNumQueries;
+	}
+}
+
+void FMotionMatchingBenchmark::ComputeFeatureDistribution(const FMotionDatabaseSnapshot& InSnapshot, const int32 InDimension, const int32 InNumBins, FMotionFeatureDistribution& OutDistribution)
+{
+	OutDistribution = FMotionFeatureDistribution();
+
+	const int32 NumFrames = InSnapshot.Num();
+	if (NumFrames == 0 || InDimension < 0 || InDimension >= InSnapshot.GetLayout().GetDimension())
+	{
+		return;
+	}
+
+	OutDistribution.Min = BIG_NUMBER;
+	OutDistribution.Max = -BIG_NUMBER;
+
+	double Sum = 0.0;
+	double SumSquared = 0.0;
+
+	for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+	{
+		const float Value = InSnapshot.GetFeatures(FrameIndex)[InDimension];
+		OutDistribution.Min = FMath::Min(OutDistribution.Min, Value);
+		OutDistribution.Max = FMath::Max(OutDistribution.Max, Value);
+		Sum += Value;
+		SumSquared += Value * Value;
+	}
+
+	OutDistribution.Mean = Sum / NumFrames;
+	OutDistribution.StandardDeviation = FMath::Sqrt(FMath::Max(0.0, SumSquared / NumFrames - FMath::Square(Sum / NumFrames)));
+
+	if (InNumBins > 0)
+	{
+		OutDistribution.Histogram.SetNumZeroed(InNumBins);
+
+		const float Range = OutDistribution.Max - OutDistribution.Min;
+		for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+		{
+			const float Value = InSnapshot.GetFeatures(FrameIndex)[InDimension];
+			const int32 Bin = Range > 0.0f ? FMath::Min(FMath::FloorToInt((Value - OutDistribution.Min) / Range * InNumBins), InNumBins - 1) : 0;
+			++OutDistribution.Histogram[Bin];
+		}
+	}
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FMotionDatabaseSnapshot;
+
+/** Approximate search at a single rerank depth */
+struct FMotionMatchingApproximateResult
+{
+	FMotionMatchingApproximateResult()
+		: NumRerankCandidates(0)
+		, Nanoseconds(0.0)
+		, Recall(0.0f)
+	{
+	}
+
+	/** Candidates of the quantized ranking that get their exact cost computed */
+	int32 NumRerankCandidates;
+
+	double Nanoseconds;
+
+	/** Fraction of the queries where the approximate search found a frame with the brute force cost */
+	float Recall;
+};
+
+/** Timings of a benchmark run, in nanoseconds per query */
+struct FMotionMatchingBenchmarkResult
+{
+	FMotionMatchingBenchmarkResult()
+		: NumQueries(0)
+		, BruteForceNanoseconds(0.0)
+		, AcceleratedNanoseconds(0.0)
+		, Agreement(0.0f)
+	{
+	}
+
+	int32 NumQueries;
+
+	/** Every term of every candidate */
+	double BruteForceNanoseconds;
+
+	/** The search the node uses */
+	double AcceleratedNanoseconds;
+
+	/** Fraction of the queries where both searches found a frame with the same cost */
+	float Agreement;
+
+	/** One entry per rerank depth, empty when the snapshot has no quantized features */
+	TArray<FMotionMatchingApproximateResult> Approximate;
+};
+
+/** Distribution of a single feature dimension over all frames of a snapshot */
+struct FMotionFeatureDistribution
+{
+	FMotionFeatureDistribution()
+		: Min(0.0f)
+		, Max(0.0f)
+		, Mean(0.0f)
+		, StandardDeviation(0.0f)
+	{
+	}
+
+	float Min;
+	float Max;
+	float Mean;
+	float StandardDeviation;
+
+	/** Number of frames per bin, the bins split [Min, Max] evenly */
+	TArray<int32> Histogram;
+};
+
+/**
+ * Measures the search of a snapshot with queries taken from its own frames (with a bit of noise),
+ * so the numbers reflect the data that is actually in the database.
+ */
+class MOTIONMATCHING_API FMotionMatchingBenchmark
+{
+public:
+	static void Run(const FMotionDatabaseSnapshot& InSnapshot, const int32 InNumQueries, FMotionMatchingBenchmarkResult& OutResult);
+
+	static void ComputeFeatureDistribution(const FMotionDatabaseSnapshot& InSnapshot, const int32 InDimension, const int32 InNumBins, FMotionFeatureDistribution& OutDistribution);
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Axis vectors the cost kernels are specialized for, see TMotionCostKernel */
+enum class EMotionAxisMask : uint8
+{
+	/** (1, 1, 1) */
+	XYZ,
+	/** (1, 1, 0), distances on the ground plane */
+	XY,
+	/** Any other axis vector, every axis is scaled by its weight */
+	Weighted
+};
+
+/**
+ * The cost terms of motion matching, on three floats at a time.
+ * The cost of a frame (UMotionMatchingUtilities::ComputeCost), of a row of the search matrix (FMotionMatchingQuery)
+ * and the specialized kernels (TMotionCostKernel) are all made of these, so the three cannot give different costs.
+ */
+struct FMotionMatchingCost
+{
+	/** Distance with every axis scaled by its weight, the mask only lets the compiler skip the axes that do not apply */
+	template<EMotionAxisMask AxisMask>
+	static FORCEINLINE float MaskedDistance(const float* A, const float* B, const FVector& AxisWeights)
+	{
+		const float X = A[0] - B[0];
+		const float Y = A[1] - B[1];
+
+		if (AxisMask == EMotionAxisMask::XY)
+		{
+			return FMath::Sqrt(X * X + Y * Y);
+		}
+
+		const float Z = A[2] - B[2];
+
+		if (AxisMask == EMotionAxisMask::XYZ)
+		{
+			return FMath::Sqrt(X * X + Y * Y + Z * Z);
+		}
+
+		const float WeightedX = X * AxisWeights.X;
+		const float WeightedY = Y * AxisWeights.Y;
+		const float WeightedZ = Z * AxisWeights.Z;
+		return FMath::Sqrt(WeightedX * WeightedX + WeightedY * WeightedY + WeightedZ * WeightedZ);
+	}
+
+	static FORCEINLINE float Distance(const float* A, const float* B)
+	{
+		return MaskedDistance<EMotionAxisMask::XYZ>(A, B, FVector::OneVector);
+	}
+
+	static FORCEINLINE float WeightedDistance(const float* A, const float* B, const FVector& AxisWeights)
+	{
+		return MaskedDistance<EMotionAxisMask::Weighted>(A, B, AxisWeights);
+	}
+
+	/** Bone positions are compared on the axes of the mask, bone velocities on all of them */
+	template<EMotionAxisMask AxisMask>
+	static FORCEINLINE float BoneCost(const float* PositionA, const float* VelocityA, const float* PositionB, const float* VelocityB, const FVector& PositionAxisWeights)
+	{
+		return MaskedDistance<AxisMask>(PositionA, PositionB, PositionAxisWeights) + Distance(VelocityA, VelocityB);
+	}
+
+	static FORCEINLINE float BoneCost(const FVector& PositionA, const FVector& VelocityA, const FVector& PositionB, const FVector& VelocityB, const FVector& PositionAxisWeights)
+	{
+		return BoneCost<EMotionAxisMask::Weighted>(&PositionA.X, &VelocityA.X, &PositionB.X, &VelocityB.X, PositionAxisWeights);
+	}
+
+	static FORCEINLINE float TrajectoryPointCost(const FVector& LocationA, const FVector& LocationB, const FVector& AxisWeights)
+	{
+		return WeightedDistance(&LocationA.X, &LocationB.X, AxisWeights);
+	}
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/IntegralConstant.h"
+#include "MotionMatchingQuery.h"
+#include "MotionMatchingCost.h"
+
+/**
+ * Cost of a candidate row, specialized at compile time for the axis masks and the terms of a query.
+ * A query picks its kernel once (see DispatchCostKernel), so the loop over the candidates has no branches on settings
+ * that are the same for every candidate, and axes that are masked out are not computed at all.
+ * Same terms as FMotionMatchingQuery::ComputeCost (see FMotionMatchingCost), cheapest first, and stops adding terms as soon as the cost exceeds the bound.
+ * The returned value is only exact when it is lower than or equal to the bound.
+ */
+template<EMotionAxisMask BoneAxisMask, EMotionAxisMask TrajectoryAxisMask, bool bPoseMatching, bool bTrajectoryMatching>
+struct TMotionCostKernel
+{
+	static FORCEINLINE float ComputeCostBounded(const FMotionMatchingQuery& Query, const float* CandidateFeatures, const float CostBound)
+	{
+		const FMotionFeatureLayout& Layout = Query.Layout;
+		const float* QueryFeatures = Query.Features.GetData();
+
+		float Cost = FMotionMatchingCost::Distance(CandidateFeatures + Layout.GetVelocityOffset(), QueryFeatures + Layout.GetVelocityOffset());
+		if (Cost > CostBound)
+		{
+			return Cost;
+		}
+
+		if (bTrajectoryMatching)
+		{
+			float TrajectoryCost = 0.0f;
+			for (int32 PointIndex = 0; PointIndex < Layout.NumTrajectoryPoints; ++PointIndex)
+			{
+				const int32 PointOffset = Layout.GetTrajectoryOffset(PointIndex);
+				TrajectoryCost += FMotionMatchingCost::MaskedDistance<TrajectoryAxisMask>(CandidateFeatures + PointOffset, QueryFeatures + PointOffset, Query.TrajectoryPositionAxis);
+			}
+
+			Cost += Query.Responsiveness * TrajectoryCost;
+			if (Cost > CostBound)
+			{
+				return Cost;
+			}
+		}
+
+		if (bPoseMatching)
+		{
+			for (int32 BoneIndex = 0; BoneIndex < Layout.NumBones; ++BoneIndex)
+			{
+				const int32 BoneOffset = Layout.GetBoneOffset(BoneIndex);
+				Cost += FMotionMatchingCost::BoneCost<BoneAxisMask>(CandidateFeatures + BoneOffset, CandidateFeatures + BoneOffset + 3, QueryFeatures + BoneOffset, QueryFeatures + BoneOffset + 3, Query.BonePositionAxis);
+			}
+		}
+
+		return Cost;
+	}
+};
+
+namespace MotionMatchingCostKernels
+{
+	template<typename FunctorType>
+	FORCEINLINE void DispatchAxisMask(const EMotionAxisMask AxisMask, FunctorType&& Functor)
+	{
+		switch (AxisMask)
+		{
+		case EMotionAxisMask::XYZ:	Functor(TIntegralConstant<EMotionAxisMask, EMotionAxisMask::XYZ>()); break;
+		case EMotionAxisMask::XY:	Functor(TIntegralConstant<EMotionAxisMask, EMotionAxisMask::XY>()); break;
+		default:					Functor(TIntegralConstant<EMotionAxisMask, EMotionAxisMask::Weighted>()); break;
+		}
+	}
+
+	template<typename FunctorType>
+	FORCEINLINE void DispatchBool(const bool bValue, FunctorType&& Functor)
+	{
+		if (bValue)
+		{
+			Functor(TIntegralConstant<bool, true>());
+		}
+		else
+		{
+			Functor(TIntegralConstant<bool, false>());
+		}
+	}
+}
+
+/**
+ * Calls the functor with the kernel that matches the settings of the query, Functor(TMotionCostKernel<...>()).
+ * Every combination is instantiated for the functor, so this is meant to wrap a whole search loop, not a single candidate.
+ */
+template<typename FunctorType>
+void DispatchCostKernel(const FMotionMatchingQuery& Query, FunctorType&& Functor)
+{
+	using namespace MotionMatchingCostKernels;
+
+	DispatchAxisMask(Query.BoneAxisMask, [&](auto BoneAxisMask)
+	{
+		DispatchAxisMask(Query.TrajectoryAxisMask, [&](auto TrajectoryAxisMask)
+		{
+			DispatchBool(Query.bPoseMatching, [&](auto bPoseMatching)
+			{
+				DispatchBool(Query.bTrajectoryMatching, [&](auto bTrajectoryMatching)
+				{
+					Functor(TMotionCostKernel<decltype(BoneAxisMask)::Value, decltype(TrajectoryAxisMask)::Value, decltype(bPoseMatching)::Value, decltype(bTrajectoryMatching)::Value>());
+				});
+			});
+		});
+	});
+}
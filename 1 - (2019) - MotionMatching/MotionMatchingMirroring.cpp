@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingMirroring.h"
+#include "AnimationFrameData.h"
+#include "MotionMatchingUtilities.h"
+#include "Animation/Skeleton.h"
+
+
+FMotionMirrorTable::FMotionMirrorTable()
+	: MirrorAxis(EAxis::None)
+{
+}
+
+void FMotionMirrorTable::Build(const USkeleton* InSkeleton, const TArray<FMotionMirrorBonePair>& InBonePairs, const TArray<FName>& InFeatureBones, const EAxis::Type InMirrorAxis)
+{
+	MirrorAxis = InMirrorAxis;
+	SkeletonMirrorIndices.Empty();
+	ReferenceRotations.Empty();
+	FeatureMirrorIndices.Empty();
+
+	if (!InSkeleton || InMirrorAxis == EAxis::None)
+	{
+		return;
+	}
+
+	const FReferenceSkeleton& ReferenceSkeleton = InSkeleton->GetReferenceSkeleton();
+	const TArray<FTransform>& ReferencePose = ReferenceSkeleton.GetRefBonePose();
+	const int32 NumBones = ReferenceSkeleton.GetNum();
+
+	// Every bone mirrors onto itself unless it is part of a pair
+	SkeletonMirrorIndices.SetNum(NumBones);
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		SkeletonMirrorIndices[BoneIndex] = BoneIndex;
+	}
+
+	for (const FMotionMirrorBonePair& BonePair : InBonePairs)
+	{
+		const int32 BoneIndex = ReferenceSkeleton.FindBoneIndex(BonePair.BoneName);
+		const int32 MirroredBoneIndex = ReferenceSkeleton.FindBoneIndex(BonePair.MirroredBoneName);
+
+		if (BoneIndex != INDEX_NONE && MirroredBoneIndex != INDEX_NONE)
+		{
+			SkeletonMirrorIndices[BoneIndex] = MirroredBoneIndex;
+			SkeletonMirrorIndices[MirroredBoneIndex] = BoneIndex;
+		}
+	}
+
+	// Bones are sorted parent first, so the parent is always resolved before its children
+	TArray<FTransform> ReferenceComponentSpace;
+	ReferenceComponentSpace.SetNum(NumBones);
+	ReferenceRotations.SetNum(NumBones);
+
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		const int32 ParentIndex = ReferenceSkeleton.GetParentIndex(BoneIndex);
+		ReferenceComponentSpace[BoneIndex] = (ParentIndex != INDEX_NONE) ? ReferencePose[BoneIndex] * ReferenceComponentSpace[ParentIndex] : ReferencePose[BoneIndex];
+		ReferenceRotations[BoneIndex] = ReferenceComponentSpace[BoneIndex].GetRotation();
+	}
+
+	FeatureMirrorIndices.SetNum(InFeatureBones.Num());
+	for (int32 FeatureIndex = 0; FeatureIndex < InFeatureBones.Num(); ++FeatureIndex)
+	{
+		FeatureMirrorIndices[FeatureIndex] = FeatureIndex;
+
+		const int32 BoneIndex = ReferenceSkeleton.FindBoneIndex(InFeatureBones[FeatureIndex]);
+		if (BoneIndex != INDEX_NONE)
+		{
+			const FName MirroredBoneName = ReferenceSkeleton.GetBoneName(SkeletonMirrorIndices[BoneIndex]);
+			const int32 MirroredFeatureIndex = InFeatureBones.IndexOfByKey(MirroredBoneName);
+
+			if (MirroredFeatureIndex != INDEX_NONE)
+			{
+				FeatureMirrorIndices[FeatureIndex] = MirroredFeatureIndex;
+			}
+		}
+	}
+}
+
+FVector FMotionMirrorTable::MirrorVector(const FVector& InVector) const
+{
+	FVector Result = InVector;
+
+	switch (MirrorAxis)
+	{
+	case EAxis::X: Result.X = -Result.X; break;
+	case EAxis::Y: Result.Y = -Result.Y; break;
+	case EAxis::Z: Result.Z = -Result.Z; break;
+	default: break;
+	}
+
+	return Result;
+}
+
+FQuat FMotionMirrorTable::MirrorQuat(const FQuat& InQuat) const
+{
+	// Reflecting a rotation over a plane keeps the component along the plane normal and flips the other two
+	switch (MirrorAxis)
+	{
+	case EAxis::X: return FQuat(InQuat.X, -InQuat.Y, -InQuat.Z, InQuat.W);
+	case EAxis::Y: return FQuat(-InQuat.X, InQuat.Y, -InQuat.Z, InQuat.W);
+	case EAxis::Z: return FQuat(-InQuat.X, -InQuat.Y, InQuat.Z, InQuat.W);
+	default: return InQuat;
+	}
+}
+
+FTransform FMotionMirrorTable::MirrorTransform(const FTransform& InTransform) const
+{
+	return FTransform(MirrorQuat(InTransform.GetRotation()), MirrorVector(InTransform.GetTranslation()), InTransform.GetScale3D());
+}
+
+uint32 FMotionMirrorTable::GetFeatureHash() const
+{
+	if (!IsValid())
+	{
+		return 0;
+	}
+
+	// Mirroring features only depends on the axis and on which feature bones swap, the pose data is not part of the features
+	uint32 Hash = GetTypeHash((int32)MirrorAxis);
+	for (const int32 FeatureMirrorIndex : FeatureMirrorIndices)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(FeatureMirrorIndex));
+	}
+
+	return Hash;
+}
+
+void FMotionMirrorTable::MirrorBoneData(TArray<FMotionBoneData>& InOutBonesData) const
+{
+	if (InOutBonesData.Num() != FeatureMirrorIndices.Num())
+	{
+		return;
+	}
+
+	const TArray<FMotionBoneData> SourceBonesData = InOutBonesData;
+
+	for (int32 FeatureIndex = 0; FeatureIndex < InOutBonesData.Num(); ++FeatureIndex)
+	{
+		const FMotionBoneData& SourceBoneData = SourceBonesData[FeatureMirrorIndices[FeatureIndex]];
+		InOutBonesData[FeatureIndex].BonePosition = MirrorVector(SourceBoneData.BonePosition);
+		InOutBonesData[FeatureIndex].BoneVelocity = MirrorVector(SourceBoneData.BoneVelocity);
+	}
+}
+
+void FMotionMirrorTable::MirrorFrameData(FAnimationFrameData& InOutFrameData) const
+{
+	InOutFrameData.bMirrored = !InOutFrameData.bMirrored;
+	InOutFrameData.MotionVelocity = MirrorVector(InOutFrameData.MotionVelocity);
+	InOutFrameData.AnimationTransform = MirrorTransform(InOutFrameData.AnimationTransform);
+
+	MirrorBoneData(InOutFrameData.MotionBonesData);
+
+	const FMotionTrajectory SourceTrajectory = InOutFrameData.MotionTrajectory;
+	InOutFrameData.MotionTrajectory.Reset();
+
+	for (int32 PointIndex = 0; PointIndex < SourceTrajectory.Num(); ++PointIndex)
+	{
+		InOutFrameData.MotionTrajectory.Add(MirrorVector(SourceTrajectory.GetLocation(PointIndex)), MirrorQuat(SourceTrajectory.GetRotation(PointIndex)), SourceTrajectory.GetTime(PointIndex));
+	}
+}
+
+void FMotionMirrorTable::MirrorPose(FCompactPose& InOutPose) const
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	const FBoneContainer& BoneContainer = InOutPose.GetBoneContainer();
+	const int32 NumBones = InOutPose.GetNumBones();
+
+	// Mirroring has to happen in component space, local bone axes are generally not symmetric
+	TArray<FTransform, TInlineAllocator<128>> ComponentSpace;
+	ComponentSpace.SetNumUninitialized(NumBones);
+
+	for (const FCompactPoseBoneIndex BoneIndex : InOutPose.ForEachBoneIndex())
+	{
+		const FCompactPoseBoneIndex ParentIndex = InOutPose.GetParentBoneIndex(BoneIndex);
+		ComponentSpace[BoneIndex.GetInt()] = (ParentIndex != INDEX_NONE) ? InOutPose[BoneIndex] * ComponentSpace[ParentIndex.GetInt()] : InOutPose[BoneIndex];
+	}
+
+	TArray<FTransform, TInlineAllocator<128>> MirroredComponentSpace;
+	MirroredComponentSpace.SetNumUninitialized(NumBones);
+
+	for (const FCompactPoseBoneIndex BoneIndex : InOutPose.ForEachBoneIndex())
+	{
+		const int32 SkeletonIndex = BoneContainer.GetSkeletonIndex(BoneIndex);
+
+		int32 SourceSkeletonIndex = SkeletonMirrorIndices.IsValidIndex(SkeletonIndex) ? SkeletonMirrorIndices[SkeletonIndex] : SkeletonIndex;
+		FCompactPoseBoneIndex SourceIndex = BoneContainer.GetCompactPoseIndexFromSkeletonIndex(SourceSkeletonIndex);
+
+		// The mirrored bone might not be part of this LOD
+		if (SourceIndex == INDEX_NONE)
+		{
+			SourceIndex = BoneIndex;
+			SourceSkeletonIndex = SkeletonIndex;
+		}
+
+		const FTransform& SourceTM = ComponentSpace[SourceIndex.GetInt()];
+
+		// Correct for the difference between the mirrored reference pose and the actual reference pose of this bone
+		FQuat Rotation = MirrorQuat(SourceTM.GetRotation());
+		if (ReferenceRotations.IsValidIndex(SkeletonIndex) && ReferenceRotations.IsValidIndex(SourceSkeletonIndex))
+		{
+			Rotation = Rotation * (MirrorQuat(ReferenceRotations[SourceSkeletonIndex]).Inverse() * ReferenceRotations[SkeletonIndex]);
+		}
+
+		MirroredComponentSpace[BoneIndex.GetInt()] = FTransform(Rotation, MirrorVector(SourceTM.GetTranslation()), SourceTM.GetScale3D());
+	}
+
+	for (const FCompactPoseBoneIndex BoneIndex : InOutPose.ForEachBoneIndex())
+	{
+		const FCompactPoseBoneIndex ParentIndex = InOutPose.GetParentBoneIndex(BoneIndex);
+		const FTransform& MirroredTM = MirroredComponentSpace[BoneIndex.GetInt()];
+
+		InOutPose[BoneIndex] = (ParentIndex != INDEX_NONE) ? MirroredTM.GetRelativeTransform(MirroredComponentSpace[ParentIndex.GetInt()]) : MirroredTM;
+	}
+
+	InOutPose.NormalizeRotations();
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BonePose.h"
+#include "MotionMatchingMirroring.generated.h"
+
+class USkeleton;
+struct FAnimationFrameData;
+struct FMotionBoneData;
+
+/** Maps a bone to the bone on the opposite side of the skeleton, for example hand_l to hand_r */
+USTRUCT(BlueprintType)
+struct MOTIONMATCHING_API FMotionMirrorBonePair
+{
+	GENERATED_USTRUCT_BODY()
+
+	FMotionMirrorBonePair()
+		: BoneName(NAME_None)
+		, MirroredBoneName(NAME_None)
+	{
+	}
+
+	UPROPERTY(Category = "Mirroring", EditAnywhere, BlueprintReadWrite)
+	FName BoneName;
+
+	UPROPERTY(Category = "Mirroring", EditAnywhere, BlueprintReadWrite)
+	FName MirroredBoneName;
+};
+
+/**
+ * Everything needed to mirror baked features and evaluated poses, built once from the skeleton and the bone mapping.
+ * Bones without a pair are mirrored onto themselves.
+ */
+class MOTIONMATCHING_API FMotionMirrorTable
+{
+public:
+	FMotionMirrorTable();
+
+	void Build(const USkeleton* InSkeleton, const TArray<FMotionMirrorBonePair>& InBonePairs, const TArray<FName>& InFeatureBones, const EAxis::Type InMirrorAxis);
+
+	bool IsValid() const { return MirrorAxis != EAxis::None && SkeletonMirrorIndices.Num() > 0; }
+
+	/** Mirrors the features of a baked frame, the frame keeps referencing the original animation */
+	void MirrorFrameData(FAnimationFrameData& InOutFrameData) const;
+
+	/** Mirrors bone features that were extracted for the feature bones of the database */
+	void MirrorBoneData(TArray<FMotionBoneData>& InOutBonesData) const;
+
+	/** Mirrors a local space pose that was evaluated from an unmirrored animation */
+	void MirrorPose(FCompactPose& InOutPose) const;
+
+	FVector MirrorVector(const FVector& InVector) const;
+	FQuat MirrorQuat(const FQuat& InQuat) const;
+	FTransform MirrorTransform(const FTransform& InTransform) const;
+
+	/** Hash of everything that changes the mirrored features, used to key baked data */
+	uint32 GetFeatureHash() const;
+
+private:
+	EAxis::Type MirrorAxis;
+
+	/** Skeleton bone index to the skeleton bone index on the other side */
+	TArray<int32> SkeletonMirrorIndices;
+
+	/** Reference pose rotations in component space, per skeleton bone */
+	TArray<FQuat> ReferenceRotations;
+
+	/** Index in the feature bone list to the index of the feature bone on the other side */
+	TArray<int32> FeatureMirrorIndices;
+};
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingPoseCache.h"
+#include "Animation/AnimSequence.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("MotionMatching"), STATGROUP_MotionMatching, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pose Cache Hits"), STAT_MotionMatchingPoseCacheHits, STATGROUP_MotionMatching);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pose Cache Misses"), STAT_MotionMatchingPoseCacheMisses, STATGROUP_MotionMatching);
+
+namespace PoseCacheGlobals
+{
+	static int32 EnablePoseCache = 0;
+	static FAutoConsoleVariableRef CVarEnablePoseCache(
+		TEXT("a.MotionMatching.PoseCache"),
+		EnablePoseCache,
+		TEXT("Share decompressed poses between motion matching nodes that evaluate the same animation at the same time.\n")
+		TEXT("0: Disabled (default)\n")
+		TEXT("1: Enabled"));
+
+	static int32 MaxEntries = 256;
+	static FAutoConsoleVariableRef CVarMaxEntries(
+		TEXT("a.MotionMatching.PoseCache.MaxEntries"),
+		MaxEntries,
+		TEXT("The maximum number of poses the motion matching pose cache holds per frame."));
+
+	static float TimeQuantization = 1.0f / 120.0f;
+	static FAutoConsoleVariableRef CVarTimeQuantization(
+		TEXT("a.MotionMatching.PoseCache.TimeQuantization"),
+		TimeQuantization,
+		TEXT("Animation times within this step (in seconds) share the same cached pose."));
+
+	static FAutoConsoleCommand CmdDumpStats(
+		TEXT("a.MotionMatching.PoseCache.Stats"),
+		TEXT("Prints the hit and miss counts of the motion matching pose cache."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			const FMotionMatchingPoseCache& Cache = FMotionMatchingPoseCache::Get();
+			UE_LOG(LogAnimation, Display, TEXT("Motion Matching Pose Cache: %d hits, %d misses, %d entries"), Cache.GetHitCount(), Cache.GetMissCount(), Cache.GetNumEntries());
+		}));
+}
+
+FMotionMatchingPoseCache& FMotionMatchingPoseCache::Get()
+{
+	static FMotionMatchingPoseCache PoseCache;
+	return PoseCache;
+}
+
+bool FMotionMatchingPoseCache::IsEnabled()
+{
+	return PoseCacheGlobals::EnablePoseCache != 0;
+}
+
+void FMotionMatchingPoseCache::Reset()
+{
+	FScopeLock Lock(&CacheCriticalSection);
+
+	CachedPoses.Empty();
+	HitCount.Reset();
+	MissCount.Reset();
+}
+
+int32 FMotionMatchingPoseCache::GetNumEntries() const
+{
+	FScopeLock Lock(&CacheCriticalSection);
+	return CachedPoses.Num();
+}
+
+uint32 FMotionMatchingPoseCache::GetBoneLayoutHash(const FBoneContainer& BoneContainer)
+{
+	const TArray<FBoneIndexType>& BoneIndices = BoneContainer.GetBoneIndicesArray();
+
+	uint32 Hash = FCrc::MemCrc32(BoneIndices.GetData(), BoneIndices.Num() * BoneIndices.GetTypeSize());
+	return HashCombine(Hash, GetTypeHash(BoneContainer.GetAsset()));
+}
+
+int32 FMotionMatchingPoseCache::QuantizeTime(const float InTime)
+{
+	return FMath::RoundToInt(InTime / FMath::Max(PoseCacheGlobals::TimeQuantization, KINDA_SMALL_NUMBER));
+}
+
+float FMotionMatchingPoseCache::DequantizeTime(const int32 InQuantizedTime)
+{
+	return InQuantizedTime * FMath::Max(PoseCacheGlobals::TimeQuantization, KINDA_SMALL_NUMBER);
+}
+
+TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe> FMotionMatchingPoseCache::FindPose(const FMotionMatchingPoseCacheKey& Key)
+{
+	TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe> Result;
+
+	{
+		FScopeLock Lock(&CacheCriticalSection);
+
+		const TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe>* FoundPose = CachedPoses.Find(Key);
+
+		// Poses are only valid for the frame they were decompressed in
+		if (FoundPose && (*FoundPose)->FrameCounter == GFrameCounter)
+		{
+			Result = *FoundPose;
+		}
+	}
+
+	if (Result.IsValid())
+	{
+		HitCount.Increment();
+		INC_DWORD_STAT(STAT_MotionMatchingPoseCacheHits);
+	}
+	else
+	{
+		MissCount.Increment();
+		INC_DWORD_STAT(STAT_MotionMatchingPoseCacheMisses);
+	}
+
+	return Result;
+}
+
+void FMotionMatchingPoseCache::AddPose(const FMotionMatchingPoseCacheKey& Key, const TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe>& Pose)
+{
+	FScopeLock Lock(&CacheCriticalSection);
+
+	if (CachedPoses.Num() >= PoseCacheGlobals::MaxEntries)
+	{
+		// Remove everything from the previous frames before giving up on this pose
+		for (auto It = CachedPoses.CreateIterator(); It; ++It)
+		{
+			if (It.Value()->FrameCounter != GFrameCounter)
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		if (CachedPoses.Num() >= PoseCacheGlobals::MaxEntries)
+		{
+			return;
+		}
+	}
+
+	CachedPoses.Add(Key, Pose);
+}
+
+void FMotionMatchingPoseCache::DecompressPose(const UAnimSequence* InAnimation, const float InTime, FCompactPose& OutPose, FBlendedCurve& OutCurve)
+{
+	check(InAnimation);
+	InAnimation->GetAnimationPose(OutPose, OutCurve, FAnimExtractContext(InTime, true));
+}
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BonePose.h"
+#include "Animation/AnimCurveTypes.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/SharedPointer.h"
+
+class UAnimSequence;
+
+/**
+ * Identifies a decompressed pose inside the pose cache.
+ * The bone layout hash makes sure poses are only shared between nodes that evaluate the same compact bone list.
+ */
+struct FMotionMatchingPoseCacheKey
+{
+	FMotionMatchingPoseCacheKey()
+		: Animation(nullptr)
+		, QuantizedTime(0)
+		, BoneLayoutHash(0)
+	{
+	}
+
+	FMotionMatchingPoseCacheKey(const UAnimSequence* InAnimation, const int32 InQuantizedTime, const uint32 InBoneLayoutHash)
+		: Animation(InAnimation)
+		, QuantizedTime(InQuantizedTime)
+		, BoneLayoutHash(InBoneLayoutHash)
+	{
+	}
+
+	bool operator==(const FMotionMatchingPoseCacheKey& Other) const
+	{
+		return Animation == Other.Animation && QuantizedTime == Other.QuantizedTime && BoneLayoutHash == Other.BoneLayoutHash;
+	}
+
+	friend uint32 GetTypeHash(const FMotionMatchingPoseCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Animation), GetTypeHash(Key.QuantizedTime)), Key.BoneLayoutHash);
+	}
+
+	const UAnimSequence* Animation;
+	int32 QuantizedTime;
+	uint32 BoneLayoutHash;
+};
+
+/**
+ * A single decompressed pose, entries are immutable once they have been added to the cache.
+ * Entries outlive the evaluation that decompressed them, so the curve lives on the heap and not on the FMemStack of a worker.
+ */
+struct FMotionMatchingCachedPose
+{
+	TArray<FTransform> Bones;
+	FBlendedHeapCurve Curve;
+	uint64 FrameCounter;
+};
+
+/**
+ * Per-frame cache of decompressed animation poses that is shared between all motion matching nodes.
+ * Lookups are thread safe so the cache can be used from the animation worker threads.
+ * The cache is opt-in and controlled with a.MotionMatching.PoseCache.
+ */
+class FMotionMatchingPoseCache
+{
+public:
+	static FMotionMatchingPoseCache& Get();
+
+	/** Returns true if the pose cache is enabled */
+	static bool IsEnabled();
+
+	/** Fills the pose and curve for the animation at the given time, decompressing it only when it is not in the cache yet */
+	template<typename AllocatorType>
+	void GetAnimationPose(const UAnimSequence* InAnimation, const float InTime, FBaseCompactPose<AllocatorType>& OutPose, FBlendedCurve& OutCurve);
+
+	/** Removes all cached poses */
+	void Reset();
+
+	int32 GetHitCount() const { return HitCount.GetValue(); }
+	int32 GetMissCount() const { return MissCount.GetValue(); }
+	int32 GetNumEntries() const;
+
+private:
+	FMotionMatchingPoseCache() {}
+
+	static uint32 GetBoneLayoutHash(const FBoneContainer& BoneContainer);
+	static int32 QuantizeTime(const float InTime);
+	static float DequantizeTime(const int32 InQuantizedTime);
+
+	TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe> FindPose(const FMotionMatchingPoseCacheKey& Key);
+	void AddPose(const FMotionMatchingPoseCacheKey& Key, const TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe>& Pose);
+
+	static void DecompressPose(const UAnimSequence* InAnimation, const float InTime, FCompactPose& OutPose, FBlendedCurve& OutCurve);
+
+private:
+	mutable FCriticalSection CacheCriticalSection;
+	TMap<FMotionMatchingPoseCacheKey, TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe>> CachedPoses;
+
+	FThreadSafeCounter HitCount;
+	FThreadSafeCounter MissCount;
+};
+
+template<typename AllocatorType>
+void FMotionMatchingPoseCache::GetAnimationPose(const UAnimSequence* InAnimation, const float InTime, FBaseCompactPose<AllocatorType>& OutPose, FBlendedCurve& OutCurve)
+{
+	const int32 QuantizedTime = QuantizeTime(InTime);
+	const FMotionMatchingPoseCacheKey Key(InAnimation, QuantizedTime, GetBoneLayoutHash(OutPose.GetBoneContainer()));
+
+	TSharedPtr<const FMotionMatchingCachedPose, ESPMode::ThreadSafe> CachedPose = FindPose(Key);
+
+	if (!CachedPose.IsValid())
+	{
+		// Decompress at the quantized time so every node sharing this entry sees the exact same pose
+		FCompactPose DecompressedPose;
+		DecompressedPose.CopyBonesFrom(OutPose);
+
+		FBlendedCurve DecompressedCurve;
+		DecompressedCurve.InitFrom(OutCurve);
+
+		DecompressPose(InAnimation, DequantizeTime(QuantizedTime), DecompressedPose, DecompressedCurve);
+
+		FMotionMatchingCachedPose* NewPose = new FMotionMatchingCachedPose();
+		NewPose->FrameCounter = GFrameCounter;
+		NewPose->Curve.CopyFrom(DecompressedCurve);
+		DecompressedPose.CopyBonesTo(NewPose->Bones);
+
+		CachedPose = MakeShareable(NewPose);
+		AddPose(Key, CachedPose);
+	}
+
+	OutPose.CopyBonesFrom(CachedPose->Bones);
+	OutCurve.CopyFrom(CachedPose->Curve);
+}
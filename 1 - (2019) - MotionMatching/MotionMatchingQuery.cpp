@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingQuery.h"
+#include "MotionMatchingUtilities.h"
+#include "Goal.h"
+
+
+FMotionMatchingQuery::FMotionMatchingQuery()
+	: BonePositionAxis(FVector::OneVector)
+	, TrajectoryPositionAxis(FVector::OneVector)
+	, BoneAxisMask(EMotionAxisMask::XYZ)
+	, TrajectoryAxisMask(EMotionAxisMask::XYZ)
+	, Responsiveness(1.0f)
+	, bPoseMatching(false)
+	, bTrajectoryMatching(false)
+{
+}
+
+void FMotionMatchingQuery::Build(const FMotionFeatureLayout& InLayout, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams)
+{
+	Layout = InLayout;
+	Features.Reset();
+	Features.AddZeroed(Layout.GetStride());
+
+	BonePositionAxis = MotionMatchingParams.BonePositionAxis;
+	TrajectoryPositionAxis = MotionMatchingParams.TrajectoryPositionAxis;
+	BoneAxisMask = GetAxisMask(BonePositionAxis);
+	TrajectoryAxisMask = GetAxisMask(TrajectoryPositionAxis);
+	Responsiveness = MotionMatchingParams.Responsiveness;
+
+	FMemory::Memcpy(Features.GetData() + Layout.GetVelocityOffset(), &MotionMatchingParams.CurrentVelocity, sizeof(FVector));
+
+	// Only Pose match if it is enabled and we have current animation bone data
+	bPoseMatching = MotionMatchingParams.bPoseMatching && MotionMatchingParams.CurrentBonesData.Num() == Layout.NumBones && Layout.NumBones > 0;
+
+	if (bPoseMatching)
+	{
+		for (int32 BoneIndex = 0; BoneIndex < Layout.NumBones; ++BoneIndex)
+		{
+			float* BoneFeatures = Features.GetData() + Layout.GetBoneOffset(BoneIndex);
+			FMemory::Memcpy(BoneFeatures, &MotionMatchingParams.CurrentBonesData[BoneIndex].BonePosition, sizeof(FVector));
+			FMemory::Memcpy(BoneFeatures + 3, &MotionMatchingParams.CurrentBonesData[BoneIndex].BoneVelocity, sizeof(FVector));
+		}
+	}
+
+	bTrajectoryMatching = Goal.IsValid() && Goal.DesiredTrajectory.Num() >= Layout.NumTrajectoryPoints;
+
+	if (bTrajectoryMatching)
+	{
+		for (int32 PointIndex = 0; PointIndex < Layout.NumTrajectoryPoints; ++PointIndex)
+		{
+			FMemory::Memcpy(Features.GetData() + Layout.GetTrajectoryOffset(PointIndex), &Goal.DesiredTrajectory.GetLocation(PointIndex), sizeof(FVector));
+		}
+	}
+}
+
+void FMotionMatchingQuery::BuildFromFeatures(const FMotionFeatureLayout& InLayout, const float* InFeatures)
+{
+	Layout = InLayout;
+	Features.Reset();
+	Features.Append(InFeatures, Layout.GetStride());
+
+	BonePositionAxis = FVector::OneVector;
+	TrajectoryPositionAxis = FVector::OneVector;
+	BoneAxisMask = EMotionAxisMask::XYZ;
+	TrajectoryAxisMask = EMotionAxisMask::XYZ;
+	Responsiveness = 1.0f;
+
+	bPoseMatching = Layout.NumBones > 0;
+	bTrajectoryMatching = Layout.NumTrajectoryPoints > 0;
+}
+
+float FMotionMatchingQuery::ComputeCost(const float* CandidateFeatures) const
+{
+	return ComputeCurrentCost(CandidateFeatures) + Responsiveness * ComputeFutureCost(CandidateFeatures);
+}
+
+void FMotionMatchingQuery::ComputeCostBreakdown(const float* CandidateFeatures, FMotionMatchingCandidate& OutCandidate) const
+{
+	OutCandidate.VelocityCost = ComputeVelocityCost(CandidateFeatures);
+	OutCandidate.PoseCost = ComputePoseCost(CandidateFeatures);
+	OutCandidate.TrajectoryCost = Responsiveness * ComputeFutureCost(CandidateFeatures);
+	OutCandidate.Cost = OutCandidate.VelocityCost + OutCandidate.PoseCost + OutCandidate.TrajectoryCost;
+}
+
+float FMotionMatchingQuery::ComputeCurrentCost(const float* CandidateFeatures) const
+{
+	return ComputeVelocityCost(CandidateFeatures) + ComputePoseCost(CandidateFeatures);
+}
+
+float FMotionMatchingQuery::ComputeVelocityCost(const float* CandidateFeatures) const
+{
+	// Increase the cost according to the difference in velocity
+	return FMotionMatchingCost::Distance(CandidateFeatures + Layout.GetVelocityOffset(), Features.GetData() + Layout.GetVelocityOffset());
+}
+
+float FMotionMatchingQuery::ComputePoseCost(const float* CandidateFeatures) const
+{
+	float Cost = 0.0f;
+
+	if (bPoseMatching)
+	{
+		const float* QueryFeatures = Features.GetData();
+
+		// Increase cost according to the distance and velocity between the bones
+		for (int32 BoneIndex = 0; BoneIndex < Layout.NumBones; ++BoneIndex)
+		{
+			const int32 BoneOffset = Layout.GetBoneOffset(BoneIndex);
+			Cost += FMotionMatchingCost::BoneCost<EMotionAxisMask::Weighted>(CandidateFeatures + BoneOffset, CandidateFeatures + BoneOffset + 3, QueryFeatures + BoneOffset, QueryFeatures + BoneOffset + 3, BonePositionAxis);
+		}
+	}
+
+	return Cost;
+}
+
+float FMotionMatchingQuery::ComputeFutureCost(const float* CandidateFeatures) const
+{
+	float Cost = 0.0f;
+
+	if (bTrajectoryMatching)
+	{
+		const float* QueryFeatures = Features.GetData();
+
+		for (int32 PointIndex = 0; PointIndex < Layout.NumTrajectoryPoints; ++PointIndex)
+		{
+			const int32 PointOffset = Layout.GetTrajectoryOffset(PointIndex);
+			Cost += FMotionMatchingCost::WeightedDistance(CandidateFeatures + PointOffset, QueryFeatures + PointOffset, TrajectoryPositionAxis);
+		}
+	}
+
+	return Cost;
+}
+
+EMotionAxisMask FMotionMatchingQuery::GetAxisMask(const FVector& InAxis)
+{
+	if (InAxis == FVector(1.0f, 1.0f, 1.0f))
+	{
+		return EMotionAxisMask::XYZ;
+	}
+
+	if (InAxis == FVector(1.0f, 1.0f, 0.0f))
+	{
+		return EMotionAxisMask::XY;
+	}
+
+	return EMotionAxisMask::Weighted;
+}
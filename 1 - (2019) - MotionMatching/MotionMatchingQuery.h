@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingCost.h"
+
+struct FGoal;
+struct FMotionMatchingParams;
+
+/** A frame that came out of the search, with the terms that make up its cost */
+struct FMotionMatchingCandidate
+{
+	FMotionMatchingCandidate()
+		: FrameIndex(INDEX_NONE)
+		, Cost(BIG_NUMBER)
+		, VelocityCost(0.0f)
+		, PoseCost(0.0f)
+		, TrajectoryCost(0.0f)
+	{
+	}
+
+	int32 FrameIndex;
+
+	/** VelocityCost + PoseCost + TrajectoryCost */
+	float Cost;
+
+	float VelocityCost;
+	float PoseCost;
+
+	/** Already scaled by the responsiveness */
+	float TrajectoryCost;
+};
+
+/**
+ * How the search picks the frame to play, see UMotionMatchingUtilities::SelectNextFrame.
+ * The animation node and the search component pick with the same settings, so a server that only runs the search ends up on the same frames as the clients.
+ */
+struct FMotionMatchingSelectionSettings
+{
+	FMotionMatchingSelectionSettings()
+		: NumSearchCandidates(8)
+		, SwitchHysteresis(0.1f)
+		, SameLocationTime(0.2f)
+		, NumRerankCandidates(32)
+	{
+	}
+
+	/** Number of candidates the search keeps, the currently playing frame only has to be among them to be considered */
+	int32 NumSearchCandidates;
+
+	/** The current animation keeps playing as long as its cost is within this fraction of the best candidate */
+	float SwitchHysteresis;
+
+	/** Two frames of the same animation closer than this are considered the same location */
+	float SameLocationTime;
+
+	/** Candidates of the approximate search that get their exact cost computed */
+	int32 NumRerankCandidates;
+};
+
+/**
+ * The current situation and the goal of the character, flattened into the same layout as the rows of the search matrix.
+ * Built once per search so every candidate can be compared against it without touching the source structures.
+ */
+struct MOTIONMATCHING_API FMotionMatchingQuery
+{
+public:
+	FMotionMatchingQuery();
+
+	void Build(const FMotionFeatureLayout& InLayout, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams);
+
+	/** Uses a row of the search matrix as the query, with pose and trajectory matching enabled */
+	void BuildFromFeatures(const FMotionFeatureLayout& InLayout, const float* InFeatures);
+
+	/** Cost of jumping to the candidate row, see UMotionMatchingUtilities::ComputeCost */
+	float ComputeCost(const float* CandidateFeatures) const;
+
+	/** Fills the individual cost terms of the candidate */
+	void ComputeCostBreakdown(const float* CandidateFeatures, FMotionMatchingCandidate& OutCandidate) const;
+
+	/** How much the candidate jumping position matches the current situation */
+	float ComputeCurrentCost(const float* CandidateFeatures) const;
+
+	float ComputeVelocityCost(const float* CandidateFeatures) const;
+	float ComputePoseCost(const float* CandidateFeatures) const;
+
+	/** How much the candidate piece of motion matches the desired trajectory, not yet scaled by the responsiveness */
+	float ComputeFutureCost(const float* CandidateFeatures) const;
+
+	static EMotionAxisMask GetAxisMask(const FVector& InAxis);
+
+public:
+	FMotionFeatureLayout Layout;
+	TArray<float, TInlineAllocator<128>> Features;
+
+	FVector BonePositionAxis;
+	FVector TrajectoryPositionAxis;
+	EMotionAxisMask BoneAxisMask;
+	EMotionAxisMask TrajectoryAxisMask;
+	float Responsiveness;
+
+	bool bPoseMatching;
+	bool bTrajectoryMatching;
+};
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionMatchingSearchComponent.h"
+#include "MotionMatchingUtilities.h"
+#include "MotionTrajectoryPredictor.h"
+#include "MotionMatchingQuery.h"
+#include "RootMotionTrack.h"
+#include "AnimationDatabase.h"
+#include "GameFramework/Actor.h"
+#include "Components/SkeletalMeshComponent.h"
+
+
+namespace MotionMatchingSearchComponentGlobals
+{
+	/** Window the current velocity is measured over */
+	const float VelocityDeltaTime = 0.1f;
+}
+
+
+UMotionMatchingSearchComponent::UMotionMatchingSearchComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	// Search with the goal the trajectory component predicted this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	AnimationDatabase = nullptr;
+	Responsiveness = 1.0f;
+	bEnablePoseMatching = true;
+	TrajectoryPositionAxis = FVector::OneVector;
+	BonePositionAxis = FVector::OneVector;
+	SearchInterval = 0.0f;
+	bMoveOwner = false;
+
+	const FMotionMatchingSelectionSettings DefaultSelectionSettings;
+	NumSearchCandidates = DefaultSelectionSettings.NumSearchCandidates;
+	SwitchHysteresis = DefaultSelectionSettings.SwitchHysteresis;
+	SameLocationTime = DefaultSelectionSettings.SameLocationTime;
+
+	TrajectoryComponent = nullptr;
+
+	AnimationIndex = INDEX_NONE;
+	Time = 0.0f;
+	bMirrored = false;
+	TimeSinceLastSearch = 0.0f;
+	AccumulatedRootMotion = FTransform::Identity;
+}
+
+void UMotionMatchingSearchComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (AActor* Owner = GetOwner())
+	{
+		TrajectoryComponent = Owner->FindComponentByClass<UMotionTrajectoryComponent>();
+
+		if (TrajectoryComponent)
+		{
+			AddTickPrerequisiteComponent(TrajectoryComponent);
+		}
+	}
+}
+
+void UMotionMatchingSearchComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateDatabaseSnapshot();
+
+	if (!DatabaseSnapshot.IsValid())
+	{
+		return;
+	}
+
+	if (TrajectoryComponent)
+	{
+		Goal = TrajectoryComponent->GetGoal();
+	}
+
+	AdvancePlayback(DeltaTime);
+
+	TimeSinceLastSearch += DeltaTime;
+	if (AnimationIndex == INDEX_NONE || TimeSinceLastSearch >= SearchInterval)
+	{
+		TimeSinceLastSearch = 0.0f;
+		Search();
+	}
+}
+
+void UMotionMatchingSearchComponent::SetGoal(const FGoal& InGoal)
+{
+	Goal = InGoal;
+}
+
+FTransform UMotionMatchingSearchComponent::ConsumeRootMotion()
+{
+	const FTransform RootMotion = AccumulatedRootMotion;
+	AccumulatedRootMotion = FTransform::Identity;
+	return RootMotion;
+}
+
+void UMotionMatchingSearchComponent::GetPlayingAnimation(UAnimSequence*& OutAnimation, float& OutTime, bool& bOutMirrored) const
+{
+	OutAnimation = DatabaseSnapshot.IsValid() ? DatabaseSnapshot->GetAnimation(AnimationIndex) : nullptr;
+	OutTime = Time;
+	bOutMirrored = bMirrored;
+}
+
+void UMotionMatchingSearchComponent::UpdateDatabaseSnapshot()
+{
+	FMotionDatabaseSnapshotPtr NewSnapshot = AnimationDatabase ? AnimationDatabase->GetRuntimeSnapshot() : nullptr;
+
+	if (NewSnapshot == DatabaseSnapshot)
+	{
+		return;
+	}
+
+	// The animation index of the playing animation might have moved with a rebake
+	if (NewSnapshot.IsValid() && DatabaseSnapshot.IsValid())
+	{
+		AnimationIndex = NewSnapshot->FindAnimationIndex(DatabaseSnapshot->GetAnimation(AnimationIndex));
+	}
+	else
+	{
+		AnimationIndex = INDEX_NONE;
+	}
+
+	DatabaseSnapshot = NewSnapshot;
+}
+
+void UMotionMatchingSearchComponent::Search()
+{
+	FMotionMatchingParams Params;
+	Params.Responsiveness = Responsiveness;
+	Params.bPoseMatching = bEnablePoseMatching;
+	Params.TrajectoryPositionAxis = TrajectoryPositionAxis;
+	Params.BonePositionAxis = BonePositionAxis;
+
+	const FRootMotionTrack* RootMotionTrack = DatabaseSnapshot->GetRootMotionTrack(AnimationIndex);
+	const int32 CurrentFrameIndex = AnimationIndex != INDEX_NONE ? DatabaseSnapshot->FindFrameIndex(AnimationIndex, Time, bMirrored) : INDEX_NONE;
+
+	if (RootMotionTrack && CurrentFrameIndex != INDEX_NONE)
+	{
+		Params.CurrentVelocity = RootMotionTrack->GetVelocity(Time, MotionMatchingSearchComponentGlobals::VelocityDeltaTime);
+		if (bMirrored)
+		{
+			Params.CurrentVelocity = DatabaseSnapshot->GetMirrorTable().MirrorVector(Params.CurrentVelocity);
+		}
+
+		// The baked features of the playing frame stand in for the pose, they are already mirrored for mirrored frames
+		UMotionMatchingUtilities::GetBoneDataFromFeatures(*DatabaseSnapshot, CurrentFrameIndex, Params.CurrentBonesData);
+		Params.bHasCurrentAnimation = true;
+	}
+
+	FMotionMatchingSelectionSettings SelectionSettings;
+	SelectionSettings.NumSearchCandidates = FMath::Max(1, NumSearchCandidates);
+	SelectionSettings.SwitchHysteresis = FMath::Max(0.0f, SwitchHysteresis);
+	SelectionSettings.SameLocationTime = FMath::Max(0.0f, SameLocationTime);
+
+	// Same selection as the animation node, so the server picks the same winners as the clients
+	int32 WinnerFrameIndex = INDEX_NONE;
+	if (!UMotionMatchingUtilities::SelectNextFrame(*DatabaseSnapshot, Goal, Params, SelectionSettings, AnimationIndex, Time, bMirrored, false, WinnerFrameIndex))
+	{
+		return;
+	}
+
+	const FMotionFrameInfo& Winner = DatabaseSnapshot->GetFrameInfo(WinnerFrameIndex);
+	AnimationIndex = Winner.SourceAnimationIndex;
+	Time = Winner.StartTime;
+	bMirrored = Winner.bMirrored;
+}
+
+void UMotionMatchingSearchComponent::AdvancePlayback(const float DeltaTime)
+{
+	const FRootMotionTrack* RootMotionTrack = DatabaseSnapshot->GetRootMotionTrack(AnimationIndex);
+	if (!RootMotionTrack || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	// Animations loop, the same way the animation node plays them
+	FTransform RootMotion = RootMotionTrack->ExtractRootMotion(Time, DeltaTime, true);
+	if (bMirrored)
+	{
+		RootMotion = DatabaseSnapshot->GetMirrorTable().MirrorTransform(RootMotion);
+	}
+
+	const float Length = RootMotionTrack->GetLength();
+	Time = Length > KINDA_SMALL_NUMBER ? FMath::Fmod(Time + DeltaTime, Length) : 0.0f;
+
+	const FTransform WorldRootMotion = ConvertRootMotionToWorld(RootMotion);
+	AccumulatedRootMotion.Accumulate(WorldRootMotion);
+
+	if (bMoveOwner)
+	{
+		if (AActor* Owner = GetOwner())
+		{
+			Owner->SetActorLocationAndRotation(
+				Owner->GetActorLocation() + WorldRootMotion.GetTranslation(),
+				WorldRootMotion.GetRotation() * Owner->GetActorQuat(),
+				true /* bSweep */);
+		}
+	}
+}
+
+FTransform UMotionMatchingSearchComponent::ConvertRootMotionToWorld(const FTransform& InRootMotion) const
+{
+	const AActor* Owner = GetOwner();
+	if (!Owner)
+	{
+		return InRootMotion;
+	}
+
+	// Root motion is relative to the mesh, which is usually rotated relative to the actor
+	const USkeletalMeshComponent* Mesh = Owner->FindComponentByClass<USkeletalMeshComponent>();
+	const FTransform ComponentTM = Mesh ? Mesh->GetComponentTransform() : Owner->GetActorTransform();
+
+	const FVector DeltaTranslation = ComponentTM.TransformVectorNoScale(InRootMotion.GetTranslation());
+	const FQuat ComponentRotation = ComponentTM.GetRotation();
+	const FQuat DeltaRotation = (ComponentRotation * InRootMotion.GetRotation()) * ComponentRotation.Inverse();
+
+	return FTransform(DeltaRotation, DeltaTranslation);
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Goal.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingSearchComponent.generated.h"
+
+class UAnimationDatabase;
+class UMotionTrajectoryComponent;
+
+/**
+ * Runs the motion matching search without an animation graph and plays the winner back as root motion only.
+ * The current velocity comes from the baked root motion and the current pose from the baked features of the playing frame,
+ * so no animation is ever decompressed. Meant for dedicated servers that drive authoritative movement of many characters,
+ * the clients play the same database with FAnimNode_MotionMatching.
+ */
+UCLASS(ClassGroup = (Animation), meta = (BlueprintSpawnableComponent))
+class MOTIONMATCHING_API UMotionMatchingSearchComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMotionMatchingSearchComponent(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite)
+	UAnimationDatabase* AnimationDatabase;
+
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float Responsiveness;
+
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite)
+	bool bEnablePoseMatching;
+
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite)
+	FVector TrajectoryPositionAxis;
+
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite)
+	FVector BonePositionAxis;
+
+	/** Number of candidates the search keeps, keep it the same as on the animation node so both pick the same frames */
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+	int32 NumSearchCandidates;
+
+	/** The current animation keeps playing as long as its cost is within this fraction of the best candidate */
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float SwitchHysteresis;
+
+	/** Seconds between two frames of the same animation that still count as the same location */
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float SameLocationTime;
+
+	/** Seconds between two searches, the winner keeps playing in between. Zero searches every tick like the animation node */
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float SearchInterval;
+
+	/** Moves the owner with the extracted root motion, otherwise it is only accumulated until ConsumeRootMotion is called */
+	UPROPERTY(Category = "Motion Matching", EditAnywhere, BlueprintReadWrite)
+	bool bMoveOwner;
+
+public:
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Goal of the next search, only needed when the owner has no UMotionTrajectoryComponent */
+	UFUNCTION(Category = "Motion Matching", BlueprintCallable)
+	void SetGoal(const FGoal& InGoal);
+
+	/** Returns the world space root motion accumulated since the last call, and resets it */
+	UFUNCTION(Category = "Motion Matching", BlueprintCallable)
+	FTransform ConsumeRootMotion();
+
+	/** Animation and time that is currently playing, for replication to the clients */
+	UFUNCTION(Category = "Motion Matching", BlueprintCallable, BlueprintPure)
+	void GetPlayingAnimation(UAnimSequence*& OutAnimation, float& OutTime, bool& bOutMirrored) const;
+
+private:
+	void UpdateDatabaseSnapshot();
+	void Search();
+	void AdvancePlayback(const float DeltaTime);
+	FTransform ConvertRootMotionToWorld(const FTransform& InRootMotion) const;
+
+private:
+	UPROPERTY(Transient)
+	UMotionTrajectoryComponent* TrajectoryComponent;
+
+	FGoal Goal;
+
+	FMotionDatabaseSnapshotPtr DatabaseSnapshot;
+
+	int32 AnimationIndex;
+	float Time;
+	bool bMirrored;
+
+	float TimeSinceLastSearch;
+
+	FTransform AccumulatedRootMotion;
+};
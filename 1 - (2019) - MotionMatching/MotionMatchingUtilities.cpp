@@ -8,6 +8,12 @@
 #include "Animation/AnimSequenceBase.h"
 #include "Animation/Skeleton.h"
 #include "AnimationFrameData.h"
+#include "MotionTrajectory.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingQuery.h"
+#include "MotionMatchingCostKernels.h"
+#include "MotionMatchingCost.h"
+#include "MotionFeatureQuantization.h"
 
 
 namespace MotionMatchingGlobals
@@ -18,6 +24,123 @@ namespace MotionMatchingGlobals
 	const float PreviousTimeDelta = 0.1f;
 	const float NextTimeDelta = 0.1f;
 	const int RootBoneIndex = 0;
+
+	/** Keeps the single best candidate */
+	struct FBestCandidateCollector
+	{
+		FBestCandidateCollector()
+			: BestCost(BIG_NUMBER)
+			, BestIndex(INDEX_NONE)
+		{
+		}
+
+		FORCEINLINE float GetCostBound() const { return BestCost; }
+
+		FORCEINLINE void Add(const int32 CandidateIndex, const float Cost)
+		{
+			BestCost = Cost;
+			BestIndex = CandidateIndex;
+		}
+
+		float BestCost;
+		int32 BestIndex;
+	};
+
+	/** Keeps the K best candidates in a max heap, so the worst of them is always on top and can be replaced */
+	struct FTopCandidatesCollector
+	{
+		struct FHeapEntry
+		{
+			int32 Index;
+			float Cost;
+		};
+
+		struct FWorstFirst
+		{
+			FORCEINLINE bool operator()(const FHeapEntry& A, const FHeapEntry& B) const { return A.Cost > B.Cost; }
+		};
+
+		explicit FTopCandidatesCollector(const int32 InMaxCandidates)
+			: MaxCandidates(FMath::Max(InMaxCandidates, 1))
+		{
+			Heap.Reserve(MaxCandidates);
+		}
+
+		FORCEINLINE float GetCostBound() const { return Heap.Num() < MaxCandidates ? BIG_NUMBER : Heap.HeapTop().Cost; }
+
+		FORCEINLINE void Add(const int32 CandidateIndex, const float Cost)
+		{
+			if (Heap.Num() == MaxCandidates)
+			{
+				Heap.HeapPopDiscard(FWorstFirst(), false);
+			}
+
+			Heap.HeapPush(FHeapEntry{ CandidateIndex, Cost }, FWorstFirst());
+		}
+
+		int32 MaxCandidates;
+		TArray<FHeapEntry, TInlineAllocator<16>> Heap;
+	};
+
+	/** Single pass over every candidate, candidates are only handed to the collector when they beat its current bound */
+	template<typename KernelType, typename CollectorType>
+	void SearchCandidates(const FMotionDatabaseSnapshot& Snapshot, const FMotionMatchingQuery& Query, CollectorType& Collector)
+	{
+		const int32 NumberOfCandidates = Snapshot.Num();
+
+		for (int32 CandidateIndex = 0; CandidateIndex < NumberOfCandidates; ++CandidateIndex)
+		{
+			const float CostBound = Collector.GetCostBound();
+			const float Cost = KernelType::ComputeCostBounded(Query, Snapshot.GetFeatures(CandidateIndex), CostBound);
+
+			if (Cost < CostBound)
+			{
+				Collector.Add(CandidateIndex, Cost);
+
+				// Nothing can beat a perfect match
+				if (Cost <= 0.0f && Collector.GetCostBound() <= 0.0f)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	/** Same as SearchCandidates, but only over the given frames, INDEX_NONE entries are skipped */
+	template<typename KernelType, typename CollectorType>
+	void SearchCandidateList(const FMotionDatabaseSnapshot& Snapshot, const FMotionMatchingQuery& Query, TArrayView<const int32> CandidateIndices, CollectorType& Collector)
+	{
+		for (const int32 CandidateIndex : CandidateIndices)
+		{
+			if (CandidateIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			const float CostBound = Collector.GetCostBound();
+			const float Cost = KernelType::ComputeCostBounded(Query, Snapshot.GetFeatures(CandidateIndex), CostBound);
+
+			if (Cost < CostBound)
+			{
+				Collector.Add(CandidateIndex, Cost);
+			}
+		}
+	}
+
+	/** Sorted candidates with their cost broken down, only the survivors of the search pay for the breakdown */
+	void GetSortedCandidates(const FMotionDatabaseSnapshot& Snapshot, const FMotionMatchingQuery& Query, const FTopCandidatesCollector& Collector, TArray<FMotionMatchingCandidate>& OutCandidates)
+	{
+		OutCandidates.Reset(Collector.Heap.Num());
+
+		for (const FTopCandidatesCollector::FHeapEntry& Entry : Collector.Heap)
+		{
+			FMotionMatchingCandidate& Candidate = OutCandidates.AddDefaulted_GetRef();
+			Candidate.FrameIndex = Entry.Index;
+			Query.ComputeCostBreakdown(Snapshot.GetFeatures(Entry.Index), Candidate);
+		}
+
+		OutCandidates.Sort([](const FMotionMatchingCandidate& A, const FMotionMatchingCandidate& B) { return A.Cost < B.Cost; });
+	}
 }
 
 
@@ -31,35 +154,180 @@ void UMotionMatchingUtilities::GetLowestCostAnimation(const UAnimationDatabase*
 {
 	if (AnimationDatabase)
 	{
-		const TArray<FAnimationFrameData> FrameData = AnimationDatabase->GetMotionFrameData();
-		const int NumberOfCandidates = FrameData.Num();
+		const FMotionDatabaseSnapshotPtr Snapshot = AnimationDatabase->GetRuntimeSnapshot();
 
-		float BestCost = BIG_NUMBER;
-		int BestCandidateIndex = INDEX_NONE;
-		int SourceAnimIndex = INDEX_NONE;
+		if (Snapshot.IsValid())
+		{
+			GetLowestCostAnimation(*Snapshot, Goal, MotionMatchingParams, OutBestCandidateIndex, OutBestCandidateCost);
+		}
+	}
+}
+
+void UMotionMatchingUtilities::GetLowestCostAnimation(const FMotionDatabaseSnapshot& Snapshot, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams, int& OutBestCandidateIndex, float& OutBestCandidateCost)
+{
+	FMotionMatchingQuery Query;
+	Query.Build(Snapshot.GetLayout(), Goal, MotionMatchingParams);
+
+	GetLowestCostAnimation(Snapshot, Query, OutBestCandidateIndex, OutBestCandidateCost);
+}
+
+void UMotionMatchingUtilities::GetLowestCostAnimation(const FMotionDatabaseSnapshot& Snapshot, const FMotionMatchingQuery& Query, int& OutBestCandidateIndex, float& OutBestCandidateCost)
+{
+	MotionMatchingGlobals::FBestCandidateCollector Collector;
+	DispatchCostKernel(Query, [&](auto Kernel)
+	{
+		MotionMatchingGlobals::SearchCandidates<decltype(Kernel)>(Snapshot, Query, Collector);
+	});
+
+	OutBestCandidateCost = Collector.BestCost;
+	OutBestCandidateIndex = Collector.BestIndex;
+}
+
+void UMotionMatchingUtilities::GetLowestCostAnimations(const FMotionDatabaseSnapshot& Snapshot, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams, const int32 NumCandidates, TArray<FMotionMatchingCandidate>& OutCandidates)
+{
+	OutCandidates.Reset();
 
-		if (NumberOfCandidates > 0)
+	FMotionMatchingQuery Query;
+	Query.Build(Snapshot.GetLayout(), Goal, MotionMatchingParams);
+
+	MotionMatchingGlobals::FTopCandidatesCollector Collector(NumCandidates);
+	DispatchCostKernel(Query, [&](auto Kernel)
+	{
+		MotionMatchingGlobals::SearchCandidates<decltype(Kernel)>(Snapshot, Query, Collector);
+	});
+
+	MotionMatchingGlobals::GetSortedCandidates(Snapshot, Query, Collector, OutCandidates);
+}
+
+void UMotionMatchingUtilities::GetLowestCostAnimationsApproximate(const FMotionDatabaseSnapshot& Snapshot, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams, const int32 NumCandidates, const int32 NumRerankCandidates, TArray<FMotionMatchingCandidate>& OutCandidates)
+{
+	FMotionMatchingQuery Query;
+	Query.Build(Snapshot.GetLayout(), Goal, MotionMatchingParams);
+
+	GetLowestCostAnimationsApproximate(Snapshot, Query, NumCandidates, NumRerankCandidates, OutCandidates);
+}
+
+void UMotionMatchingUtilities::GetLowestCostAnimationsApproximate(const FMotionDatabaseSnapshot& Snapshot, const FMotionMatchingQuery& Query, const int32 NumCandidates, const int32 NumRerankCandidates, TArray<FMotionMatchingCandidate>& OutCandidates)
+{
+	OutCandidates.Reset();
+
+	if (!Snapshot.HasQuantizedFeatures())
+	{
+		return;
+	}
+
+	// Rank every frame by its quantized features, a few table lookups per frame
+	FMotionQuantizedCostTable CostTable;
+	CostTable.Build(Snapshot, Query);
+
+	MotionMatchingGlobals::FTopCandidatesCollector Shortlist(FMath::Max(NumRerankCandidates, NumCandidates));
+
+	const int32 NumberOfCandidates = Snapshot.Num();
+	for (int32 CandidateIndex = 0; CandidateIndex < NumberOfCandidates; ++CandidateIndex)
+	{
+		const float Cost = CostTable.ComputeCost(Snapshot.GetCodes(CandidateIndex));
+		if (Cost < Shortlist.GetCostBound())
 		{
-			for (int CandidateIndex = 0; CandidateIndex < NumberOfCandidates; CandidateIndex++)
-			{
-				float Cost = ComputeCost(FrameData[CandidateIndex], Goal, MotionMatchingParams);
+			Shortlist.Add(CandidateIndex, Cost);
+		}
+	}
 
-				if (Cost < BestCost)
-				{
-					BestCost = Cost;
-					BestCandidateIndex = CandidateIndex;
-				}
+	TArray<int32, TInlineAllocator<64>> ShortlistIndices;
+	for (const MotionMatchingGlobals::FTopCandidatesCollector::FHeapEntry& Entry : Shortlist.Heap)
+	{
+		ShortlistIndices.Add(Entry.Index);
+	}
 
-				if (Cost <= 0.0f)
-				{
-					break;
-				}
+	// Only the shortlist pays for the exact cost
+	MotionMatchingGlobals::FTopCandidatesCollector Collector(NumCandidates);
+	DispatchCostKernel(Query, [&](auto Kernel)
+	{
+		MotionMatchingGlobals::SearchCandidateList<decltype(Kernel)>(Snapshot, Query, ShortlistIndices, Collector);
+	});
+
+	MotionMatchingGlobals::GetSortedCandidates(Snapshot, Query, Collector, OutCandidates);
+}
+
+void UMotionMatchingUtilities::GetLowestCostTransitions(const FMotionDatabaseSnapshot& Snapshot, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams, const int32 CurrentFrameIndex, const int32 NumCandidates, TArray<FMotionMatchingCandidate>& OutCandidates)
+{
+	OutCandidates.Reset();
+
+	if (!Snapshot.HasTransitionGraph() || !Snapshot.IsValidIndex(CurrentFrameIndex))
+	{
+		return;
+	}
+
+	FMotionMatchingQuery Query;
+	Query.Build(Snapshot.GetLayout(), Goal, MotionMatchingParams);
+
+	MotionMatchingGlobals::FTopCandidatesCollector Collector(NumCandidates);
+
+	// Continuing to play is always an option, the transitions only hold the jumps away from the current segment
+	DispatchCostKernel(Query, [&](auto Kernel)
+	{
+		MotionMatchingGlobals::SearchCandidateList<decltype(Kernel)>(Snapshot, Query, TArrayView<const int32>(&CurrentFrameIndex, 1), Collector);
+		MotionMatchingGlobals::SearchCandidateList<decltype(Kernel)>(Snapshot, Query, Snapshot.GetTransitions(CurrentFrameIndex), Collector);
+	});
+
+	MotionMatchingGlobals::GetSortedCandidates(Snapshot, Query, Collector, OutCandidates);
+}
+
+bool UMotionMatchingUtilities::SelectNextFrame(const FMotionDatabaseSnapshot& Snapshot, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams, const FMotionMatchingSelectionSettings& SelectionSettings,
+	const int32 CurrentAnimationIndex, const float CurrentTime, const bool bCurrentMirrored, const bool bUseTransitionGraph, int32& OutFrameIndex)
+{
+	OutFrameIndex = INDEX_NONE;
+
+	TArray<FMotionMatchingCandidate> Candidates;
+
+	// With a transition graph only the jumps away from the playing frame are considered
+	if (bUseTransitionGraph && Snapshot.HasTransitionGraph() && CurrentAnimationIndex != INDEX_NONE)
+	{
+		const int32 CurrentFrameIndex = Snapshot.FindFrameIndex(CurrentAnimationIndex, CurrentTime, bCurrentMirrored);
+		GetLowestCostTransitions(Snapshot, Goal, MotionMatchingParams, CurrentFrameIndex, SelectionSettings.NumSearchCandidates, Candidates);
+	}
+
+	// Databases with quantized features can be searched approximately on hardware that can not afford the exact search
+	if (Candidates.Num() == 0 && FMotionFeatureQuantization::IsEnabled() && Snapshot.HasQuantizedFeatures())
+	{
+		GetLowestCostAnimationsApproximate(Snapshot, Goal, MotionMatchingParams, SelectionSettings.NumSearchCandidates, SelectionSettings.NumRerankCandidates, Candidates);
+	}
+
+	// The first search, or the playing frame is not part of the snapshot anymore
+	if (Candidates.Num() == 0)
+	{
+		GetLowestCostAnimations(Snapshot, Goal, MotionMatchingParams, SelectionSettings.NumSearchCandidates, Candidates);
+	}
+
+	if (Candidates.Num() == 0)
+	{
+		return false;
+	}
+
+	// Keep playing when the current location is among the candidates and not noticeably worse than the winner,
+	// this stops the search from jumping back and forth between frames with nearly the same cost
+	if (CurrentAnimationIndex != INDEX_NONE)
+	{
+		const float MaxCostToKeepPlaying = Candidates[0].Cost * (1.0f + SelectionSettings.SwitchHysteresis);
+
+		for (const FMotionMatchingCandidate& Candidate : Candidates)
+		{
+			if (Candidate.Cost > MaxCostToKeepPlaying)
+			{
+				break;
 			}
-		}
 
-		OutBestCandidateCost = BestCost;
-		OutBestCandidateIndex = BestCandidateIndex;
+			const FMotionFrameInfo& FrameInfo = Snapshot.GetFrameInfo(Candidate.FrameIndex);
+			if ((FrameInfo.SourceAnimationIndex == CurrentAnimationIndex)
+				&& (FrameInfo.bMirrored == bCurrentMirrored)
+				&& (FMath::Abs(FrameInfo.StartTime - CurrentTime) < SelectionSettings.SameLocationTime))
+			{
+				return false;
+			}
+		}
 	}
+
+	OutFrameIndex = Candidates[0].FrameIndex;
+	return true;
 }
 
 float UMotionMatchingUtilities::ComputeCost(const FAnimationFrameData& CandidatePose, const FGoal& Goal, const FMotionMatchingParams& MotionMatchingParams)
@@ -82,7 +350,7 @@ float UMotionMatchingUtilities::ComputeCurrentCost(const FAnimationFrameData& Ca
 	float Cost = 0.0f;
 
 	// Increase the cost according to the difference in velocity
-	Cost += FVector::Dist(MotionMatchingParams.CurrentVelocity, CandidatePose.MotionVelocity);
+	Cost += FMotionMatchingCost::Distance(&MotionMatchingParams.CurrentVelocity.X, &CandidatePose.MotionVelocity.X);
 
 	// Only Pose match if it is enabled and we have current animation bone data
 	if (MotionMatchingParams.bPoseMatching && MotionMatchingParams.CurrentBonesData.Num() > 0)
@@ -92,7 +360,9 @@ float UMotionMatchingUtilities::ComputeCurrentCost(const FAnimationFrameData& Ca
 		// Increase cost according to the distance and velocity between the bones
 		for (int i = 0; i < CandidatePose.MotionBonesData.Num(); ++i)
 		{
-			Cost += CandidatePose.MotionBonesData[i].ComputeCostBetween(MotionMatchingParams.CurrentBonesData[i], MotionMatchingParams.BonePositionAxis);
+			const FMotionBoneData& CandidateBone = CandidatePose.MotionBonesData[i];
+			const FMotionBoneData& CurrentBone = MotionMatchingParams.CurrentBonesData[i];
+			Cost += FMotionMatchingCost::BoneCost(CandidateBone.BonePosition, CandidateBone.BoneVelocity, CurrentBone.BonePosition, CurrentBone.BoneVelocity, MotionMatchingParams.BonePositionAxis);
 		}
 	}
 
@@ -107,7 +377,7 @@ float UMotionMatchingUtilities::ComputeFutureCost(const FAnimationFrameData& Can
 
 	if (Goal.IsValid())
 	{
-		Cost += Goal.CalculateCostBetweenTrajectory(CandidatePose.MotionTrajectory, MotionMatchingParams.TrajectoryPositionAxis);
+		Cost += Goal.DesiredTrajectory.ComputeCost(CandidatePose.MotionTrajectory, MotionMatchingParams.TrajectoryPositionAxis);
 	}
 
 	// ... add other Future Cost Calculations that are required for Motion Matching here ...
@@ -115,21 +385,21 @@ float UMotionMatchingUtilities::ComputeFutureCost(const FAnimationFrameData& Can
 	return Cost;
 }
 
-FGoal UMotionMatchingUtilities::MakeGoal(const float DesiredSpeed, const FVector InputDirectionNormal, const FTransform CharacterMeshTM, const TArray<float> TrajectoryIntervals)
+FGoal UMotionMatchingUtilities::MakeGoal(const float DesiredSpeed, const FVector InputDirectionNormal, const FTransform CharacterMeshTM, const TArray<float>& TrajectoryIntervals)
 {
+	check(FMotionTrajectory::CanHoldIntervals(TrajectoryIntervals));
+
 	FGoal OutGoal = FGoal();
 
 	for (const float TrajectoryInterval : TrajectoryIntervals)
 	{
 		const FVector TrajectoryLocation = CharacterMeshTM.GetLocation() + ((InputDirectionNormal * DesiredSpeed) * TrajectoryInterval);
-		const FTrajectoryPoint TrajectoryPoint = FTrajectoryPoint(TrajectoryLocation, TrajectoryInterval);
 
 		FTransform TrajectoryPointTM;
 		TrajectoryPointTM.SetTranslation(TrajectoryLocation);
 
-		FTransform RelativeTM = TrajectoryPointTM.GetRelativeTransform(CharacterMeshTM);
-		OutGoal.DesiredTrajectory.Add(FTrajectoryPoint(RelativeTM.GetTranslation(), RelativeTM.GetRotation(), TrajectoryInterval));
-		//OutGoal.DesiredTrajectory.Add(TrajectoryPoint);
+		const FTransform RelativeTM = TrajectoryPointTM.GetRelativeTransform(CharacterMeshTM);
+		OutGoal.DesiredTrajectory.Add(RelativeTM.GetTranslation(), RelativeTM.GetRotation(), TrajectoryInterval);
 	}
 
 	return OutGoal;
@@ -141,15 +411,15 @@ void UMotionMatchingUtilities::DrawDebugGoal(const UWorld* World, const FGoal& I
 	{
 		if (InGoal.DesiredTrajectory.Num() > 0)
 		{
-			const FVector InitialLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory[0].Location);
+			const FVector InitialLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory.GetLocation(0));
 
 			DrawDebugLine(World, CharacterMeshTM.GetLocation(), InitialLocation, FColor::Blue, false, -1.0f, 0, 2.0f);
 			DrawDebugPoint(World, InitialLocation, 15.0f, FColor::White);
 
 			for (int i = 1; i < InGoal.DesiredTrajectory.Num(); ++i)
 			{
-				const FVector CurrentLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory[i].Location);
-				const FVector PreviousLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory[i - 1].Location);
+				const FVector CurrentLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory.GetLocation(i));
+				const FVector PreviousLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory.GetLocation(i - 1));
 
 				DrawDebugLine(World, PreviousLocation, CurrentLocation, FColor::Blue, false, -1.0f, 0, 2.0f);
 				DrawDebugSphere(World, CurrentLocation, 15.0f, 10, FColor::Blue, false, -1.0f, 0, 2.0f);
@@ -164,7 +434,7 @@ void UMotionMatchingUtilities::DrawDebugDirection(const UWorld* World, const FGo
 	{
 		if (InGoal.DesiredTrajectory.Num() > 0)
 		{
-			const FVector FutureLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory.Last().Location * 0.25f);
+			const FVector FutureLocation = CharacterMeshTM.TransformPosition(InGoal.DesiredTrajectory.GetLocation(InGoal.DesiredTrajectory.Num() - 1) * 0.25f);
 			DrawDebugDirectionalArrow(World, CharacterMeshTM.GetLocation(), FutureLocation, 30.0f, FColor::White, false, -1.0f, 0, 2.0f);
 		}
 	}
@@ -209,6 +479,28 @@ TArray<struct FMotionBoneData> UMotionMatchingUtilities::GetBoneDataFromAnimatio
 	return MotionBonesData;
 }
 
+void UMotionMatchingUtilities::GetBoneDataFromFeatures(const FMotionDatabaseSnapshot& Snapshot, const int32 FrameIndex, TArray<FMotionBoneData>& OutBonesData)
+{
+	OutBonesData.Reset();
+
+	if (!Snapshot.IsValidIndex(FrameIndex))
+	{
+		return;
+	}
+
+	const FMotionFeatureLayout& Layout = Snapshot.GetLayout();
+	const float* Features = Snapshot.GetFeatures(FrameIndex);
+
+	for (int32 BoneIndex = 0; BoneIndex < Layout.NumBones; ++BoneIndex)
+	{
+		const float* BoneFeatures = Features + Layout.GetBoneOffset(BoneIndex);
+
+		FMotionBoneData& BoneData = OutBonesData.AddDefaulted_GetRef();
+		BoneData.BonePosition = FVector(BoneFeatures[0], BoneFeatures[1], BoneFeatures[2]);
+		BoneData.BoneVelocity = FVector(BoneFeatures[3], BoneFeatures[4], BoneFeatures[5]);
+	}
+}
+
 FTransform UMotionMatchingUtilities::GetTransformFromBoneSpace(const UAnimSequence* InAnimSequence, const float InTime, const struct FReferenceSkeleton& InReferenceSkeleton, const int InBoneIndex)
 {
 	if (InAnimSequence)
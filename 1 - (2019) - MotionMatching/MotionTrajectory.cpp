@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionTrajectory.h"
+#include "Goal.h"
+#include "MotionMatchingCost.h"
+#include "UObject/PropertyTag.h"
+
+
+FMotionTrajectory::FMotionTrajectory()
+	: NumPoints(0)
+{
+	for (int32 i = 0; i < MaxPoints; ++i)
+	{
+		Locations[i] = FVector::ZeroVector;
+		Rotations[i] = FQuat::Identity;
+		Times[i] = 0.0f;
+	}
+}
+
+float FMotionTrajectory::ComputeCost(const FMotionTrajectory& Other, const FVector& AxisMask) const
+{
+	// Both trajectories are sampled at the same intervals, so points are compared by index
+	const int32 NumComparedPoints = FMath::Min(NumPoints, Other.NumPoints);
+
+	float Cost = 0.0f;
+	for (int32 i = 0; i < NumComparedPoints; ++i)
+	{
+		Cost += FMotionMatchingCost::TrajectoryPointCost(Locations[i], Other.Locations[i], AxisMask);
+	}
+
+	return Cost;
+}
+
+bool FMotionTrajectory::CanHoldIntervals(const TArray<float>& TrajectoryIntervals)
+{
+	return TrajectoryIntervals.Num() <= MaxPoints;
+}
+
+bool FMotionTrajectory::SerializeFromMismatchedTag(const FPropertyTag& Tag, FArchive& Ar)
+{
+	if (Tag.Type != NAME_ArrayProperty || Tag.InnerType != NAME_StructProperty)
+	{
+		return false;
+	}
+
+	// Same layout UArrayProperty writes for an array of structs
+	int32 NumSavedPoints = 0;
+	Ar << NumSavedPoints;
+
+	if (Ar.UE4Ver() >= VER_UE4_INNER_ARRAY_TAG_INFO)
+	{
+		FPropertyTag InnerTag;
+		Ar << InnerTag;
+
+		if (InnerTag.StructName != FTrajectoryPoint::StaticStruct()->GetFName())
+		{
+			return false;
+		}
+	}
+
+	Reset();
+
+	for (int32 i = 0; i < NumSavedPoints; ++i)
+	{
+		FTrajectoryPoint Point;
+		FTrajectoryPoint::StaticStruct()->SerializeItem(Ar, &Point, nullptr);
+
+		// Points past the capacity can not be searched, CanHoldIntervals keeps new bakes within it
+		if (NumPoints < MaxPoints)
+		{
+			Add(Point.Location, Point.Rotation, Point.Time);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MotionTrajectory.generated.h"
+
+/** The maximum amount of trajectory points, this has to be at least the number of trajectory intervals used to bake the database */
+#define MOTION_TRAJECTORY_MAX_POINTS 8
+
+/**
+ * Fixed capacity trajectory with inline storage.
+ * Used by the goal, the baked frame data and the cost functions so building and comparing trajectories never allocates.
+ */
+USTRUCT(BlueprintType)
+struct MOTIONMATCHING_API FMotionTrajectory
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	static const int32 MaxPoints = MOTION_TRAJECTORY_MAX_POINTS;
+
+	FMotionTrajectory();
+
+	/** Adds a point to the end of the trajectory, exceeding the capacity asserts (builds without checks drop the point) */
+	FORCEINLINE void Add(const FVector& InLocation, const FQuat& InRotation, const float InTime)
+	{
+		checkf(NumPoints < MaxPoints, TEXT("Trajectory capacity exceeded, increase MOTION_TRAJECTORY_MAX_POINTS"));
+
+		if (NumPoints < MaxPoints)
+		{
+			Locations[NumPoints] = InLocation;
+			Rotations[NumPoints] = InRotation;
+			Times[NumPoints] = InTime;
+			++NumPoints;
+		}
+	}
+
+	FORCEINLINE void Reset() { NumPoints = 0; }
+	FORCEINLINE int32 Num() const { return NumPoints; }
+
+	FORCEINLINE const FVector& GetLocation(const int32 Index) const { check(Index < NumPoints); return Locations[Index]; }
+	FORCEINLINE const FQuat& GetRotation(const int32 Index) const { check(Index < NumPoints); return Rotations[Index]; }
+	FORCEINLINE float GetTime(const int32 Index) const { check(Index < NumPoints); return Times[Index]; }
+
+	/** Sum of the distances between the matching points of both trajectories, only the axes set in the mask are compared */
+	float ComputeCost(const FMotionTrajectory& Other, const FVector& AxisMask) const;
+
+	/** Returns true when the trajectory can hold a point for every interval */
+	static bool CanHoldIntervals(const TArray<float>& TrajectoryIntervals);
+
+	/** Loads trajectories that were saved as TArray<FTrajectoryPoint>, before the trajectory had a fixed capacity */
+	bool SerializeFromMismatchedTag(const struct FPropertyTag& Tag, FArchive& Ar);
+
+private:
+	UPROPERTY()
+	FVector Locations[MOTION_TRAJECTORY_MAX_POINTS];
+
+	UPROPERTY()
+	FQuat Rotations[MOTION_TRAJECTORY_MAX_POINTS];
+
+	UPROPERTY()
+	float Times[MOTION_TRAJECTORY_MAX_POINTS];
+
+	UPROPERTY()
+	int32 NumPoints;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMotionTrajectory> : public TStructOpsTypeTraitsBase2<FMotionTrajectory>
+{
+	enum
+	{
+		WithSerializeFromMismatchedTag = true,
+	};
+};
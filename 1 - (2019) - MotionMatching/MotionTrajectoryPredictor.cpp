@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionTrajectoryPredictor.h"
+#include "MotionMatchingUtilities.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+
+
+namespace TrajectoryPredictorGlobals
+{
+	FORCEINLINE float HalfLifeToDamping(const float HalfLife)
+	{
+		// ln(2) * 4, see "Spring-It-On: The Game Developer's Spring-Roll-Call" by Daniel Holden
+		return (4.0f * 0.69314718056f) / (HalfLife + KINDA_SMALL_NUMBER);
+	}
+}
+
+
+FMotionTrajectoryPredictor::FMotionTrajectoryPredictor()
+	: VelocityHalfLife(0.3f)
+	, FacingHalfLife(0.2f)
+	, TeleportSpeed(5000.0f)
+	, MaxAcceleration(4000.0f)
+	, HistoryLength(1.0f)
+	, HistorySampleInterval(0.1f)
+	, Location(FVector::ZeroVector)
+	, Velocity(FVector::ZeroVector)
+	, Acceleration(FVector::ZeroVector)
+	, DesiredVelocity(FVector::ZeroVector)
+	, Yaw(0.0f)
+	, AngularVelocity(0.0f)
+	, DesiredYaw(0.0f)
+	, TimeSinceLastHistoryPoint(0.0f)
+{
+	History.Empty();
+}
+
+void FMotionTrajectoryPredictor::Reset(const FVector& InLocation, const float InYaw)
+{
+	Location = InLocation;
+	Velocity = FVector::ZeroVector;
+	Acceleration = FVector::ZeroVector;
+	DesiredVelocity = FVector::ZeroVector;
+	Yaw = InYaw;
+	AngularVelocity = 0.0f;
+	DesiredYaw = InYaw;
+	TimeSinceLastHistoryPoint = 0.0f;
+
+	History.Reset();
+}
+
+void FMotionTrajectoryPredictor::Update(const float DeltaTime, const FVector& InLocation, const float InYaw, const FVector& InDesiredVelocity, const float InDesiredYaw)
+{
+	if (DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	// The simulation always starts from where the character actually is, the springs only describe the future
+	const FVector NewVelocity = (InLocation - Location) / DeltaTime;
+	const float NewAngularVelocity = FRotator::NormalizeAxis(InYaw - Yaw) / DeltaTime;
+
+	// A teleport has no velocity, predicting from it would send the trajectory off the map
+	if (NewVelocity.SizeSquared() > FMath::Square(TeleportSpeed))
+	{
+		Reset(InLocation, InYaw);
+		DesiredVelocity = InDesiredVelocity;
+		DesiredYaw = InDesiredYaw;
+
+		RecordHistory(DeltaTime);
+		return;
+	}
+
+	// The acceleration is the difference of two differences, it spikes on uneven frames
+	Acceleration = ((NewVelocity - Velocity) / DeltaTime).GetClampedToMaxSize(MaxAcceleration);
+	Velocity = NewVelocity;
+	AngularVelocity = NewAngularVelocity;
+	Location = InLocation;
+	Yaw = InYaw;
+
+	DesiredVelocity = InDesiredVelocity;
+	DesiredYaw = InDesiredYaw;
+
+	RecordHistory(DeltaTime);
+}
+
+void FMotionTrajectoryPredictor::PredictAtTime(const float InTime, FVector& OutLocation, float& OutYaw) const
+{
+	// Critically damped spring on the velocity, integrated analytically to get the position
+	const float VelocityDamping = TrajectoryPredictorGlobals::HalfLifeToDamping(VelocityHalfLife) / 2.0f;
+	const FVector J0 = Velocity - DesiredVelocity;
+	const FVector J1 = Acceleration + J0 * VelocityDamping;
+	const float VelocityExp = FMath::Exp(-VelocityDamping * InTime);
+	const float SquaredDamping = VelocityDamping * VelocityDamping;
+
+	OutLocation = VelocityExp * ((-J1 / SquaredDamping) + ((-J0 - J1 * InTime) / VelocityDamping))
+		+ (J1 / SquaredDamping) + (J0 / VelocityDamping) + (DesiredVelocity * InTime) + Location;
+
+	// Critically damped spring on the facing
+	const float FacingDamping = TrajectoryPredictorGlobals::HalfLifeToDamping(FacingHalfLife) / 2.0f;
+	const float YawJ0 = FRotator::NormalizeAxis(Yaw - DesiredYaw);
+	const float YawJ1 = AngularVelocity + YawJ0 * FacingDamping;
+	const float FacingExp = FMath::Exp(-FacingDamping * InTime);
+
+	OutYaw = FacingExp * (YawJ0 + YawJ1 * InTime) + DesiredYaw;
+}
+
+void FMotionTrajectoryPredictor::PredictGoal(const TArray<float>& TrajectoryIntervals, const FTransform& CharacterMeshTM, FGoal& OutGoal) const
+{
+	check(FMotionTrajectory::CanHoldIntervals(TrajectoryIntervals));
+
+	OutGoal.DesiredTrajectory.Reset();
+
+	for (const float TrajectoryInterval : TrajectoryIntervals)
+	{
+		FVector PredictedLocation;
+		float PredictedYaw;
+		PredictAtTime(TrajectoryInterval, PredictedLocation, PredictedYaw);
+
+		const FTransform TrajectoryPointTM(FRotator(0.0f, PredictedYaw, 0.0f), PredictedLocation);
+		const FTransform RelativeTM = TrajectoryPointTM.GetRelativeTransform(CharacterMeshTM);
+
+		OutGoal.DesiredTrajectory.Add(RelativeTM.GetTranslation(), RelativeTM.GetRotation(), TrajectoryInterval);
+	}
+}
+
+void FMotionTrajectoryPredictor::RecordHistory(const float DeltaTime)
+{
+	for (FTrajectoryHistoryPoint& Point : History)
+	{
+		Point.Time -= DeltaTime;
+	}
+
+	// Drop the points that are older than the history length, they are stored oldest first
+	int32 NumExpired = 0;
+	while (NumExpired < History.Num() && History[NumExpired].Time < -HistoryLength)
+	{
+		++NumExpired;
+	}
+
+	if (NumExpired > 0)
+	{
+		History.RemoveAt(0, NumExpired, false);
+	}
+
+	TimeSinceLastHistoryPoint += DeltaTime;
+
+	if (History.Num() == 0 || TimeSinceLastHistoryPoint >= HistorySampleInterval)
+	{
+		FTrajectoryHistoryPoint Point;
+		Point.Location = Location;
+		Point.Yaw = Yaw;
+		Point.Time = 0.0f;
+
+		History.Add(Point);
+		TimeSinceLastHistoryPoint = 0.0f;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UMotionTrajectoryComponent
+//////////////////////////////////////////////////////////////////////////
+
+UMotionTrajectoryComponent::UMotionTrajectoryComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	// Predict after the character has moved so the goal is based on this frames movement
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	TrajectoryIntervals = FMotionMatchingUtils::TrajectoryIntervals;
+	bDrawDebugTrajectory = false;
+
+	CharacterMovement = nullptr;
+	CharacterMesh = nullptr;
+}
+
+void UMotionTrajectoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (ACharacter* Character = Cast<ACharacter>(GetOwner()))
+	{
+		CharacterMovement = Character->GetCharacterMovement();
+		CharacterMesh = Character->GetMesh();
+
+		Predictor.Reset(GetCharacterMeshTransform().GetLocation(), Character->GetActorRotation().Yaw);
+	}
+
+	if (!FMotionTrajectory::CanHoldIntervals(TrajectoryIntervals))
+	{
+		UE_LOG(LogAnimation, Warning, TEXT("%s has more trajectory intervals than a motion trajectory can hold (%d), the last intervals are ignored."), *GetName(), FMotionTrajectory::MaxPoints);
+		TrajectoryIntervals.SetNum(FMotionTrajectory::MaxPoints);
+	}
+}
+
+void UMotionTrajectoryComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	AActor* Owner = GetOwner();
+
+	if (Owner && CharacterMovement)
+	{
+		const FVector DesiredVelocity = GetDesiredVelocity();
+		const float DesiredYaw = GetDesiredYaw(DesiredVelocity);
+
+		// The goal is relative to the mesh, which sits at the feet, the actor location is the center of the capsule
+		const FTransform CharacterMeshTM = GetCharacterMeshTransform();
+		Predictor.Update(DeltaTime, CharacterMeshTM.GetLocation(), Owner->GetActorRotation().Yaw, DesiredVelocity, DesiredYaw);
+
+		Predictor.PredictGoal(TrajectoryIntervals, CharacterMeshTM, Goal);
+
+		if (bDrawDebugTrajectory)
+		{
+			UMotionMatchingUtilities::DrawDebugGoal(GetWorld(), Goal, CharacterMeshTM);
+
+			const TArray<FTrajectoryHistoryPoint>& History = Predictor.GetHistory();
+			for (int i = 1; i < History.Num(); ++i)
+			{
+				DrawDebugLine(GetWorld(), History[i - 1].Location, History[i].Location, FColor::Green, false, -1.0f, 0, 2.0f);
+			}
+		}
+	}
+}
+
+FVector UMotionTrajectoryComponent::GetDesiredVelocity() const
+{
+	check(CharacterMovement);
+
+	// The input acceleration describes where the player wants to go, scale it to the speed the character can reach
+	const FVector InputAcceleration = CharacterMovement->GetCurrentAcceleration();
+	const float MaxAcceleration = CharacterMovement->GetMaxAcceleration();
+
+	if (MaxAcceleration <= KINDA_SMALL_NUMBER || InputAcceleration.IsNearlyZero())
+	{
+		return FVector::ZeroVector;
+	}
+
+	const float InputStrength = FMath::Clamp(InputAcceleration.Size() / MaxAcceleration, 0.0f, 1.0f);
+	return InputAcceleration.GetSafeNormal2D() * CharacterMovement->GetMaxSpeed() * InputStrength;
+}
+
+float UMotionTrajectoryComponent::GetDesiredYaw(const FVector& InDesiredVelocity) const
+{
+	check(CharacterMovement);
+
+	const AActor* Owner = GetOwner();
+	const APawn* Pawn = Cast<APawn>(Owner);
+
+	if (CharacterMovement->bUseControllerDesiredRotation && Pawn && Pawn->GetController())
+	{
+		return Pawn->GetController()->GetControlRotation().Yaw;
+	}
+
+	if (CharacterMovement->bOrientRotationToMovement && !InDesiredVelocity.IsNearlyZero())
+	{
+		return InDesiredVelocity.Rotation().Yaw;
+	}
+
+	return Owner ? Owner->GetActorRotation().Yaw : 0.0f;
+}
+
+FTransform UMotionTrajectoryComponent::GetCharacterMeshTransform() const
+{
+	if (CharacterMesh)
+	{
+		return CharacterMesh->GetComponentTransform();
+	}
+
+	return GetOwner() ? GetOwner()->GetActorTransform() : FTransform::Identity;
+}
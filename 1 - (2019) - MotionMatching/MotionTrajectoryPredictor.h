@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Goal.h"
+#include "MotionTrajectoryPredictor.generated.h"
+
+class UCharacterMovementComponent;
+class USkeletalMeshComponent;
+
+/** A single point of the trajectory history, stored in world space */
+USTRUCT(BlueprintType)
+struct MOTIONMATCHING_API FTrajectoryHistoryPoint
+{
+	GENERATED_USTRUCT_BODY()
+
+	FTrajectoryHistoryPoint()
+		: Location(FVector::ZeroVector)
+		, Yaw(0.0f)
+		, Time(0.0f)
+	{
+	}
+
+	UPROPERTY(Category = "Trajectory", VisibleAnywhere, BlueprintReadOnly)
+	FVector Location;
+
+	UPROPERTY(Category = "Trajectory", VisibleAnywhere, BlueprintReadOnly)
+	float Yaw;
+
+	/** Time in seconds relative to now, always negative or zero */
+	UPROPERTY(Category = "Trajectory", VisibleAnywhere, BlueprintReadOnly)
+	float Time;
+};
+
+/**
+ * Predicts the future trajectory of a character with critically damped springs on velocity and facing.
+ * Unlike UMotionMatchingUtilities::MakeGoal the predicted trajectory curves and accelerates like the character would,
+ * which keeps the desired trajectory close to the motion in the database and reduces the amount of winner switches.
+ */
+USTRUCT(BlueprintType)
+struct MOTIONMATCHING_API FMotionTrajectoryPredictor
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FMotionTrajectoryPredictor();
+
+	/** Time it takes for the velocity to cover half of the distance to the desired velocity */
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.01f))
+	float VelocityHalfLife;
+
+	/** Time it takes for the facing to cover half of the distance to the desired facing */
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.01f))
+	float FacingHalfLife;
+
+	/** A move faster than this between two updates is treated as a teleport, the predictor snaps to the new location instead of accelerating towards it */
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float TeleportSpeed;
+
+	/** The measured acceleration is clamped to this, a single long frame would otherwise throw the prediction far off */
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float MaxAcceleration;
+
+	/** How many seconds of past trajectory we keep track of */
+	UPROPERTY(Category = "Trajectory|History", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.0f))
+	float HistoryLength;
+
+	/** The interval at which a new history point is recorded */
+	UPROPERTY(Category = "Trajectory|History", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.01f))
+	float HistorySampleInterval;
+
+public:
+	/** Synchronizes the predictor with the actual movement of the character and records the history, InLocation is the location of the character mesh */
+	void Update(const float DeltaTime, const FVector& InLocation, const float InYaw, const FVector& InDesiredVelocity, const float InDesiredYaw);
+
+	/** Writes the predicted trajectory at the given intervals into the goal, relative to the character mesh */
+	void PredictGoal(const TArray<float>& TrajectoryIntervals, const FTransform& CharacterMeshTM, FGoal& OutGoal) const;
+
+	/** Returns the predicted world location and yaw at the given time in the future */
+	void PredictAtTime(const float InTime, FVector& OutLocation, float& OutYaw) const;
+
+	/** Clears the history and snaps the predictor to the given state */
+	void Reset(const FVector& InLocation, const float InYaw);
+
+	const TArray<FTrajectoryHistoryPoint>& GetHistory() const { return History; }
+
+private:
+	void RecordHistory(const float DeltaTime);
+
+private:
+	FVector Location;
+	FVector Velocity;
+	FVector Acceleration;
+	FVector DesiredVelocity;
+
+	float Yaw;
+	float AngularVelocity;
+	float DesiredYaw;
+
+	float TimeSinceLastHistoryPoint;
+
+	/** Oldest point first */
+	TArray<FTrajectoryHistoryPoint> History;
+};
+
+/**
+ * Drives a FMotionTrajectoryPredictor from the character movement component of the owning character
+ * and exposes the predicted trajectory as a goal for the motion matching node.
+ */
+UCLASS(ClassGroup = (Animation), meta = (BlueprintSpawnableComponent))
+class MOTIONMATCHING_API UMotionTrajectoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMotionTrajectoryComponent(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite)
+	FMotionTrajectoryPredictor Predictor;
+
+	/** The future times in seconds at which the goal trajectory is sampled, these should match the intervals used to bake the database */
+	UPROPERTY(Category = "Trajectory", EditAnywhere, BlueprintReadWrite)
+	TArray<float> TrajectoryIntervals;
+
+	UPROPERTY(Category = "Trajectory|Debug", EditAnywhere, BlueprintReadWrite)
+	bool bDrawDebugTrajectory;
+
+public:
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Returns the goal that was predicted during the last tick */
+	UFUNCTION(Category = "Trajectory", BlueprintCallable, BlueprintPure)
+	const FGoal& GetGoal() const { return Goal; }
+
+private:
+	FVector GetDesiredVelocity() const;
+	float GetDesiredYaw(const FVector& InDesiredVelocity) const;
+	FTransform GetCharacterMeshTransform() const;
+
+private:
+	UPROPERTY(Transient)
+	UCharacterMovementComponent* CharacterMovement;
+
+	UPROPERTY(Transient)
+	USkeletalMeshComponent* CharacterMesh;
+
+	FGoal Goal;
+};
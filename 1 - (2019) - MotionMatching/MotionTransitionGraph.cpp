@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MotionTransitionGraph.h"
+#include "MotionDatabaseSnapshot.h"
+#include "MotionMatchingQuery.h"
+#include "Async/ParallelFor.h"
+
+
+void FMotionTransitionGraph::Build(
+	const FMotionFeatureLayout& InLayout,
+	const FMotionFrameInfo* InFrames,
+	const float* InFeatures,
+	const int32 InNumFrames,
+	const int32 InFramesPerSegment,
+	const int32 InTransitionsPerSegment,
+	TArray<int32>& OutFrameSegments,
+	TArray<int32>& OutTransitions)
+{
+	OutFrameSegments.Init(INDEX_NONE, InNumFrames);
+	OutTransitions.Reset();
+
+	const int32 FramesPerSegment = FMath::Max(1, InFramesPerSegment);
+	const int32 TransitionsPerSegment = FMath::Max(1, InTransitionsPerSegment);
+
+	// The frame in the middle of every segment stands in for the whole segment
+	TArray<int32> SegmentCenters;
+
+	ForEachAnimationTrack(InFrames, InNumFrames, [&](const TArray<int32>& SortedFrames)
+	{
+		for (int32 FirstFrame = 0; FirstFrame < SortedFrames.Num(); FirstFrame += FramesPerSegment)
+		{
+			const int32 NumSegmentFrames = FMath::Min(FramesPerSegment, SortedFrames.Num() - FirstFrame);
+			const int32 SegmentIndex = SegmentCenters.Add(SortedFrames[FirstFrame + NumSegmentFrames / 2]);
+
+			for (int32 Frame = FirstFrame; Frame < FirstFrame + NumSegmentFrames; ++Frame)
+			{
+				OutFrameSegments[SortedFrames[Frame]] = SegmentIndex;
+			}
+		}
+	});
+
+	const int32 NumSegments = SegmentCenters.Num();
+	OutTransitions.Init(INDEX_NONE, NumSegments * TransitionsPerSegment);
+
+	const int32 Stride = InLayout.GetStride();
+
+	ParallelFor(NumSegments, [&](int32 SourceSegment)
+	{
+		FMotionMatchingQuery Query;
+		Query.BuildFromFeatures(InLayout, InFeatures + SegmentCenters[SourceSegment] * Stride);
+
+		// Best frame of every other segment, so the targets are spread over the database instead of being neighbours of each other
+		TArray<int32> BestFrames;
+		TArray<float> BestCosts;
+		BestFrames.Init(INDEX_NONE, NumSegments);
+		BestCosts.Init(BIG_NUMBER, NumSegments);
+
+		for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+		{
+			const int32 TargetSegment = OutFrameSegments[FrameIndex];
+			if (TargetSegment == SourceSegment || TargetSegment == INDEX_NONE)
+			{
+				continue;
+			}
+
+			// Only the part of the cost that does not depend on the goal
+			const float Cost = Query.ComputeCurrentCost(InFeatures + FrameIndex * Stride);
+			if (Cost < BestCosts[TargetSegment])
+			{
+				BestCosts[TargetSegment] = Cost;
+				BestFrames[TargetSegment] = FrameIndex;
+			}
+		}
+
+		TArray<int32> TargetSegments;
+		TargetSegments.Reserve(NumSegments);
+		for (int32 TargetSegment = 0; TargetSegment < NumSegments; ++TargetSegment)
+		{
+			if (BestFrames[TargetSegment] != INDEX_NONE)
+			{
+				TargetSegments.Add(TargetSegment);
+			}
+		}
+
+		TargetSegments.Sort([&BestCosts](const int32 A, const int32 B) { return BestCosts[A] < BestCosts[B]; });
+
+		int32* Transitions = OutTransitions.GetData() + SourceSegment * TransitionsPerSegment;
+		for (int32 TransitionIndex = 0; TransitionIndex < FMath::Min(TransitionsPerSegment, TargetSegments.Num()); ++TransitionIndex)
+		{
+			Transitions[TransitionIndex] = BestFrames[TargetSegments[TransitionIndex]];
+		}
+	});
+}
+
+void FMotionTransitionGraph::ForEachAnimationTrack(const FMotionFrameInfo* InFrames, const int32 InNumFrames, TFunctionRef<void(const TArray<int32>&)> InVisitor)
+{
+	// Mirrored frames are played from the same animation, but they are a different track
+	TMap<uint64, TArray<int32>> Tracks;
+	for (int32 FrameIndex = 0; FrameIndex < InNumFrames; ++FrameIndex)
+	{
+		const uint64 TrackKey = ((uint64)(uint32)InFrames[FrameIndex].SourceAnimationIndex << 1) | (InFrames[FrameIndex].bMirrored ? 1 : 0);
+		Tracks.FindOrAdd(TrackKey).Add(FrameIndex);
+	}
+
+	// Visit the tracks in a fixed order, so the same frames always produce the same segments
+	Tracks.KeySort(TLess<uint64>());
+
+	for (TPair<uint64, TArray<int32>>& Track : Tracks)
+	{
+		Track.Value.Sort([InFrames](const int32 A, const int32 B) { return InFrames[A].StartTime < InFrames[B].StartTime; });
+		InVisitor(Track.Value);
+	}
+}
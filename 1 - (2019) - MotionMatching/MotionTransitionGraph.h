@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "MotionTransitionGraph.generated.h"
+
+struct FMotionFeatureLayout;
+struct FMotionFrameInfo;
+
+/**
+ * Turns an animation database into a motion graph: the frames are split into short segments of consecutive frames,
+ * and every segment stores the frames it can plausibly jump to. A search that knows the current frame only has to
+ * look at the targets of its segment, so its cost no longer depends on the size of the database.
+ */
+USTRUCT()
+struct MOTIONMATCHING_API FMotionTransitionGraphSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FMotionTransitionGraphSettings()
+		: bBuildTransitionGraph(false)
+		, FramesPerSegment(5)
+		, TransitionsPerSegment(32)
+	{
+	}
+
+	/** Build the transition graph into the search payload when cooking, and in the background in the editor. Building it is quadratic in the number of frames */
+	UPROPERTY(EditAnywhere, Category = "Transition Graph")
+	bool bBuildTransitionGraph;
+
+	/** Number of consecutive frames of an animation that share their transitions */
+	UPROPERTY(EditAnywhere, Category = "Transition Graph", meta = (ClampMin = 1, EditCondition = "bBuildTransitionGraph"))
+	int32 FramesPerSegment;
+
+	/** Number of targets every segment keeps, at most one per target segment */
+	UPROPERTY(EditAnywhere, Category = "Transition Graph", meta = (ClampMin = 1, EditCondition = "bBuildTransitionGraph"))
+	int32 TransitionsPerSegment;
+};
+
+class MOTIONMATCHING_API FMotionTransitionGraph
+{
+public:
+	/**
+	 * Splits the frames into segments and finds the targets of every segment, ranked by how well their pose and velocity
+	 * match the middle frame of the segment. The goal is not part of the ranking, it is only known when searching.
+	 * OutFrameSegments holds the segment of every frame, OutTransitions holds InTransitionsPerSegment frames per segment,
+	 * padded with INDEX_NONE.
+	 */
+	static void Build(
+		const FMotionFeatureLayout& InLayout,
+		const FMotionFrameInfo* InFrames,
+		const float* InFeatures,
+		const int32 InNumFrames,
+		const int32 InFramesPerSegment,
+		const int32 InTransitionsPerSegment,
+		TArray<int32>& OutFrameSegments,
+		TArray<int32>& OutTransitions);
+
+	/** Sorts the frames of every animation (mirrored frames separately) by time, and calls the visitor once per animation */
+	static void ForEachAnimationTrack(const FMotionFrameInfo* InFrames, const int32 InNumFrames, TFunctionRef<void(const TArray<int32>& /*SortedFrames*/)> InVisitor);
+};
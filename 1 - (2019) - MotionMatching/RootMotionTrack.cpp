@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RootMotionTrack.h"
+#include "Animation/AnimSequence.h"
+
+
+FRootMotionTrack::FRootMotionTrack()
+	: SampleRate(0.0f)
+	, Length(0.0f)
+{
+	Positions.Empty();
+	Yaws.Empty();
+}
+
+void FRootMotionTrack::Bake(const UAnimSequence* InAnimSequence, const float InSampleRate)
+{
+	Positions.Empty();
+	Yaws.Empty();
+	SampleRate = 0.0f;
+	Length = 0.0f;
+
+	if (InAnimSequence && InSampleRate > 0.0f)
+	{
+		Length = InAnimSequence->GetPlayLength();
+
+		// Adjust the sample rate slightly so the last sample lands exactly on the end of the animation
+		const int32 NumIntervals = FMath::Max(1, FMath::CeilToInt(Length * InSampleRate));
+		SampleRate = Length > KINDA_SMALL_NUMBER ? (NumIntervals / Length) : InSampleRate;
+
+		const int32 NumSamples = NumIntervals + 1;
+
+		Positions.Reserve(NumSamples);
+		Yaws.Reserve(NumSamples);
+
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			const float SampleTime = FMath::Min(SampleIndex / SampleRate, Length);
+			const FTransform RootMotionTM = InAnimSequence->ExtractRootMotion(0.0f, SampleTime, false);
+
+			// Unwind the yaw so neighbouring samples never wrap around +-180 degrees
+			const float RawYaw = RootMotionTM.Rotator().Yaw;
+			const float Yaw = Yaws.Num() > 0 ? Yaws.Last() + FRotator::NormalizeAxis(RawYaw - Yaws.Last()) : RawYaw;
+
+			Positions.Add(RootMotionTM.GetTranslation());
+			Yaws.Add(Yaw);
+		}
+	}
+}
+
+FTransform FRootMotionTrack::GetRootTransformAtTime(const float InTime) const
+{
+	if (!IsValid())
+	{
+		return FTransform::Identity;
+	}
+
+	const float SamplePosition = FMath::Clamp(InTime, 0.0f, Length) * SampleRate;
+	const int32 SampleIndex = FMath::Min(FMath::FloorToInt(SamplePosition), Positions.Num() - 1);
+	const int32 NextSampleIndex = FMath::Min(SampleIndex + 1, Positions.Num() - 1);
+	const float Alpha = FMath::Clamp(SamplePosition - SampleIndex, 0.0f, 1.0f);
+
+	const FVector Position = FMath::Lerp(Positions[SampleIndex], Positions[NextSampleIndex], Alpha);
+	const float Yaw = FMath::Lerp(Yaws[SampleIndex], Yaws[NextSampleIndex], Alpha);
+
+	return FTransform(FRotator(0.0f, Yaw, 0.0f), Position);
+}
+
+FTransform FRootMotionTrack::ExtractRootMotion(const float InStartTime, const float InDeltaTime, const bool bAllowLooping) const
+{
+	if (!IsValid())
+	{
+		return FTransform::Identity;
+	}
+
+	const float StartTime = FMath::Clamp(InStartTime, 0.0f, Length);
+	const float EndTime = StartTime + InDeltaTime;
+
+	if (EndTime <= Length || !bAllowLooping)
+	{
+		return GetRootMotionBetween(StartTime, FMath::Min(EndTime, Length));
+	}
+
+	// Wrap around the end of the animation the same way UAnimSequence::ExtractRootMotion does
+	FTransform RootMotionTM = GetRootMotionBetween(StartTime, Length);
+	float RemainingTime = EndTime - Length;
+
+	while (RemainingTime > 0.0f)
+	{
+		const float SegmentTime = FMath::Min(RemainingTime, Length);
+		RootMotionTM = GetRootMotionBetween(0.0f, SegmentTime) * RootMotionTM;
+		RemainingTime -= SegmentTime;
+
+		if (Length <= KINDA_SMALL_NUMBER)
+		{
+			break;
+		}
+	}
+
+	return RootMotionTM;
+}
+
+FVector FRootMotionTrack::GetVelocity(const float InTime, const float InDeltaTime) const
+{
+	if (InDeltaTime <= 0.0f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	const FVector Translation = ExtractRootMotion(InTime, InDeltaTime, true).GetTranslation();
+	return Translation.GetSafeNormal() * (Translation.Size() / InDeltaTime);
+}
+
+bool FRootMotionTrack::IsValid() const
+{
+	return SampleRate > 0.0f && Positions.Num() > 0 && Positions.Num() == Yaws.Num();
+}
+
+FTransform FRootMotionTrack::GetRootMotionBetween(const float InStartTime, const float InEndTime) const
+{
+	const FTransform StartTM = GetRootTransformAtTime(InStartTime);
+	const FTransform EndTM = GetRootTransformAtTime(InEndTime);
+
+	// Express the end transform in the space of the root at the start time
+	return EndTM.GetRelativeTransform(StartTM);
+}
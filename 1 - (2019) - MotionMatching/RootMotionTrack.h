@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RootMotionTrack.generated.h"
+
+class UAnimSequence;
+
+/**
+ * Uniformly sampled root motion of a single source animation, baked into the animation database.
+ * Root motion queries are interpolated from the baked samples so they never have to touch the animation data.
+ */
+USTRUCT()
+struct MOTIONMATCHING_API FRootMotionTrack
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FRootMotionTrack();
+
+	/** Samples the root motion of the animation at the given sample rate (samples per second) */
+	void Bake(const UAnimSequence* InAnimSequence, const float InSampleRate);
+
+	/** Returns the accumulated root transform at the given time, relative to the start of the animation */
+	FTransform GetRootTransformAtTime(const float InTime) const;
+
+	/** Returns the root motion between StartTime and StartTime + DeltaTime, relative to the root at StartTime */
+	FTransform ExtractRootMotion(const float InStartTime, const float InDeltaTime, const bool bAllowLooping) const;
+
+	/** Returns the root velocity over the window that starts at the given time */
+	FVector GetVelocity(const float InTime, const float InDeltaTime) const;
+
+	bool IsValid() const;
+
+	float GetLength() const { return Length; }
+
+private:
+	FTransform GetRootMotionBetween(const float InStartTime, const float InEndTime) const;
+
+public:
+	/** Number of samples per second */
+	UPROPERTY()
+	float SampleRate;
+
+	/** Play length of the animation this track was baked from */
+	UPROPERTY()
+	float Length;
+
+	/** Accumulated root positions, one per sample */
+	UPROPERTY()
+	TArray<FVector> Positions;
+
+	/** Accumulated root yaw in degrees, one per sample */
+	UPROPERTY()
+	TArray<float> Yaws;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ZiplineCollisionComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Engine/CollisionProfile.h"
+
+
+UZiplineCollisionComponent::UZiplineCollisionComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	// Same settings the per segment collision meshes had
+	SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+	SetHiddenInGame(true);
+	bGenerateOverlapEvents = false;
+
+	CollisionBodySetup = nullptr;
+}
+
+void UZiplineCollisionComponent::SetCapsules(const TArray<FKSphylElem>& InCapsules)
+{
+	Capsules = InCapsules;
+
+	UpdateBodySetup();
+	UpdateBounds();
+
+	if (bPhysicsStateCreated)
+	{
+		RecreatePhysicsState();
+	}
+}
+
+UBodySetup* UZiplineCollisionComponent::GetBodySetup()
+{
+	if (!CollisionBodySetup)
+	{
+		UpdateBodySetup();
+	}
+
+	return CollisionBodySetup;
+}
+
+FBoxSphereBounds UZiplineCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (Capsules.Num() == 0) { return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f); }
+
+	FBox Bounds(ForceInit);
+	for (const FKSphylElem& Capsule : Capsules)
+	{
+		Bounds += Capsule.CalcAABB(LocalToWorld, 1.f);
+	}
+
+	return FBoxSphereBounds(Bounds);
+}
+
+void UZiplineCollisionComponent::UpdateBodySetup()
+{
+	if (!CollisionBodySetup)
+	{
+		CollisionBodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		if (!CollisionBodySetup) { return; }
+
+		CollisionBodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		CollisionBodySetup->bGenerateMirroredCollision = false;
+	}
+
+	// Every capsule is a shape of the same body, the broadphase only sees the body
+	CollisionBodySetup->InvalidatePhysicsData();
+	CollisionBodySetup->AggGeom.SphylElems = Capsules;
+	CollisionBodySetup->CreatePhysicsMeshes();
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/SphylElem.h"
+#include "ZiplineCollisionComponent.generated.h"
+
+
+class UBodySetup;
+
+/**
+ * A single collision body for the whole zipline rail, built from a compound of capsules.
+ * Replaces a spline mesh component per rail segment, so the physics scene holds one body per zipline.
+ */
+UCLASS(ClassGroup = (Collision), meta = (BlueprintSpawnableComponent))
+class BOUND_API UZiplineCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UZiplineCollisionComponent(const FObjectInitializer& ObjectInitializer);
+
+public:
+	/** Replaces the capsules, in the space of this component, and recreates the physics body */
+	void SetCapsules(const TArray<FKSphylElem>& InCapsules);
+
+	UFUNCTION(Category = "Zipline|Getters", BlueprintCallable)
+	FORCEINLINE int GetNumCapsules() const { return Capsules.Num(); }
+
+public:
+	virtual UBodySetup* GetBodySetup() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	void UpdateBodySetup();
+
+private:
+	UPROPERTY()
+	TArray<FKSphylElem> Capsules;
+
+	UPROPERTY(Transient, DuplicateTransient)
+	UBodySetup* CollisionBodySetup;
+};
@@ -2,6 +2,7 @@
 
 #include "bound.h"
 #include "Actors/Splines/Zipline/ZiplineAnchor.h"
+#include "Actors/Splines/Zipline/ZiplineCollisionComponent.h"
 #include "Actors/Mechanics/Rope/RopeSegment.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/PawnMovementComponent.h"
@@ -11,6 +12,8 @@
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/SplineMeshComponent.h"
+#include "ProceduralMeshComponent.h"
+#include "Engine/StaticMesh.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
@@ -33,6 +36,156 @@
 * I also added some camera options to allow for more cinematic effects while on the zipline.
 */
 
+/** The kinematic swing is integrated in steps of exactly this long, so it behaves the same at any frame rate */
+static const float KinematicSwingFixedStep = 1.f / 120.f;
+
+/** Steps per frame are capped so a long hitch does not stall the game thread, the time over the cap is dropped */
+static const int KinematicSwingMaxSteps = 16;
+
+/** Stops the swing at the limit, the same way a limited constraint would */
+static void ApplySwingLimit(float& Angle, float& AngularVelocity, const float MaxAngle)
+{
+	if (Angle > MaxAngle)
+	{
+		Angle = MaxAngle;
+		AngularVelocity = FMath::Min(AngularVelocity, 0.f);
+	}
+	else if (Angle < -MaxAngle)
+	{
+		Angle = -MaxAngle;
+		AngularVelocity = FMath::Max(AngularVelocity, 0.f);
+	}
+}
+
+/**
+ * The directions from the start of a capsule whose axis passes within the tolerance of every sample added so far.
+ * Kept as a single cone that always fits inside the exact set, so adding a sample takes constant time
+ * and growing a capsule never has to test the samples it already covers again.
+ */
+struct FZiplineCapsuleAxisCone
+{
+	FVector Axis = FVector::ForwardVector;
+
+	/** PI allows every direction */
+	float HalfAngle = PI;
+
+	bool Contains(const FVector& Offset) const
+	{
+		const FVector Direction = Offset.GetSafeNormal();
+		if (HalfAngle >= PI || Direction.IsZero()) { return true; }
+
+		return FMath::Acos(FMath::Clamp(FVector::DotProduct(Axis, Direction), -1.f, 1.f)) <= HalfAngle;
+	}
+
+	/** Narrows the cone to the directions that also pass within the tolerance of the sample, returns false when there are none left */
+	bool Narrow(const FVector& Offset, const float Tolerance)
+	{
+		// Every axis passes close enough to a sample this near the start
+		const float Distance = Offset.Size();
+		if (Distance <= Tolerance) { return true; }
+
+		const FVector SampleAxis = Offset / Distance;
+		const float SampleHalfAngle = FMath::Asin(Tolerance / Distance);
+
+		if (HalfAngle >= PI)
+		{
+			Axis = SampleAxis;
+			HalfAngle = SampleHalfAngle;
+			return true;
+		}
+
+		// The largest cone inside both is centered on the arc between the two axes
+		const float AngleBetween = FMath::Acos(FMath::Clamp(FVector::DotProduct(Axis, SampleAxis), -1.f, 1.f));
+		const float Lower = FMath::Max(-HalfAngle, AngleBetween - SampleHalfAngle);
+		const float Upper = FMath::Min(HalfAngle, AngleBetween + SampleHalfAngle);
+		if (Lower > Upper) { return false; }
+
+		const FVector RotationAxis = FVector::CrossProduct(Axis, SampleAxis).GetSafeNormal();
+		if (!RotationAxis.IsZero())
+		{
+			Axis = Axis.RotateAngleAxis(FMath::RadiansToDegrees((Lower + Upper) * 0.5f), RotationAxis);
+		}
+
+		HalfAngle = (Upper - Lower) * 0.5f;
+		return true;
+	}
+};
+
+
+///////////////////////////////////////////
+// Arc Length Table
+
+void FZiplineArcLengthTable::Build(const USplineComponent* Spline, float InSampleSpacing)
+{
+	Reset();
+
+	if (!Spline) { return; }
+	if (InSampleSpacing <= 0.f) { return; }
+
+	SplineLength = Spline->GetSplineLength();
+
+	// Spread the samples evenly so the last one lands exactly on the end of the spline
+	const int NumIntervals = FMath::Max(1, FMath::CeilToInt(SplineLength / InSampleSpacing));
+	SampleSpacing = SplineLength > KINDA_SMALL_NUMBER ? SplineLength / NumIntervals : InSampleSpacing;
+
+	Locations.Reserve(NumIntervals + 1);
+	Rotations.Reserve(NumIntervals + 1);
+	RightVectors.Reserve(NumIntervals + 1);
+
+	for (int SampleIndex = 0; SampleIndex <= NumIntervals; ++SampleIndex)
+	{
+		const float Distance = FMath::Min(SampleIndex * SampleSpacing, SplineLength);
+		const FQuat Rotation = Spline->GetQuaternionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::Local);
+
+		Locations.Add(Spline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::Local));
+		Rotations.Add(Rotation);
+		RightVectors.Add(Rotation.GetRightVector());
+	}
+}
+
+void FZiplineArcLengthTable::Reset()
+{
+	SampleSpacing = 0.f;
+	SplineLength = 0.f;
+	Locations.Empty();
+	Rotations.Empty();
+	RightVectors.Empty();
+}
+
+void FZiplineArcLengthTable::GetSamplesAtDistance(float Distance, int& OutIndex, int& OutNextIndex, float& OutAlpha) const
+{
+	const float SamplePosition = FMath::Clamp(Distance, 0.f, SplineLength) / SampleSpacing;
+	OutIndex = FMath::Min(FMath::FloorToInt(SamplePosition), Locations.Num() - 1);
+	OutNextIndex = FMath::Min(OutIndex + 1, Locations.Num() - 1);
+	OutAlpha = FMath::Clamp(SamplePosition - OutIndex, 0.f, 1.f);
+}
+
+FVector FZiplineArcLengthTable::GetLocationAtDistance(float Distance) const
+{
+	int Index, NextIndex;
+	float Alpha;
+	GetSamplesAtDistance(Distance, Index, NextIndex, Alpha);
+	return FMath::Lerp(Locations[Index], Locations[NextIndex], Alpha);
+}
+
+FQuat FZiplineArcLengthTable::GetRotationAtDistance(float Distance) const
+{
+	int Index, NextIndex;
+	float Alpha;
+	GetSamplesAtDistance(Distance, Index, NextIndex, Alpha);
+	return FQuat::FastLerp(Rotations[Index], Rotations[NextIndex], Alpha).GetNormalized();
+}
+
+FVector FZiplineArcLengthTable::GetRightVectorAtDistance(float Distance) const
+{
+	int Index, NextIndex;
+	float Alpha;
+	GetSamplesAtDistance(Distance, Index, NextIndex, Alpha);
+	return FMath::Lerp(RightVectors[Index], RightVectors[NextIndex], Alpha).GetSafeNormal();
+}
+
+///////////////////////////////////////////
+// Zipline Spline
 
 AZiplineSpline::AZiplineSpline(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -91,6 +244,19 @@ AZiplineSpline::AZiplineSpline(const FObjectInitializer& ObjectInitializer) : Su
 		RightPhysicsConstraintComponent->SetAngularTwistLimit(ACM_Limited, MaxTwistAngle);
 	}
 
+	CableProceduralMeshComponent = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("CableProceduralMeshComponent"));
+	if (CableProceduralMeshComponent && RootComponent) 
+	{
+		CableProceduralMeshComponent->SetupAttachment(RootComponent);
+		CableProceduralMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	RailCollisionComponent = CreateDefaultSubobject<UZiplineCollisionComponent>(TEXT("RailCollisionComponent"));
+	if (RailCollisionComponent && RootComponent) 
+	{
+		RailCollisionComponent->SetupAttachment(RootComponent);
+	}
+
 	RightRailSplineComponent = CreateDefaultSubobject<USplineComponent>(TEXT("RightRailSplineComponent"));
 	if (RightRailSplineComponent && RootComponent) 
 	{
@@ -106,6 +272,23 @@ void AZiplineSpline::BeginPlay()
 	ZiplineCamera = Cast<AZiplineCamera>(ZiplineCameraChildActorComponent->GetChildActor());
 	CoreGameInstance = UBPFL_Turtleneck::GetCoreGameInstance(this);
 	GameCamera = CoreGameInstance->GetGameCamera();
+
+	// The table is saved with the baked geometry, only build it for ziplines that were saved before it existed
+	if (!BakedGeometry.ArcLengthTable.IsValid()) 
+	{
+		BuildArcLengthTable();
+	}
+
+	// Construction scripts do not run for ziplines loaded with a cooked level, create the components the baked geometry needs here
+	ApplyBakedGeometry(false);
+}
+
+void AZiplineSpline::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	// Only generates the geometry when the baked data is out of date, otherwise it only creates what is missing
+	InitializeZipline();
 }
 
 void AZiplineSpline::Tick(float DeltaSeconds)
@@ -145,17 +328,22 @@ void AZiplineSpline::InitializeCharacter(ABasePlayerCharacter* Character, UPhysi
 	ShouldBlendToNewCamera(Character, ZiplineCamera);
 	PlayZiplineCameraEffects();
 
+	// The kinematic swing places the character itself, it needs neither the anchor nor its body in the physics scene
 	const float StartRopeLength = (MaxRopeLength + MinRopeLength) / 2;
-	AZiplineAnchor* SpawnedAnchor = InitializeAnchor(Character, TargetContraint, StartRopeLength);
+	AZiplineAnchor* SpawnedAnchor = bUseKinematicSwing ? nullptr : InitializeAnchor(Character, TargetContraint, StartRopeLength);
 
 	FZiplinePlayerData PlayerData;
 	PlayerData.RopeLength = -FMath::Abs(StartRopeLength);
 	PlayerData.SpawnedAnchor = SpawnedAnchor;
+	PlayerData.SwingPivot = TargetContraint;
 	PlayersData.Add(PlayerData);
 
-	TargetContraint->SetConstrainedComponents(PhysicsAnchorSphereComponent, TEXT("None"), SpawnedAnchor->PhysicsAnchorCapsuleComponent, TEXT("None"));
-	TargetContraint->SetConstraintReferencePosition(EConstraintFrame::Frame1, TargetContraint->RelativeLocation);
-	SpawnedAnchor->PhysicsAnchorCapsuleComponent->SetSimulatePhysics(true);
+	if (SpawnedAnchor) 
+	{
+		TargetContraint->SetConstrainedComponents(PhysicsAnchorSphereComponent, TEXT("None"), SpawnedAnchor->PhysicsAnchorCapsuleComponent, TEXT("None"));
+		TargetContraint->SetConstraintReferencePosition(EConstraintFrame::Frame1, TargetContraint->RelativeLocation);
+		SpawnedAnchor->PhysicsAnchorCapsuleComponent->SetSimulatePhysics(true);
+	}
 
 	Character->GetCharacterMovement()->SetMovementMode(MOVE_Falling);
 	Character->GetMovementComponent()->Velocity = FVector(0.f, 0.f, 0.f);
@@ -255,6 +443,12 @@ void AZiplineSpline::UpdateZipline(float DeltaTime)
 	CalculateSidewaySwing();
 	ShouldDetachFromZipline();
 
+	if (bUseKinematicSwing) 
+	{
+		UpdateKinematicSwing(DeltaTime);
+		return;
+	}
+
 	RightPhysicsConstraintComponent->SetConstraintReferencePosition(EConstraintFrame::Frame1, RightPhysicsConstraintComponent->RelativeLocation);
 	LeftPhysicsConstraintComponent->SetConstraintReferencePosition(EConstraintFrame::Frame1, LeftPhysicsConstraintComponent->RelativeLocation);
 
@@ -286,13 +480,100 @@ void AZiplineSpline::UpdateZipline(float DeltaTime)
 	}
 }
 
+void AZiplineSpline::UpdateKinematicSwing(float DeltaTime)
+{
+	if (!bZiplineEnabled) { return; }
+	if (DeltaTime <= 0.f) { return; }
+
+	const float Gravity = FMath::Abs(GetWorld()->GetGravityZ());
+	const float MaxSideAngle = FMath::DegreesToRadians(MaxTwistAngle);
+	const float MaxForwardAngle = FMath::DegreesToRadians(MaxAngularAngle);
+
+	for (int i = 0; i < RegisteredCharacters.Num(); ++i)
+	{
+		if (!RegisteredCharacters[i]) { continue; }
+		if (!PlayersData[i].SwingPivot) { continue; }
+
+		FZiplinePlayerData& PlayerData = PlayersData[i];
+
+		const FTransform PivotTransform = PlayerData.SwingPivot->GetComponentTransform();
+		const FVector PivotLocation = PivotTransform.GetLocation();
+		const float RopeLength = FMath::Max(FMath::Abs(PlayerData.RopeLength), 1.f);
+
+		const float InputAcceleration = PlayerData.SwingInput * SwingAcceleration;
+		const float MinAngularSpeed = MinVelocity / RopeLength;
+		const float MaxAngularSpeed = MaxVelocity / RopeLength;
+		const float ZiplineSpeed = GetZiplineSpeed(CurrentDistanceOnSpline);
+
+		FVector2D& Angles = PlayerData.SwingAngles;
+		FVector2D& AngularVelocity = PlayerData.SwingAngularVelocity;
+
+		PlayerData.SwingTimeAccumulator = FMath::Min(PlayerData.SwingTimeAccumulator + DeltaTime, KinematicSwingFixedStep * KinematicSwingMaxSteps);
+
+		while (PlayerData.SwingTimeAccumulator >= KinematicSwingFixedStep)
+		{
+			// Where the pivot was at the start of this step, the accumulator holds the time that is not stepped yet
+			const float StepDistance = CurrentDistanceOnSpline - ZiplineSpeed * PlayerData.SwingTimeAccumulator;
+
+			PlayerData.SwingTimeAccumulator -= KinematicSwingFixedStep;
+			PlayerData.PreviousSwingAngles = Angles;
+
+			// Speeding up and bends of the zipline push the rider the other way, taken from the rail instead of the frame times
+			const FVector PivotAcceleration = CalculateRailAcceleration(StepDistance);
+			const FQuat PivotRotation = GetRotationAtDistance(StepDistance, ESplineCoordinateSpace::World).Quaternion();
+			const float ForwardAcceleration = FVector::DotProduct(PivotAcceleration, PivotRotation.GetAxisX());
+			const float SideAcceleration = FVector::DotProduct(PivotAcceleration, PivotRotation.GetAxisY());
+
+			// Tangential accelerations of a pendulum hanging from an accelerating pivot, divided by the rope length
+			const float SideAngularAcceleration = (-Gravity * FMath::Sin(Angles.X) - SideAcceleration * FMath::Cos(Angles.X) + InputAcceleration) / RopeLength;
+			const float ForwardAngularAcceleration = (-Gravity * FMath::Sin(Angles.Y) + ForwardAcceleration * FMath::Cos(Angles.Y)) / RopeLength;
+
+			AngularVelocity.X += (SideAngularAcceleration - SwingDamping * AngularVelocity.X) * KinematicSwingFixedStep;
+			AngularVelocity.Y += (ForwardAngularAcceleration - SwingDamping * AngularVelocity.Y) * KinematicSwingFixedStep;
+
+			// Same clamp the anchors get in UpdateZipline, a swing that has come to rest is left at rest
+			const float AngularSpeed = AngularVelocity.Size();
+			if (AngularSpeed > MaxAngularSpeed) 
+			{
+				AngularVelocity = AngularVelocity.GetSafeNormal() * MaxAngularSpeed;
+			}
+			else if (AngularSpeed < MinAngularSpeed && AngularSpeed > KINDA_SMALL_NUMBER) 
+			{
+				AngularVelocity = AngularVelocity.GetSafeNormal() * MinAngularSpeed;
+			}
+
+			Angles += AngularVelocity * KinematicSwingFixedStep;
+
+			// Same limits the physics constraints use, twist is the sideways swing around the spline direction
+			ApplySwingLimit(Angles.X, AngularVelocity.X, MaxSideAngle);
+			ApplySwingLimit(Angles.Y, AngularVelocity.Y, MaxForwardAngle);
+		}
+
+		// The time left in the accumulator is less than a step, blend the last two steps so the rope does not stutter at high frame rates
+		const FVector2D DrawAngles = FMath::Lerp(PlayerData.PreviousSwingAngles, Angles, PlayerData.SwingTimeAccumulator / KinematicSwingFixedStep);
+		const FQuat SwingRotation = PivotTransform.GetRotation() * FQuat(FVector::ForwardVector, DrawAngles.X) * FQuat(FVector::RightVector, DrawAngles.Y);
+		const FVector Location = PivotLocation + SwingRotation.RotateVector(FVector(0.f, 0.f, -RopeLength));
+		const FRotator Rotation = SwingRotation.Rotator();
+
+		RegisteredCharacters[i]->GetCapsuleComponent()->SetWorldLocationAndRotation(Location, Rotation);
+
+		// Make sure the characters do not kill themselves
+		RegisteredCharacters[i]->GetMovementComponent()->Velocity.Z = 0.f;
+
+		if (bDebug) 
+		{ 
+			UKismetSystemLibrary::DrawDebugLine(GetWorld(), PivotLocation, Location, FColor::Green, 0.f, 10.f);
+		}
+	}
+}
+
 void AZiplineSpline::StartZiplineAtLocation(USplineComponent* Spline, FVector Location)
 {
 	if (!Spline) { return; }
 
 	SetCurrentDistanceOnSpline(UBPFL_Turtleneck::FindDistanceAlongSplineClosestToWorldLocation(Spline, Location));
-	const FVector NewLocation = ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
-	const FRotator NewRotation = ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FVector NewLocation = GetLocationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FRotator NewRotation = GetRotationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
 
 	PhysicsAnchorSphereComponent->SetWorldLocation(NewLocation);
 	PhysicsAnchorSphereComponent->SetWorldRotation(NewRotation);
@@ -303,30 +584,61 @@ void AZiplineSpline::CalculatePositionOnSpline(float DeltaTime)
 	if (!ZiplineSplineComponent) { return; }
 	if (!PhysicsAnchorSphereComponent) { return; }
 	
-	float DistanceSpeedIncrease = 0.f;
-	if (bSpeedIncreaseOnDistanceTraveled)
-	{
-		const float SpeedIncrements = MaxSpeedIncrease / ZiplineSplineComponent->GetSplineLength();
-		DistanceSpeedIncrease = CurrentDistanceOnSpline * SpeedIncrements;
-	}
+	const float SplineLength = GetSplineLength();
 
-	DesiredSpeed = ((DeltaTime * 100 /* percentages */) * (ZiplineSpeedMultiplier + DistanceSpeedIncrease));
+	DesiredSpeed = DeltaTime * GetZiplineSpeed(CurrentDistanceOnSpline);
 	CurrentDistanceOnSpline += DesiredSpeed;
 
-	CalculateFieldOfView(CurrentDistanceOnSpline, 0.f, ZiplineSplineComponent->GetSplineLength());
+	CalculateFieldOfView(CurrentDistanceOnSpline, 0.f, SplineLength);
 
-	const FVector NewLocation = ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
-	const FRotator NewRotation = ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FVector NewLocation = GetLocationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FRotator NewRotation = GetRotationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
 
 	PhysicsAnchorSphereComponent->SetWorldLocation(NewLocation);
 	PhysicsAnchorSphereComponent->SetWorldRotation(NewRotation);
 
-	if (CurrentDistanceOnSpline >= ZiplineSplineComponent->GetSplineLength()) 
+	if (CurrentDistanceOnSpline >= SplineLength) 
 	{
 		ZiplineCompleted();
 	}
 }
 
+float AZiplineSpline::GetZiplineSpeed(float Distance) const
+{
+	float DistanceSpeedIncrease = 0.f;
+	if (bSpeedIncreaseOnDistanceTraveled)
+	{
+		const float SplineLength = GetSplineLength();
+		const float SpeedIncrements = SplineLength > 0.f ? MaxSpeedIncrease / SplineLength : 0.f;
+		DistanceSpeedIncrease = Distance * SpeedIncrements;
+	}
+
+	return 100 /* percentages */ * (ZiplineSpeedMultiplier + DistanceSpeedIncrease);
+}
+
+FVector AZiplineSpline::CalculateRailAcceleration(float Distance) const
+{
+	const float SplineLength = GetSplineLength();
+	const float Spacing = FMath::Max(BakedGeometry.ArcLengthTable.IsValid() ? BakedGeometry.ArcLengthTable.SampleSpacing : ArcLengthTableSpacing, 1.f);
+	if (SplineLength < Spacing * 2.f) { return FVector::ZeroVector; }
+
+	// Derivatives of the rail along its length, the window is kept on the rail so the ends do not read as a bend
+	const float CenterDistance = FMath::Clamp(Distance, Spacing, SplineLength - Spacing);
+	const FVector Previous = GetLocationAtDistance(CenterDistance - Spacing, ESplineCoordinateSpace::World);
+	const FVector Center = GetLocationAtDistance(CenterDistance, ESplineCoordinateSpace::World);
+	const FVector Next = GetLocationAtDistance(CenterDistance + Spacing, ESplineCoordinateSpace::World);
+
+	const FVector Direction = (Next - Previous) / (2.f * Spacing);
+	const FVector Curvature = (Next - 2.f * Center + Previous) / (Spacing * Spacing);
+
+	// Speeding up along the rail plus the centripetal acceleration of the bends, the speed grows linearly with the distance
+	const float Speed = GetZiplineSpeed(Distance);
+	const float SpeedIncrements = bSpeedIncreaseOnDistanceTraveled ? MaxSpeedIncrease / SplineLength : 0.f;
+	const float TangentialAcceleration = 100 /* percentages */ * SpeedIncrements * Speed;
+
+	return Direction * TangentialAcceleration + Curvature * Speed * Speed;
+}
+
 void AZiplineSpline::CalculateRopeLength()
 {
 	float InputValue = 0.f;
@@ -334,15 +646,17 @@ void AZiplineSpline::CalculateRopeLength()
 	{
 		if (!RegisteredCharacters[i]) { continue; }
 
-		PlayersData[i].SpawnedAnchor->UpdateIconIndicator(false, nullptr);
+		AZiplineAnchor* Anchor = PlayersData[i].SpawnedAnchor;
+
+		if (Anchor) { Anchor->UpdateIconIndicator(false, nullptr); }
 		if (RegisteredCharacters[i]->GetLeftStickPressureDirection() == EStickPressureDirectionEnum::ESPDE_UP) 
 		{
-			PlayersData[i].SpawnedAnchor->UpdateIconIndicator(true, PlayersData[i].SpawnedAnchor->UpIndicatorTexture2D);
+			if (Anchor) { Anchor->UpdateIconIndicator(true, Anchor->UpIndicatorTexture2D); }
 			InputValue = RegisteredCharacters[i]->GetLeftStickPressureLength();
 		}
 		else if (RegisteredCharacters[i]->GetLeftStickPressureDirection() == EStickPressureDirectionEnum::ESPDE_DOWN) 
 		{
-			PlayersData[i].SpawnedAnchor->UpdateIconIndicator(true, PlayersData[i].SpawnedAnchor->DownIndicatorTexture2D);
+			if (Anchor) { Anchor->UpdateIconIndicator(true, Anchor->DownIndicatorTexture2D); }
 			InputValue = RegisteredCharacters[i]->GetLeftStickPressureLength() * -1;
 		}
 
@@ -383,31 +697,34 @@ void AZiplineSpline::CalculateSidewaySwing()
 	{
 		if (!RegisteredCharacters[i]) { continue; }
 		if (RegisteredCharacters[i]->GetQueueDead()) { return; }
-		if (!PlayersData[i].SpawnedAnchor) { continue; }
+
+		// The kinematic swing rotates the character itself, the physics swing rotates the anchor
+		const USceneComponent* SwingBody = bUseKinematicSwing 
+			? static_cast<const USceneComponent*>(RegisteredCharacters[i]->GetCapsuleComponent()) 
+			: (PlayersData[i].SpawnedAnchor ? PlayersData[i].SpawnedAnchor->GetCapsuleComponent() : nullptr);
+		if (!SwingBody) { continue; }
 
 		FVector DotCompareVector = RightPhysicsConstraintComponent->GetRightVector();
 		float Dot = FVector::DotProduct(
-			(PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetUpVector() * -1).GetSafeNormal(),
+			(SwingBody->GetUpVector() * -1).GetSafeNormal(),
 			DotCompareVector.GetSafeNormal()
 		);
 
-		FVector ImpulseDirection = FVector::ZeroVector;
-		float NewImpulseStrength = SwingImpulseStrength * Dot;
+		// -1 swings to the left, 1 to the right
+		float SwingDirection = 0.f;
 
 		// Begin toggle states
 		if (Dot > DotRequirement) 
 		{
 			PlayersData[i].bSwingRightEnabled = false;
 			PlayersData[i].bSwingLeftEnabled = true;
-			ImpulseDirection = PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetRightVector() * -1;
-			NewImpulseStrength = NewImpulseStrength * 4;
+			SwingDirection = -1.f;
 		} 
 		else if (Dot < -DotRequirement) 
 		{
 			PlayersData[i].bSwingLeftEnabled = false;
 			PlayersData[i].bSwingRightEnabled = true;
-			ImpulseDirection = PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetRightVector();
-			NewImpulseStrength = NewImpulseStrength * 4;
+			SwingDirection = 1.f;
 		} 
 		else if (Dot < DotDeadZone && Dot > -DotDeadZone) 
 		{
@@ -418,14 +735,18 @@ void AZiplineSpline::CalculateSidewaySwing()
 		
 		if (RegisteredCharacters[i]->GetLeftStickPressureDirection() == EStickPressureDirectionEnum::ESPDE_LEFT && PlayersData[i].bSwingLeftEnabled) 
 		{
-			ImpulseDirection = PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetRightVector() * -1;
+			SwingDirection = -1.f;
 		}
 		else if (RegisteredCharacters[i]->GetLeftStickPressureDirection() == EStickPressureDirectionEnum::ESPDE_RIGHT && PlayersData[i].bSwingRightEnabled) 
 		{
-			ImpulseDirection = PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetRightVector();
+			SwingDirection = 1.f;
 		}
 		
-		PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->AddImpulse(ImpulseDirection * SwingImpulseStrength);
+		// The kinematic swing applies the input in UpdateKinematicSwing
+		PlayersData[i].SwingInput = SwingDirection;
+		if (bUseKinematicSwing) { continue; }
+
+		PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->AddImpulse(PlayersData[i].SpawnedAnchor->GetCapsuleComponent()->GetRightVector() * SwingDirection * SwingImpulseStrength);
 	}
 }
 
@@ -501,8 +822,8 @@ void AZiplineSpline::ResetZipline()
 	RegisteredCharacters.Empty();
 	CurrentDistanceOnSpline = 0.f;
 
-	const FVector NewLocation = ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
-	const FRotator NewRotation = ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FVector NewLocation = GetLocationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
+	const FRotator NewRotation = GetRotationAtDistance(CurrentDistanceOnSpline, ESplineCoordinateSpace::World);
 	PhysicsAnchorSphereComponent->SetWorldLocation(NewLocation);
 	PhysicsAnchorSphereComponent->SetWorldRotation(NewRotation);
 }
@@ -563,69 +884,236 @@ void AZiplineSpline::InitializeZipline()
 {
 	if (!ZiplineSplineComponent) { return; }
 
-	PhysicsAnchorSphereComponent->SetRelativeLocation(ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(0, ESplineCoordinateSpace::Local));
-	PhysicsAnchorSphereComponent->SetRelativeRotation(ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(0, ESplineCoordinateSpace::Local));
+	// Geometry that was baked when the level was saved is only generated again when the spline or the settings changed
+	const uint32 GenerationHash = CalculateGenerationHash();
+	const bool bRegenerate = BakedGeometry.GenerationHash != GenerationHash || !BakedGeometry.ArcLengthTable.IsValid();
+
+	if (bRegenerate) 
+	{
+		BakedGeometry = FZiplineBakedGeometry();
+		BakedGeometry.GenerationHash = GenerationHash;
+
+		// Everything below samples the spline through the table
+		BuildArcLengthTable();
+	}
+
+	PhysicsAnchorSphereComponent->SetRelativeLocation(GetLocationAtDistance(0, ESplineCoordinateSpace::Local));
+	PhysicsAnchorSphereComponent->SetRelativeRotation(GetRotationAtDistance(0, ESplineCoordinateSpace::Local));
 	
 	LeftPhysicsConstraintComponent->SetRelativeLocation(LeftPhysicsConstraintComponent->RelativeLocation.RightVector * PlayerOffsetFromCenter * -1);
 	RightPhysicsConstraintComponent->SetRelativeLocation(RightPhysicsConstraintComponent->RelativeLocation.RightVector * PlayerOffsetFromCenter);
 
-	GenerateRepeatingMesh();
-	GenerateSplinePoints();
-	GenerateCable(CableRailArray, RightRailSplineComponent);
-	GenerateInvisibleCollisionShape();
+	if (bRegenerate) 
+	{
+		GenerateRepeatingMesh();
+		GenerateSplinePoints();
+		GenerateCable(CableRailArray, RightRailSplineComponent);
+		GenerateInvisibleCollisionShape();
+
+		// Cleanup Spline array so the points are not visible in the editor, but do not update.
+		RightRailSplineComponent->ClearSplinePoints(false);
+	}
+
+	ApplyBakedGeometry(bRegenerate);
+}
+
+uint32 AZiplineSpline::CalculateGenerationHash() const
+{
+	// Bump this when the generated data changes, so geometry baked by older code is generated again
+	static const uint32 BakedGeometryVersion = 2;
+
+	uint32 Hash = BakedGeometryVersion;
+	if (!ZiplineSplineComponent) { return Hash; }
+
+	const int NumPoints = ZiplineSplineComponent->GetNumberOfSplinePoints();
+	Hash = HashCombine(Hash, GetTypeHash(NumPoints));
+	Hash = HashCombine(Hash, GetTypeHash(ZiplineSplineComponent->IsClosedLoop()));
+
+	for (int PointIndex = 0; PointIndex < NumPoints; ++PointIndex)
+	{
+		const FVector PointData[] = 
+		{
+			ZiplineSplineComponent->GetLocationAtSplinePoint(PointIndex, ESplineCoordinateSpace::Local),
+			ZiplineSplineComponent->GetArriveTangentAtSplinePoint(PointIndex, ESplineCoordinateSpace::Local),
+			ZiplineSplineComponent->GetLeaveTangentAtSplinePoint(PointIndex, ESplineCoordinateSpace::Local),
+			ZiplineSplineComponent->GetRotationAtSplinePoint(PointIndex, ESplineCoordinateSpace::Local).Euler(),
+			ZiplineSplineComponent->GetScaleAtSplinePoint(PointIndex),
+		};
+		Hash = FCrc::MemCrc32(PointData, sizeof(PointData), Hash);
+		Hash = HashCombine(Hash, GetTypeHash((int32)ZiplineSplineComponent->GetSplinePointType(PointIndex)));
+	}
+
+	// The cable and collision are generated in world space, relative to the actor
+	const FTransform SplineTransform = ZiplineSplineComponent->GetRelativeTransform();
+	const FVector TransformData[] = { SplineTransform.GetLocation(), SplineTransform.GetRotation().Euler(), SplineTransform.GetScale3D() };
+	Hash = FCrc::MemCrc32(TransformData, sizeof(TransformData), Hash);
 
-	// Cleanup Spline array so the points are not visible in the editor, but do not update.
-	RightRailSplineComponent->ClearSplinePoints(false);
+	const float Settings[] = 
+	{
+		GenerateMeshFrequency, PointOffsetFromCenter, PointCalculationFrequency, ArcLengthTableSpacing,
+		CableRadius, CableMaxSegmentAngle, CableMaxSegmentLength,
+		CollisionCapsuleRadius, CollisionCapsuleTolerance, CollisionCapsuleMaxLength,
+		(float)RemoveCableFromStart, (float)RemoveRepeatingMeshFromStart, (float)CableSides,
+		bGenerateCable ? 1.f : 0.f, bGenerateRepeatingMesh ? 1.f : 0.f, bMergeCableMesh ? 1.f : 0.f,
+	};
+	Hash = FCrc::MemCrc32(Settings, sizeof(Settings), Hash);
+
+	// Pointers differ between sessions, the asset paths do not
+	Hash = HashCombine(Hash, GetTypeHash(CableMesh ? CableMesh->GetPathName() : FString()));
+	Hash = HashCombine(Hash, GetTypeHash(SimpleCollisionShapeMesh ? SimpleCollisionShapeMesh->GetPathName() : FString()));
+
+	return Hash;
+}
+
+void AZiplineSpline::ApplyBakedGeometry(bool bRegenerated)
+{
+	// Instances are saved with the component, only replace them when they were generated again
+	if (RepeatingInstancedStaticMeshComponent && (bRegenerated || RepeatingInstancedStaticMeshComponent->GetInstanceCount() != BakedGeometry.RepeatingMeshInstances.Num())) 
+	{
+		RepeatingInstancedStaticMeshComponent->ClearInstances();
+		for (const FTransform& InstanceTransform : BakedGeometry.RepeatingMeshInstances)
+		{
+			RepeatingInstancedStaticMeshComponent->AddInstance(InstanceTransform);
+		}
+		RepeatingInstancedStaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	// The spline mesh components are not saved, they are only created again when the segments changed or they do not exist yet
+	const bool bRecreateCableMeshes = bRegenerated || CableMeshData.Num() != BakedGeometry.CableSegments.Num() || CableMeshData.Contains(nullptr);
+	if (bRecreateCableMeshes) 
+	{
+		/** Do not change this to indices based iteration, it will yield undifined behaviour */
+		for (int i = 0; i < CableMeshData.Num(); ++i) 
+		{
+			if (!CableMeshData[i]) { continue; }
+			CableMeshData[i]->DestroyComponent();
+		}
+		CableMeshData.Empty();
+
+		for (int i = 0; i < BakedGeometry.CableSegments.Num(); ++i)
+		{
+			USplineMeshComponent* CableMeshSegment = NewObject<USplineMeshComponent>(this);
+			if (!CableMeshSegment) { continue; }
+			CableMeshSegment->Mobility = EComponentMobility::Movable;
+			CableMeshSegment->RegisterComponent();
+			CableMeshSegment->SetStaticMesh(CableMesh);
+			CableMeshSegment->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+			CableMeshData.Add(CableMeshSegment);
+		}
+	}
+
+	// The segments are relative to the actor, the components are not attached to it and follow it here
+	const FTransform ActorTransform = GetActorTransform();
+
+	for (int i = 0; i < CableMeshData.Num() && i < BakedGeometry.CableSegments.Num(); ++i)
+	{
+		const FZiplineSplineMeshSegment& Segment = BakedGeometry.CableSegments[i];
+		CableMeshData[i]->SetStartAndEnd(
+			ActorTransform.TransformPosition(Segment.StartLocation), ActorTransform.TransformVector(Segment.StartTangent),
+			ActorTransform.TransformPosition(Segment.EndLocation), ActorTransform.TransformVector(Segment.EndTangent));
+	}
+
+	const bool bHasMergedCable = BakedGeometry.MergedCableVertices.Num() > 0;
+	if (CableProceduralMeshComponent && (bRegenerated || (CableProceduralMeshComponent->GetNumSections() > 0) != bHasMergedCable)) 
+	{
+		CableProceduralMeshComponent->ClearAllMeshSections();
+
+		if (bHasMergedCable) 
+		{
+			CableProceduralMeshComponent->CreateMeshSection_LinearColor(0, BakedGeometry.MergedCableVertices, BakedGeometry.MergedCableTriangles, BakedGeometry.MergedCableNormals, 
+				BakedGeometry.MergedCableUVs, TArray<FLinearColor>(), BakedGeometry.MergedCableTangents, false);
+			CableProceduralMeshComponent->SetMaterial(0, CableMesh ? CableMesh->GetMaterial(0) : nullptr);
+		}
+	}
+
+	// The capsules are saved with the component, the physics body is only recreated when they changed
+	if (RailCollisionComponent && (bRegenerated || RailCollisionComponent->GetNumCapsules() != BakedGeometry.CollisionCapsules.Num())) 
+	{
+		RailCollisionComponent->SetCapsules(BakedGeometry.CollisionCapsules);
+	}
+}
+
+void AZiplineSpline::BuildArcLengthTable()
+{
+	if (!ZiplineSplineComponent) 
+	{ 
+		BakedGeometry.ArcLengthTable.Reset();
+		return; 
+	}
+
+	BakedGeometry.ArcLengthTable.Build(ZiplineSplineComponent, ArcLengthTableSpacing);
+}
+
+float AZiplineSpline::GetSplineLength() const
+{
+	if (BakedGeometry.ArcLengthTable.IsValid()) { return BakedGeometry.ArcLengthTable.GetSplineLength(); }
+	return ZiplineSplineComponent ? ZiplineSplineComponent->GetSplineLength() : 0.f;
+}
+
+FVector AZiplineSpline::GetLocationAtDistance(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	if (!BakedGeometry.ArcLengthTable.IsValid()) 
+	{ 
+		return ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(Distance, CoordinateSpace);
+	}
+
+	const FVector LocalLocation = BakedGeometry.ArcLengthTable.GetLocationAtDistance(Distance);
+	return CoordinateSpace == ESplineCoordinateSpace::World ? ZiplineSplineComponent->GetComponentTransform().TransformPosition(LocalLocation) : LocalLocation;
+}
+
+FRotator AZiplineSpline::GetRotationAtDistance(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	if (!BakedGeometry.ArcLengthTable.IsValid()) 
+	{ 
+		return ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(Distance, CoordinateSpace);
+	}
+
+	const FQuat LocalRotation = BakedGeometry.ArcLengthTable.GetRotationAtDistance(Distance);
+	return CoordinateSpace == ESplineCoordinateSpace::World ? (ZiplineSplineComponent->GetComponentTransform().GetRotation() * LocalRotation).Rotator() : LocalRotation.Rotator();
 }
 
 void AZiplineSpline::GenerateRepeatingMesh()
 {
-	if (!RepeatingInstancedStaticMeshComponent) { return; }
-	RepeatingInstancedStaticMeshComponent->ClearInstances();
+	BakedGeometry.RepeatingMeshInstances.Empty();
 
 	if (!bGenerateRepeatingMesh) { return; }
 	if (!ZiplineSplineComponent) { return; }
 
-	int TotalRepeatingMeshes = UKismetMathLibrary::Round(ZiplineSplineComponent->GetSplineLength() / GenerateMeshFrequency);
+	int TotalRepeatingMeshes = UKismetMathLibrary::Round(GetSplineLength() / GenerateMeshFrequency);
 	if (RemoveRepeatingMeshFromStart > TotalRepeatingMeshes) { return; }
 
 	int CurrentIndex = RemoveRepeatingMeshFromStart;
 	for (CurrentIndex; CurrentIndex < TotalRepeatingMeshes; ++CurrentIndex)
 	{
-		FVector Location = ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(CurrentIndex * GenerateMeshFrequency, ESplineCoordinateSpace::Local);
-		FRotator Rotation = ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(CurrentIndex * GenerateMeshFrequency, ESplineCoordinateSpace::Local);
+		FVector Location = GetLocationAtDistance(CurrentIndex * GenerateMeshFrequency, ESplineCoordinateSpace::Local);
+		FRotator Rotation = GetRotationAtDistance(CurrentIndex * GenerateMeshFrequency, ESplineCoordinateSpace::Local);
 
 		FTransform InstanceTransform = FTransform(Rotation, Location + (UKismetMathLibrary::GetRightVector(Rotation) * (PointOffsetFromCenter * -1)), FVector(1, 1, 1));
-		RepeatingInstancedStaticMeshComponent->AddInstance(InstanceTransform);
+		BakedGeometry.RepeatingMeshInstances.Add(InstanceTransform);
 	}
-
-	RepeatingInstancedStaticMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
 void AZiplineSpline::GenerateSplinePoints()
 {
 	CableRailArray.Empty();
 
-	int TotalPointAmount = UKismetMathLibrary::Round(ZiplineSplineComponent->GetSplineLength() / PointCalculationFrequency);
+	int TotalPointAmount = UKismetMathLibrary::Round(GetSplineLength() / PointCalculationFrequency);
 	for (int CurrentIndex = 0; CurrentIndex < TotalPointAmount; ++CurrentIndex)
 	{
-		FVector Location = ZiplineSplineComponent->GetLocationAtDistanceAlongSpline(CurrentIndex * PointCalculationFrequency, ESplineCoordinateSpace::Local);
-		FRotator Rotation = ZiplineSplineComponent->GetRotationAtDistanceAlongSpline(CurrentIndex * PointCalculationFrequency, ESplineCoordinateSpace::Local);
+		FVector Location = GetLocationAtDistance(CurrentIndex * PointCalculationFrequency, ESplineCoordinateSpace::Local);
+		FVector RightVector = BakedGeometry.ArcLengthTable.IsValid() 
+			? BakedGeometry.ArcLengthTable.GetRightVectorAtDistance(CurrentIndex * PointCalculationFrequency) 
+			: UKismetMathLibrary::GetRightVector(GetRotationAtDistance(CurrentIndex * PointCalculationFrequency, ESplineCoordinateSpace::Local));
 		
 		float LocalOffset = PointOffsetFromCenter * -1; // @example: You can use modulo and offset to generate left and right rails
-		CableRailArray.Add(Location + (UKismetMathLibrary::GetRightVector(Rotation) * LocalOffset));
+		CableRailArray.Add(Location + (RightVector * LocalOffset));
 	}
 }
 
 void AZiplineSpline::GenerateCable(TArray<FVector> CableLocations, USplineComponent* RailSpline)
 {
-	/** Do not change this to indices based iteration, it will yield undifined behaviour */
-	for (int i = 0; i < CableMeshData.Num(); ++i) 
-	{
-		if (!CableMeshData[i]) { continue; }
-		CableMeshData[i]->DestroyComponent();
-	}
-	CableMeshData.Empty();
+	BakedGeometry.CableSegments.Empty();
 
 	if (!RailSpline) { return; }
 
@@ -633,6 +1121,15 @@ void AZiplineSpline::GenerateCable(TArray<FVector> CableLocations, USplineCompon
 	RailSpline->ClearSplinePoints(true);
 	RailSpline->SetSplinePoints(CableLocations, ESplineCoordinateSpace::Local, true);
 
+	if (bMergeCableMesh) 
+	{
+		if (RemoveCableFromStart >= CableLocations.Num()) { return; }
+		GenerateMergedCable(RailSpline, RailSpline->GetDistanceAlongSplineAtSplinePoint(FMath::Max(RemoveCableFromStart, 0)));
+		return;
+	}
+
+	const FTransform ActorTransform = GetActorTransform();
+
 	int CurrentIndex = RemoveCableFromStart;
 	for (CurrentIndex; CurrentIndex < CableLocations.Num(); ++CurrentIndex)
 	{
@@ -644,59 +1141,160 @@ void AZiplineSpline::GenerateCable(TArray<FVector> CableLocations, USplineCompon
 		FVector NextTangent = FVector::ZeroVector;
 		RailSpline->GetLocationAndTangentAtSplinePoint(CurrentIndex + 1, NextLocation, NextTangent, ESplineCoordinateSpace::World);
 
-		USplineMeshComponent* CableMeshSegment = NewObject<USplineMeshComponent>(this);
-		if (!CableMeshSegment) { continue; }
-		CableMeshSegment->Mobility = EComponentMobility::Movable;
-		CableMeshSegment->RegisterComponent();
-		CableMeshSegment->SetStaticMesh(CableMesh);
-		CableMeshSegment->SetStartAndEnd(CurrentLocation, CurrentTangent, NextLocation, NextTangent);
-		CableMeshSegment->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		BakedGeometry.CableSegments.Add(FZiplineSplineMeshSegment(ActorTransform, CurrentLocation, CurrentTangent, NextLocation, NextTangent));
+	}
+}
+
+void AZiplineSpline::GenerateMergedCable(USplineComponent* RailSpline, float StartDistance)
+{
+	BakedGeometry.MergedCableVertices.Empty();
+	BakedGeometry.MergedCableTriangles.Empty();
+	BakedGeometry.MergedCableNormals.Empty();
+	BakedGeometry.MergedCableUVs.Empty();
+	BakedGeometry.MergedCableTangents.Empty();
+
+	if (!CableProceduralMeshComponent) { return; }
+	if (!RailSpline) { return; }
+
+	const float SplineLength = RailSpline->GetSplineLength();
+	if (SplineLength - StartDistance <= KINDA_SMALL_NUMBER) { return; }
+
+	// Walk the rail in small steps and only keep a ring where the cable has bent enough, or the segment got too long
+	const float WalkStep = FMath::Max(ArcLengthTableSpacing, 1.f);
+	const float MinDirectionDot = FMath::Cos(FMath::DegreesToRadians(CableMaxSegmentAngle));
+
+	TArray<float> RingDistances;
+	RingDistances.Add(StartDistance);
+	FVector LastRingDirection = RailSpline->GetDirectionAtDistanceAlongSpline(StartDistance, ESplineCoordinateSpace::World);
+
+	for (float Distance = StartDistance + WalkStep; Distance < SplineLength; Distance += WalkStep)
+	{
+		const FVector Direction = RailSpline->GetDirectionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+		const bool bBent = FVector::DotProduct(Direction, LastRingDirection) < MinDirectionDot;
+		const bool bTooLong = Distance - RingDistances.Last() >= CableMaxSegmentLength;
+
+		if (bBent || bTooLong) 
+		{
+			RingDistances.Add(Distance);
+			LastRingDirection = Direction;
+		}
+	}
+	RingDistances.Add(SplineLength);
+
+	const int Sides = FMath::Max(CableSides, 3);
+	const int VerticesPerRing = Sides + 1; // The seam is duplicated so the texture wraps around
+	const float Circumference = 2.f * PI * CableRadius;
+	const FTransform MeshTransform = CableProceduralMeshComponent->GetComponentTransform();
+
+	TArray<FVector>& Vertices = BakedGeometry.MergedCableVertices;
+	TArray<FVector>& Normals = BakedGeometry.MergedCableNormals;
+	TArray<FVector2D>& UVs = BakedGeometry.MergedCableUVs;
+	TArray<FProcMeshTangent>& Tangents = BakedGeometry.MergedCableTangents;
+	TArray<int32>& Triangles = BakedGeometry.MergedCableTriangles;
+	Vertices.Reserve(RingDistances.Num() * VerticesPerRing);
+	Normals.Reserve(RingDistances.Num() * VerticesPerRing);
+	UVs.Reserve(RingDistances.Num() * VerticesPerRing);
+	Tangents.Reserve(RingDistances.Num() * VerticesPerRing);
+	Triangles.Reserve((RingDistances.Num() - 1) * Sides * 6);
+
+	for (int RingIndex = 0; RingIndex < RingDistances.Num(); ++RingIndex)
+	{
+		const float Distance = RingDistances[RingIndex];
+		const FVector Center = MeshTransform.InverseTransformPosition(RailSpline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World));
+		const FQuat Rotation = MeshTransform.InverseTransformRotation(RailSpline->GetQuaternionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World));
+		const FVector Right = Rotation.GetRightVector();
+		const FVector Up = Rotation.GetUpVector();
+
+		for (int Side = 0; Side < VerticesPerRing; ++Side)
+		{
+			const float Angle = (2.f * PI * Side) / Sides;
+			const FVector Normal = (Right * FMath::Cos(Angle)) + (Up * FMath::Sin(Angle));
+			const FVector Tangent = (Right * -FMath::Sin(Angle)) + (Up * FMath::Cos(Angle));
+
+			Vertices.Add(Center + (Normal * CableRadius));
+			Normals.Add(Normal);
+			Tangents.Add(FProcMeshTangent(Tangent, false));
+			UVs.Add(FVector2D((float)Side / Sides, (Distance - StartDistance) / Circumference));
+		}
+
+		if (RingIndex == 0) { continue; }
+
+		const int PreviousRing = (RingIndex - 1) * VerticesPerRing;
+		const int CurrentRing = RingIndex * VerticesPerRing;
+		for (int Side = 0; Side < Sides; ++Side)
+		{
+			Triangles.Add(PreviousRing + Side);
+			Triangles.Add(PreviousRing + Side + 1);
+			Triangles.Add(CurrentRing + Side);
 
-		CableMeshData.Add(CableMeshSegment);
+			Triangles.Add(PreviousRing + Side + 1);
+			Triangles.Add(CurrentRing + Side + 1);
+			Triangles.Add(CurrentRing + Side);
+		}
 	}
 }
 
 void AZiplineSpline::GenerateInvisibleCollisionShape()
 {
-	/** Do not change this to indices based iteration, it will yield undifined behaviour */
-	for (int i = 0; i < CollisionShapeData.Num(); ++i) 
+	BakedGeometry.CollisionCapsules.Empty();
+
+	if (!RailCollisionComponent) { return; }
+	if (!BakedGeometry.ArcLengthTable.IsValid()) { return; }
+
+	float Radius = CollisionCapsuleRadius;
+	if (SimpleCollisionShapeMesh) 
 	{
-		if (!CollisionShapeData[i]) { continue; }
-		CollisionShapeData[i]->DestroyComponent();
+		// Spline meshes are deformed along X, so the cross section of the collision mesh is its thickness
+		const FVector Extent = SimpleCollisionShapeMesh->GetBounds().BoxExtent;
+		Radius = FMath::Max(Extent.Y, Extent.Z);
 	}
-	CollisionShapeData.Empty();
 
-	if (!SimpleCollisionShapeMesh) { return; }
-	if (!RightRailSplineComponent) { return; }
-	if (CableRailArray.Num() == 0) { return; }
+	// The table samples in the space of the collision component
+	const FTransform SplineToCollision = ZiplineSplineComponent->GetComponentTransform() * RailCollisionComponent->GetComponentTransform().Inverse();
+	const TArray<FVector>& TableLocations = BakedGeometry.ArcLengthTable.Locations;
 
-	for (int i = 0; i < CableRailArray.Num(); ++i) 
+	TArray<FVector> Samples;
+	Samples.Reserve(TableLocations.Num());
+	for (const FVector& Location : TableLocations)
 	{
-		FVector CurrentLocation = FVector::ZeroVector;
-		FVector CurrentTangent = FVector::ZeroVector;
-		FRotator CurrentRotation = RightRailSplineComponent->GetRotationAtSplinePoint(i, ESplineCoordinateSpace::World);
-		RightRailSplineComponent->GetLocationAndTangentAtSplinePoint(i, CurrentLocation, CurrentTangent, ESplineCoordinateSpace::World);
-		CurrentLocation = CurrentLocation + (UKismetMathLibrary::GetRightVector(CurrentRotation) * PointOffsetFromCenter);
+		Samples.Add(SplineToCollision.TransformPosition(Location));
+	}
 
-		FVector NextLocation = FVector::ZeroVector;
-		FVector NextTangent = FVector::ZeroVector;
-		FRotator NextRotation = RightRailSplineComponent->GetRotationAtSplinePoint(i + 1, ESplineCoordinateSpace::World);
-		RightRailSplineComponent->GetLocationAndTangentAtSplinePoint(i + 1, NextLocation, NextTangent, ESplineCoordinateSpace::World);
-		NextLocation = NextLocation + (UKismetMathLibrary::GetRightVector(NextRotation) * PointOffsetFromCenter);
+	// Grow every capsule along the samples for as long as the spline stays close to its axis.
+	// The cone holds the axis directions that keep every covered sample within the tolerance, so each sample is only looked at once
+	int StartIndex = 0;
+	while (StartIndex < Samples.Num() - 1)
+	{
+		int EndIndex = StartIndex + 1;
 
-		USplineMeshComponent* SimpleCollisionMesh = NewObject<USplineMeshComponent>(this);
-		if (!SimpleCollisionMesh) { return; }
-		
-		SimpleCollisionMesh->Mobility = EComponentMobility::Movable;
-		SimpleCollisionMesh->RegisterComponent();
-		SimpleCollisionMesh->SetStaticMesh(SimpleCollisionShapeMesh);
-		SimpleCollisionMesh->SetStartAndEnd(CurrentLocation, CurrentTangent, NextLocation, NextTangent);
-		SimpleCollisionMesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		SimpleCollisionMesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
-		SimpleCollisionMesh->SetHiddenInGame(true);
-		SimpleCollisionMesh->bVisible = false;
+		FZiplineCapsuleAxisCone AxisCone;
+		bool bConeValid = AxisCone.Narrow(Samples[EndIndex] - Samples[StartIndex], CollisionCapsuleTolerance);
+
+		while (bConeValid && EndIndex + 1 < Samples.Num())
+		{
+			const int CandidateIndex = EndIndex + 1;
+			const FVector Offset = Samples[CandidateIndex] - Samples[StartIndex];
+			if (Offset.SizeSquared() > FMath::Square(CollisionCapsuleMaxLength)) { break; }
+
+			// The axis towards the candidate has to keep the samples in between within the tolerance
+			if (!AxisCone.Contains(Offset)) { break; }
 
-		CollisionShapeData.Add(SimpleCollisionMesh);
+			bConeValid = AxisCone.Narrow(Offset, CollisionCapsuleTolerance);
+			EndIndex = CandidateIndex;
+		}
+
+		const FVector Axis = Samples[EndIndex] - Samples[StartIndex];
+		const float Length = Axis.Size();
+		if (Length > KINDA_SMALL_NUMBER) 
+		{
+			// Capsules are aligned to Z, the rounded ends overlap the neighbouring capsules so there are no gaps on curves
+			FKSphylElem Capsule(Radius, Length);
+			Capsule.Center = (Samples[StartIndex] + Samples[EndIndex]) * 0.5f;
+			Capsule.Rotation = FRotationMatrix::MakeFromZ(Axis / Length).Rotator();
+			BakedGeometry.CollisionCapsules.Add(Capsule);
+		}
+
+		StartIndex = EndIndex;
 	}
 }
 
@@ -732,6 +1330,17 @@ void AZiplineSpline::PlayerMoveUpRequest_Implementation(ABasePlayerCharacter* Re
 // Editor Only
 
 #if UE_EDITOR
+void AZiplineSpline::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	// Bake the generated geometry into the level, so loading it does not generate it again
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject)) 
+	{
+		InitializeZipline();
+	}
+
+	Super::PreSave(TargetPlatform);
+}
+
 void AZiplineSpline::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	InitializeZipline();
@@ -4,6 +4,9 @@
 
 #include "Core/CoreActor.h"
 #include "Actors/Mechanics/InteractableActor/InteractableActor.h"
+#include "Components/SplineComponent.h"
+#include "ProceduralMeshComponent.h"
+#include "PhysicsEngine/SphylElem.h"
 #include "ZiplineSpline.generated.h"
 
 
@@ -33,6 +36,12 @@ struct FZiplinePlayerData
 		, bSwingLeftEnabled(true)
 		, bSwingRightEnabled(true)
 		, SpawnedAnchor(nullptr) 
+		, SwingPivot(nullptr)
+		, SwingInput(0.f)
+		, SwingAngles(FVector2D::ZeroVector)
+		, SwingAngularVelocity(FVector2D::ZeroVector)
+		, PreviousSwingAngles(FVector2D::ZeroVector)
+		, SwingTimeAccumulator(0.f)
 	{ 
 	}
 	
@@ -45,8 +54,155 @@ struct FZiplinePlayerData
 	UPROPERTY()
 	bool bSwingRightEnabled;
 
+	/** Not spawned with the kinematic swing, the rider is placed directly */
 	UPROPERTY()
 	AZiplineAnchor* SpawnedAnchor;
+
+	/** The point the rope hangs from, the constraint the character was initialized with */
+	UPROPERTY()
+	USceneComponent* SwingPivot;
+
+	/** -1 swings left, 1 swings right, see CalculateSidewaySwing */
+	float SwingInput;
+
+	/** Kinematic swing state in radians, X is the sideways swing around the spline direction and Y the swing forward and backward */
+	FVector2D SwingAngles;
+	FVector2D SwingAngularVelocity;
+
+	/** Angles before the last fixed step and the frame time not stepped yet, the rope is drawn in between the last two steps */
+	FVector2D PreviousSwingAngles;
+	float SwingTimeAccumulator;
+};
+
+/**
+ * Positions, rotations and right vectors sampled at a uniform distance along the zipline spline, in the local space of the spline.
+ * Looking up a distance is an index and an interpolation, instead of reparameterizing the spline every time.
+ */
+USTRUCT()
+struct FZiplineArcLengthTable
+{
+	GENERATED_USTRUCT_BODY()
+
+	FZiplineArcLengthTable()
+		: SampleSpacing(0.f)
+		, SplineLength(0.f)
+	{
+	}
+
+	void Build(const USplineComponent* Spline, float InSampleSpacing);
+	void Reset();
+
+	bool IsValid() const { return SampleSpacing > 0.f && Locations.Num() > 1; }
+	float GetSplineLength() const { return SplineLength; }
+
+	FVector GetLocationAtDistance(float Distance) const;
+	FQuat GetRotationAtDistance(float Distance) const;
+	FVector GetRightVectorAtDistance(float Distance) const;
+
+private:
+	void GetSamplesAtDistance(float Distance, int& OutIndex, int& OutNextIndex, float& OutAlpha) const;
+
+public:
+	UPROPERTY()
+	float SampleSpacing;
+
+	UPROPERTY()
+	float SplineLength;
+
+	UPROPERTY()
+	TArray<FVector> Locations;
+
+	UPROPERTY()
+	TArray<FQuat> Rotations;
+
+	UPROPERTY()
+	TArray<FVector> RightVectors;
+};
+
+/**
+ * Start and end of a spline mesh segment, relative to the zipline actor so the baked segments follow the actor when it is moved.
+ */
+USTRUCT()
+struct FZiplineSplineMeshSegment
+{
+	GENERATED_USTRUCT_BODY()
+
+	FZiplineSplineMeshSegment()
+		: StartLocation(FVector::ZeroVector)
+		, StartTangent(FVector::ZeroVector)
+		, EndLocation(FVector::ZeroVector)
+		, EndTangent(FVector::ZeroVector)
+	{
+	}
+
+	FZiplineSplineMeshSegment(const FTransform& ActorTransform, const FVector& WorldStartLocation, const FVector& WorldStartTangent, const FVector& WorldEndLocation, const FVector& WorldEndTangent)
+		: StartLocation(ActorTransform.InverseTransformPosition(WorldStartLocation))
+		, StartTangent(ActorTransform.InverseTransformVector(WorldStartTangent))
+		, EndLocation(ActorTransform.InverseTransformPosition(WorldEndLocation))
+		, EndTangent(ActorTransform.InverseTransformVector(WorldEndTangent))
+	{
+	}
+
+	UPROPERTY()
+	FVector StartLocation;
+
+	UPROPERTY()
+	FVector StartTangent;
+
+	UPROPERTY()
+	FVector EndLocation;
+
+	UPROPERTY()
+	FVector EndTangent;
+};
+
+/**
+ * Everything InitializeZipline generates from the spline, saved with the level.
+ * Loading a zipline only creates the components from this data, it is generated again when the spline or the settings change.
+ */
+USTRUCT()
+struct FZiplineBakedGeometry
+{
+	GENERATED_USTRUCT_BODY()
+
+	FZiplineBakedGeometry()
+		: GenerationHash(0)
+	{
+	}
+
+	/** Hash of the spline and the settings the geometry was generated from, see AZiplineSpline::CalculateGenerationHash */
+	UPROPERTY()
+	uint32 GenerationHash;
+
+	UPROPERTY()
+	FZiplineArcLengthTable ArcLengthTable;
+
+	/** Relative to the repeating mesh component */
+	UPROPERTY()
+	TArray<FTransform> RepeatingMeshInstances;
+
+	UPROPERTY()
+	TArray<FZiplineSplineMeshSegment> CableSegments;
+
+	/** The merged cable section, in the space of the procedural mesh component */
+	UPROPERTY()
+	TArray<FVector> MergedCableVertices;
+
+	UPROPERTY()
+	TArray<int32> MergedCableTriangles;
+
+	UPROPERTY()
+	TArray<FVector> MergedCableNormals;
+
+	UPROPERTY()
+	TArray<FVector2D> MergedCableUVs;
+
+	UPROPERTY()
+	TArray<FProcMeshTangent> MergedCableTangents;
+
+	/** The rail collision, in the space of the collision component */
+	UPROPERTY()
+	TArray<FKSphylElem> CollisionCapsules;
 };
 
 /**
@@ -152,12 +308,28 @@ public:
 	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	float DotDeadZone = 0.07f;
 
+	/** Clamps the velocity of the anchors, with the kinematic swing it clamps the swing speed of the riders around the pivot */
 	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	float MinVelocity = 0.f;
 
 	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	float MaxVelocity = 10000.f;
 
+	/** 
+	 * Swing the characters with a damped pendulum instead of simulated anchors and physics constraints, this is deterministic and does not touch the physics scene.
+	 * No anchors are spawned, so the anchor indicators are not shown and the move requests receive no anchor.
+	 */
+	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
+	bool bUseKinematicSwing = false;
+
+	/** The acceleration the character can apply to swing, the kinematic counterpart of SwingImpulseStrength */
+	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", EditCondition = bUseKinematicSwing))
+	float SwingAcceleration = 1500.f;
+
+	/** How quickly the kinematic swing loses its energy, higher values settle faster */
+	UPROPERTY(Category = "Zipline|Physics", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 0.f, EditCondition = bUseKinematicSwing))
+	float SwingDamping = 0.5f;
+
 	/** Generate a cable along the length of the spline */
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	bool bGenerateCable = true;
@@ -165,6 +337,25 @@ public:
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", EditCondition = bGenerateCable))
 	int RemoveCableFromStart = 0;
 
+	/** Build the cable as a single swept mesh instead of a spline mesh per rail point, this costs one draw call per zipline */
+	UPROPERTY(Category = "Zipline|Generation|Merged Cable", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", EditCondition = bGenerateCable))
+	bool bMergeCableMesh = false;
+
+	UPROPERTY(Category = "Zipline|Generation|Merged Cable", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 0.1f, EditCondition = bMergeCableMesh))
+	float CableRadius = 4.f;
+
+	/** The number of sides of the cable cross section */
+	UPROPERTY(Category = "Zipline|Generation|Merged Cable", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 3, ClampMax = 32, EditCondition = bMergeCableMesh))
+	int CableSides = 8;
+
+	/** A new ring is added when the cable bends more than this many degrees, straight parts get fewer rings than curves */
+	UPROPERTY(Category = "Zipline|Generation|Merged Cable", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 0.5f, EditCondition = bMergeCableMesh))
+	float CableMaxSegmentAngle = 5.f;
+
+	/** The maximum length of a single cable segment, even when the cable is straight */
+	UPROPERTY(Category = "Zipline|Generation|Merged Cable", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 10.f, EditCondition = bMergeCableMesh))
+	float CableMaxSegmentLength = 500.f;
+
 	/** Generate a mesh that repeats along the length of the spline */
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	bool bGenerateRepeatingMesh = true;
@@ -185,10 +376,26 @@ public:
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 25.f))
 	float PointCalculationFrequency = 100.f;
 
-	/** This should be a mesh with a simple collision shape, for example a square, this will be hidden in game */
+	/** The distance between the samples of the arc length table, lower is more accurate on tight curves */
+	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 1.f))
+	float ArcLengthTableSpacing = 10.f;
+
+	/** This should be a mesh with a simple collision shape, for example a square. When set the rail collision gets the thickness of this mesh */
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	class UStaticMesh* SimpleCollisionShapeMesh;
 
+	/** Radius of the rail collision capsules when no SimpleCollisionShapeMesh is set */
+	UPROPERTY(Category = "Zipline|Generation|Collision", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 1.f))
+	float CollisionCapsuleRadius = 25.f;
+
+	/** How far the spline may stray from the axis of a capsule, lower gives more capsules on curves */
+	UPROPERTY(Category = "Zipline|Generation|Collision", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 0.1f))
+	float CollisionCapsuleTolerance = 5.f;
+
+	/** Longest capsule along straight parts of the spline */
+	UPROPERTY(Category = "Zipline|Generation|Collision", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true", ClampMin = 10.f))
+	float CollisionCapsuleMaxLength = 1000.f;
+
 	UPROPERTY(Category = "Zipline|Generation", EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"))
 	class UStaticMesh* CableMesh;
 
@@ -213,6 +420,14 @@ private:
 	UPROPERTY(meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"), Category = "Zipline", VisibleDefaultsOnly, BlueprintReadWrite)
 	class UPhysicsConstraintComponent* RightPhysicsConstraintComponent;
 
+	/** The merged cable, see bMergeCableMesh */
+	UPROPERTY(meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"), Category = "Zipline", VisibleDefaultsOnly, BlueprintReadOnly)
+	class UProceduralMeshComponent* CableProceduralMeshComponent;
+
+	/** The collision of the whole rail as a single body, see GenerateInvisibleCollisionShape */
+	UPROPERTY(meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"), Category = "Zipline", VisibleDefaultsOnly, BlueprintReadOnly)
+	class UZiplineCollisionComponent* RailCollisionComponent;
+
 	/** We use this to generate the cable mesh along the length of this spline */
 	UPROPERTY(meta = (AllowPrivateAccess = "true", BlueprintProtected = "true"), Category = "Zipline", VisibleDefaultsOnly, BlueprintReadOnly)
 	class USplineComponent* RightRailSplineComponent;
@@ -221,10 +436,12 @@ private:
 	class USceneComponent* ActorRootSceneComponent;
 
 private:
+	UPROPERTY()
+	FZiplineBakedGeometry BakedGeometry;
+
 	TArray<FVector> CableRailArray;
 	TArray<ABasePlayerCharacter*> RegisteredCharacters;
 	TArray<USplineMeshComponent*> CableMeshData;
-	TArray<USplineMeshComponent*> CollisionShapeData;
 	TArray<FZiplinePlayerData> PlayersData;
 	FTimerHandle DetachHandle;
 	APlayerCameraManager* CameraManager;
@@ -311,6 +528,15 @@ public:
 
 private:
 	void UpdatePhysicsContraints();
+	void UpdateKinematicSwing(float DeltaTime);
+	float GetZiplineSpeed(float Distance) const;
+	FVector CalculateRailAcceleration(float Distance) const;
+	uint32 CalculateGenerationHash() const;
+	void ApplyBakedGeometry(bool bRegenerated);
+	void BuildArcLengthTable();
+	float GetSplineLength() const;
+	FVector GetLocationAtDistance(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const;
+	FRotator GetRotationAtDistance(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const;
 	void ShouldBlendToNewCamera(ABasePlayerCharacter* Character, AActor* TargetCamera);
 	void UpdateZiplineCameraState(ABasePlayerCharacter* Character, bool bCompleted = false);
 	AZiplineAnchor* InitializeAnchor(ABasePlayerCharacter* Character, UPhysicsConstraintComponent* TargetContraint, float VerticalOffset);
@@ -320,10 +546,12 @@ private:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void OnConstruction(const FTransform& Transform) override;
 	virtual void Tick(float DetaSeconds) override;
 	virtual void GenerateSplinePoints();
 	virtual void GenerateRepeatingMesh();
 	virtual void GenerateCable(TArray<FVector> CableLocations, USplineComponent* RailSpline);
+	virtual void GenerateMergedCable(USplineComponent* RailSpline, float StartDistance);
 	virtual void GenerateInvisibleCollisionShape();
 	virtual void CalculateRopeLength();
 	virtual void CalculateSidewaySwing();
@@ -335,6 +563,7 @@ protected:
 	virtual void PlayZiplineCameraEffects();
 
 #if UE_EDITOR
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 };